@@ -0,0 +1,159 @@
+/*
+ * Copyright 2021 The CFU-Playground Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "accel_coverage.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+#include "perf.h"
+
+#ifdef SHOW_ACCEL_COVERAGE
+
+namespace {
+
+// Ops beyond this number are not recorded
+constexpr int kMaxOps = 128;
+// Reasons beyond this number are summed as "other"
+constexpr int kMaxReasons = 16;
+
+enum Status { kSoftware, kAccelerated, kFallback };
+
+const char* const status_names[] = {"software", "accelerated", "fallback"};
+
+struct OpCoverage {
+  const char* tag;
+  Status status;
+  const char* reason;
+  uint64_t fallback_cycles;
+};
+
+OpCoverage ops[kMaxOps];
+int num_ops = 0;
+
+// The op running, or null if it is not recorded
+OpCoverage* current = nullptr;
+// Reason given by the last failed check in the running op
+const char* pending_reason = nullptr;
+uint64_t fallback_start;
+
+struct ReasonTotal {
+  const char* reason;
+  int ops;
+  uint64_t cycles;
+};
+
+void AddToTotals(ReasonTotal* totals, int* num_totals, const OpCoverage& op) {
+  int i = 0;
+  while (i < *num_totals && strcmp(totals[i].reason, op.reason) != 0) i++;
+  if (i == *num_totals) {
+    if (*num_totals == kMaxReasons) {
+      // The last total takes the reasons that do not fit
+      i = kMaxReasons - 1;
+      totals[i].reason = "other";
+    } else {
+      totals[i] = {op.reason, 0, 0};
+      (*num_totals)++;
+    }
+  }
+  totals[i].ops++;
+  totals[i].cycles += op.fallback_cycles;
+}
+
+};  // anonymous namespace
+
+void accel_coverage_op_begin(int index, const char* tag) {
+  pending_reason = nullptr;
+  if (index < 0 || index >= kMaxOps) {
+    current = nullptr;
+    return;
+  }
+  current = &ops[index];
+  *current = {tag, kSoftware, nullptr, 0};
+  num_ops = index + 1 > num_ops ? index + 1 : num_ops;
+}
+
+bool accel_coverage_reject(const char* reason) {
+  pending_reason = reason;
+  return false;
+}
+
+void accel_coverage_accelerated() {
+  if (current && current->status == kSoftware) {
+    current->status = kAccelerated;
+  }
+  pending_reason = nullptr;
+}
+
+void accel_coverage_fallback_begin() {
+  if (current) {
+    current->status = kFallback;
+    current->reason = pending_reason ? pending_reason : "unknown";
+  }
+  pending_reason = nullptr;
+  fallback_start = perf_get_mcycle64();
+}
+
+void accel_coverage_fallback_end() {
+  uint64_t cycles = perf_get_mcycle64() - fallback_start;
+  if (current) current->fallback_cycles += cycles;
+}
+
+void accel_coverage_reset() {
+  num_ops = 0;
+  current = nullptr;
+  pending_reason = nullptr;
+}
+
+void accel_coverage_print() {
+  int counts[3] = {0, 0, 0};
+  ReasonTotal totals[kMaxReasons];
+  int num_totals = 0;
+  printf("\"Event\",\"Tag\",\"Status\",\"Reason\",\"Fallback cycles\"\n");
+  for (int i = 0; i < num_ops; i++) {
+    const OpCoverage& op = ops[i];
+    if (!op.tag) continue;
+    printf("%d,%s,%s,%s,%llu\n", i, op.tag, status_names[op.status],
+           op.reason ? op.reason : "", op.fallback_cycles);
+    counts[op.status]++;
+    if (op.status == kFallback) AddToTotals(totals, &num_totals, op);
+  }
+  printf("%d accelerated, %d fallback, %d software ops\n",
+         counts[kAccelerated], counts[kFallback], counts[kSoftware]);
+  for (int i = 0; i < num_totals; i++) {
+    printf("  %-24s %3d ops %12llu cycles\n", totals[i].reason,
+           totals[i].ops, totals[i].cycles);
+  }
+}
+
+#else
+
+void accel_coverage_op_begin(int index, const char* tag) {}
+
+bool accel_coverage_reject(const char* reason) { return false; }
+
+void accel_coverage_accelerated() {}
+
+void accel_coverage_fallback_begin() {}
+
+void accel_coverage_fallback_end() {}
+
+void accel_coverage_reset() {}
+
+void accel_coverage_print() {}
+
+#endif  // SHOW_ACCEL_COVERAGE
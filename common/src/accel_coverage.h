@@ -0,0 +1,73 @@
+/*
+ * Copyright 2021 The CFU-Playground Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Reports which ops were accelerated, and why the others fell back.
+//
+// With SHOW_ACCEL_COVERAGE defined, the progress profiler in tflite.cc
+// tells this module which op is running, and an accelerated kernel reports
+// what it did:
+//
+//   if (CanAccelerateFoo(...)) {
+//     accel_coverage_accelerated();
+//     AccelerateFoo(...);
+//     return;
+//   }
+//   AccelCoverageFallback fallback;
+//   ReferenceFoo(...);
+//
+// where each check in CanAccelerateFoo() that fails returns
+// accel_coverage_reject("reason"). The reason is a short fixed string,
+// such as "padding type" or "filter size", naming the constraint that
+// failed. After each inference, a report lists every op as accelerated,
+// fallback or software (no accelerated kernel), with the reason and the
+// cycles spent in the fallback, followed by the fallback cycles for each
+// reason.
+//
+// Without SHOW_ACCEL_COVERAGE, nothing is recorded or printed.
+
+#ifndef _ACCEL_COVERAGE_H
+#define _ACCEL_COVERAGE_H
+
+// Called by the profiler at the beginning of each op
+void accel_coverage_op_begin(int index, const char* tag);
+
+// Records why the running op cannot be accelerated. Returns false, for
+// returning from a CanAccelerate* check.
+bool accel_coverage_reject(const char* reason);
+
+// Records that the running op was accelerated
+void accel_coverage_accelerated();
+
+// Called around the fallback path of the running op. The reason is the
+// last one recorded by accel_coverage_reject() during the op.
+void accel_coverage_fallback_begin();
+void accel_coverage_fallback_end();
+
+// Calls accel_coverage_fallback_begin() and accel_coverage_fallback_end()
+// around the scope in which it is declared
+class AccelCoverageFallback {
+ public:
+  AccelCoverageFallback() { accel_coverage_fallback_begin(); }
+  ~AccelCoverageFallback() { accel_coverage_fallback_end(); }
+};
+
+// Forgets all ops. Called before each inference.
+void accel_coverage_reset();
+
+// Prints the report for the last inference
+void accel_coverage_print();
+
+#endif  // _ACCEL_COVERAGE_H
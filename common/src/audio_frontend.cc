@@ -0,0 +1,687 @@
+/*
+ * Copyright 2021 The CFU-Playground Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "audio_frontend.h"
+
+#include <math.h>
+#include <string.h>
+
+#include "perf.h"
+
+#ifdef AUDIO_FRONTEND_CFU_BUTTERFLY
+#include "cfu.h"
+#define BUTTERFLY(funct7, rs1, rs2) \
+  cfu_op(AUDIO_FRONTEND_CFU_FUNCT3, funct7, rs1, rs2)
+#else
+#define BUTTERFLY(funct7, rs1, rs2) butterfly(funct7, rs1, rs2)
+#endif
+
+namespace {
+
+// Configuration from micro_speech's micro_features_generator.cc
+constexpr float kLowerBandLimit = 125.0f;
+constexpr float kUpperBandLimit = 7500.0f;
+constexpr int kSmoothingBits = 10;
+constexpr float kEvenSmoothing = 0.025f;
+constexpr float kOddSmoothing = 0.06f;
+constexpr float kMinSignalRemaining = 0.05f;
+constexpr float kPcanStrength = 0.95f;
+constexpr float kPcanOffset = 80.0f;
+constexpr int kPcanGainBits = 21;
+constexpr int kLogScaleShift = 6;
+
+// Fixed point formats of the microfrontend
+constexpr int kWindowBits = 12;
+constexpr int kFilterbankBits = 12;
+constexpr int kNoiseReductionBits = 14;
+constexpr int kPcanSnrBits = 12;
+constexpr int kPcanOutputBits = 6;
+constexpr int kLogScaleLog2 = 16;
+constexpr int kLogSegmentsLog2 = 7;
+constexpr uint32_t kLogCoeff = 45426;  // ln(2) in Q16
+
+constexpr double kPi = 3.14159265358979323846;
+
+constexpr int kWindowSize = AUDIO_FRONTEND_WINDOW_SAMPLES;
+constexpr int kHopSize = AUDIO_FRONTEND_HOP_SAMPLES;
+constexpr int kFftSize = AUDIO_FRONTEND_FFT_SIZE;
+constexpr int kComplexFftSize = kFftSize / 2;
+constexpr int kSpectrumSize = kFftSize / 2 + 1;
+constexpr int kNumChannels = AUDIO_FRONTEND_NUM_CHANNELS;
+
+// Each channel's weights start on an even frequency index and are padded to
+// a multiple of the block size. Channels without any frequencies all point
+// to a single block of zero weights.
+constexpr int kChannelBlockSize = 4;
+constexpr int kIndexAlignment = 2;
+constexpr int kMaxWeights =
+    kSpectrumSize + (kNumChannels + 2) * kChannelBlockSize;
+
+// The PCAN gain is a piecewise quadratic with one segment per bit of input.
+constexpr int kWideDynamicFunctionBits = 32;
+constexpr int kGainLutSize = 4 * kWideDynamicFunctionBits - 3;
+
+// The filterbank output is scaled by sqrt(kFftSize) / 2^(kFilterbankBits/2)
+// relative to the log scale's input.
+constexpr int kCorrectionBits = 3;
+static_assert(kFftSize == 1 << (kCorrectionBits + kFilterbankBits / 2),
+              "kCorrectionBits does not match kFftSize");
+
+// log2(1 + x) - x, for x in [0, 1], in Q16.
+const uint16_t kLogLut[(1 << kLogSegmentsLog2) + 1] = {
+    0,    224,  442,  654,  861,  1063, 1259, 1450, 1636, 1817, 1992, 2163,
+    2329, 2490, 2646, 2797, 2944, 3087, 3224, 3358, 3487, 3611, 3732, 3848,
+    3960, 4068, 4172, 4272, 4368, 4460, 4549, 4633, 4714, 4791, 4864, 4934,
+    5001, 5063, 5123, 5178, 5231, 5280, 5326, 5368, 5408, 5444, 5477, 5507,
+    5533, 5557, 5578, 5595, 5610, 5622, 5631, 5637, 5640, 5641, 5638, 5633,
+    5626, 5615, 5602, 5586, 5568, 5547, 5524, 5498, 5470, 5439, 5406, 5370,
+    5332, 5291, 5249, 5203, 5156, 5106, 5054, 5000, 4944, 4885, 4825, 4762,
+    4697, 4630, 4561, 4490, 4416, 4341, 4264, 4184, 4103, 4020, 3935, 3848,
+    3759, 3668, 3575, 3481, 3384, 3286, 3186, 3084, 2981, 2875, 2768, 2659,
+    2549, 2437, 2323, 2207, 2090, 1971, 1851, 1729, 1605, 1480, 1353, 1224,
+    1094, 963,  830,  695,  559,  421,  282,  142,  0,
+};
+
+struct Complex16 {
+  int16_t r;
+  int16_t i;
+};
+
+// Tables, calculated by audio_frontend_init()
+int16_t window_coefficients[kWindowSize];
+uint32_t twiddles[kComplexFftSize];
+uint32_t super_twiddles[kComplexFftSize / 2];
+uint8_t digit_reverse[kComplexFftSize];
+int filterbank_start_index;
+int filterbank_end_index;
+int16_t channel_frequency_starts[kNumChannels + 1];
+int16_t channel_weight_starts[kNumChannels + 1];
+int16_t channel_widths[kNumChannels + 1];
+int16_t weights[kMaxWeights];
+int16_t unweights[kMaxWeights];
+uint16_t even_smoothing;
+uint16_t odd_smoothing;
+uint16_t min_signal_remaining;
+int16_t gain_lut[kGainLutSize];
+int snr_shift;
+
+// Buffers
+int16_t input[kWindowSize];
+int input_used;
+int16_t fft_input[kFftSize] __attribute__((aligned(4)));
+uint32_t fft_output[kComplexFftSize];
+Complex16 spectrum[kSpectrumSize];
+int32_t energy[kSpectrumSize];
+uint64_t channel_work[kNumChannels + 1];
+uint32_t channel_signal[kNumChannels];
+uint32_t noise_estimate[kNumChannels];
+
+AudioFrontendCycles cycles;
+
+inline int MostSignificantBit32(uint32_t x) {
+  return x ? 32 - __builtin_clz(x) : 0;
+}
+
+inline int MostSignificantBit64(uint64_t x) {
+  return x ? 64 - __builtin_clzll(x) : 0;
+}
+
+// ---- FFT
+
+inline uint32_t pack(Complex16 c) {
+  return static_cast<uint16_t>(c.r) |
+         (static_cast<uint32_t>(static_cast<uint16_t>(c.i)) << 16);
+}
+
+inline Complex16 unpack(uint32_t v) {
+  return {static_cast<int16_t>(v & 0xffff), static_cast<int16_t>(v >> 16)};
+}
+
+// Rounding of a Q30 product to Q15.
+inline int16_t sround(int32_t x) {
+  return static_cast<int16_t>((x + (1 << 14)) >> 15);
+}
+
+inline int16_t fixdiv(int16_t x, int divisor) {
+  return sround(static_cast<int32_t>(x) * (32767 / divisor));
+}
+
+inline Complex16 cmul(Complex16 a, Complex16 b) {
+  return {sround(a.r * b.r - a.i * b.i), sround(a.r * b.i + a.i * b.r)};
+}
+
+inline uint32_t butterfly(int funct7, uint32_t rs1, uint32_t rs2) {
+  Complex16 a = unpack(rs1);
+  if (funct7 & AUDIO_FRONTEND_BFLY_DIV4) {
+    a = {fixdiv(a.r, 4), fixdiv(a.i, 4)};
+  }
+  if (!(funct7 & AUDIO_FRONTEND_BFLY_NO_MUL)) {
+    a = cmul(a, unpack(rs2));
+  }
+  return pack(a);
+}
+
+// One radix-4 stage of a decimation in time FFT, over groups of 4*m values.
+void radix4_stage(int m, int fstride) {
+  for (uint32_t* group = fft_output; group < fft_output + kComplexFftSize;
+       group += 4 * m) {
+    for (int k = 0; k < m; k++) {
+      uint32_t* f = group + k;
+      const Complex16 f0 = unpack(BUTTERFLY(
+          AUDIO_FRONTEND_BFLY_DIV4 | AUDIO_FRONTEND_BFLY_NO_MUL, f[0], 0));
+      const Complex16 s0 = unpack(
+          BUTTERFLY(AUDIO_FRONTEND_BFLY_DIV4, f[m], twiddles[k * fstride]));
+      const Complex16 s1 = unpack(BUTTERFLY(AUDIO_FRONTEND_BFLY_DIV4, f[2 * m],
+                                            twiddles[2 * k * fstride]));
+      const Complex16 s2 = unpack(BUTTERFLY(AUDIO_FRONTEND_BFLY_DIV4, f[3 * m],
+                                            twiddles[3 * k * fstride]));
+
+      // Intermediate values are truncated to 16 bits, as in kissfft.
+      const Complex16 s5 = {static_cast<int16_t>(f0.r - s1.r),
+                            static_cast<int16_t>(f0.i - s1.i)};
+      const Complex16 t0 = {static_cast<int16_t>(f0.r + s1.r),
+                            static_cast<int16_t>(f0.i + s1.i)};
+      const Complex16 s3 = {static_cast<int16_t>(s0.r + s2.r),
+                            static_cast<int16_t>(s0.i + s2.i)};
+      const Complex16 s4 = {static_cast<int16_t>(s0.r - s2.r),
+                            static_cast<int16_t>(s0.i - s2.i)};
+      f[0] = pack({static_cast<int16_t>(t0.r + s3.r),
+                   static_cast<int16_t>(t0.i + s3.i)});
+      f[m] = pack({static_cast<int16_t>(s5.r + s4.i),
+                   static_cast<int16_t>(s5.i - s4.r)});
+      f[2 * m] = pack({static_cast<int16_t>(t0.r - s3.r),
+                       static_cast<int16_t>(t0.i - s3.i)});
+      f[3 * m] = pack({static_cast<int16_t>(s5.r - s4.i),
+                       static_cast<int16_t>(s5.i + s4.r)});
+    }
+  }
+}
+
+// Real FFT of fft_input into spectrum. The input is treated as a complex
+// sequence of half the length, whose transform is then split into the
+// spectrum of the real sequence. Every stage scales by its radix, so the
+// spectrum is the DFT divided by kFftSize.
+void fft() {
+  for (int n = 0; n < kComplexFftSize; n++) {
+    memcpy(fft_output + n, fft_input + 2 * digit_reverse[n],
+           sizeof(fft_output[0]));
+  }
+  for (int m = 1; m < kComplexFftSize; m *= 4) {
+    radix4_stage(m, kComplexFftSize / (4 * m));
+  }
+
+  Complex16 dc = unpack(fft_output[0]);
+  dc = {fixdiv(dc.r, 2), fixdiv(dc.i, 2)};
+  spectrum[0] = {static_cast<int16_t>(dc.r + dc.i), 0};
+  spectrum[kComplexFftSize] = {static_cast<int16_t>(dc.r - dc.i), 0};
+  for (int k = 1; k <= kComplexFftSize / 2; k++) {
+    const Complex16 a = unpack(fft_output[k]);
+    const Complex16 b = unpack(fft_output[kComplexFftSize - k]);
+    const Complex16 fpk = {fixdiv(a.r, 2), fixdiv(a.i, 2)};
+    const Complex16 fpnk = {fixdiv(b.r, 2),
+                            fixdiv(static_cast<int16_t>(-b.i), 2)};
+    const Complex16 f1k = {static_cast<int16_t>(fpk.r + fpnk.r),
+                           static_cast<int16_t>(fpk.i + fpnk.i)};
+    const Complex16 f2k = {static_cast<int16_t>(fpk.r - fpnk.r),
+                           static_cast<int16_t>(fpk.i - fpnk.i)};
+    const Complex16 tw = unpack(BUTTERFLY(0, pack(f2k), super_twiddles[k - 1]));
+    spectrum[k] = {static_cast<int16_t>((f1k.r + tw.r) >> 1),
+                   static_cast<int16_t>((f1k.i + tw.i) >> 1)};
+    spectrum[kComplexFftSize - k] = {static_cast<int16_t>((f1k.r - tw.r) >> 1),
+                                     static_cast<int16_t>((tw.i - f1k.i) >> 1)};
+  }
+}
+
+// ---- Window
+
+// Windows the buffered input into fft_input, returning the largest
+// magnitude of the windowed samples.
+int16_t apply_window() {
+  int16_t max_abs = 0;
+  for (int i = 0; i < kWindowSize; i++) {
+    int16_t value = (static_cast<int32_t>(input[i]) * window_coefficients[i]) >>
+                    kWindowBits;
+    fft_input[i] = value;
+    if (value < 0) value = -value;
+    if (value > max_abs) max_abs = value;
+  }
+  return max_abs;
+}
+
+// Scales the windowed input to use all 16 bits, and zero pads it.
+void scale_fft_input(int shift) {
+  for (int i = 0; i < kWindowSize; i++) {
+    fft_input[i] =
+        static_cast<int16_t>(static_cast<uint16_t>(fft_input[i]) << shift);
+  }
+  memset(fft_input + kWindowSize, 0,
+         (kFftSize - kWindowSize) * sizeof(fft_input[0]));
+}
+
+// ---- Filterbank
+
+uint16_t sqrt32(uint32_t num) {
+  if (num == 0) return 0;
+  uint32_t res = 0;
+  int max_bit_number = (32 - MostSignificantBit32(num)) | 1;
+  uint32_t bit = 1U << (31 - max_bit_number);
+  int iterations = (31 - max_bit_number) / 2 + 1;
+  while (iterations--) {
+    if (num >= res + bit) {
+      num -= res + bit;
+      res = (res >> 1) + bit;
+    } else {
+      res >>= 1;
+    }
+    bit >>= 2;
+  }
+  if (num > res && res != 0xFFFF) ++res;
+  return res;
+}
+
+uint32_t sqrt64(uint64_t num) {
+  if ((num >> 32) == 0) return sqrt32(static_cast<uint32_t>(num));
+  uint64_t res = 0;
+  int max_bit_number = (64 - MostSignificantBit64(num)) | 1;
+  uint64_t bit = 1ULL << (63 - max_bit_number);
+  int iterations = (63 - max_bit_number) / 2 + 1;
+  while (iterations--) {
+    if (num >= res + bit) {
+      num -= res + bit;
+      res = (res >> 1) + bit;
+    } else {
+      res >>= 1;
+    }
+    bit >>= 2;
+  }
+  if (num > res && res != 0xFFFFFFFFLL) ++res;
+  return res;
+}
+
+// Square root of the mel weighted energy of each channel, into
+// channel_signal.
+void filterbank(int scale_down_shift) {
+  for (int i = filterbank_start_index; i < filterbank_end_index; i++) {
+    const int32_t real = spectrum[i].r;
+    const int32_t imag = spectrum[i].i;
+    energy[i] = static_cast<uint32_t>(real * real + imag * imag);
+  }
+
+  // Each frequency contributes to two adjacent channels: "weights" are for
+  // the upper one and "unweights" for the lower one.
+  uint64_t weight_accumulator = 0;
+  uint64_t unweight_accumulator = 0;
+  for (int chan = 0; chan < kNumChannels + 1; chan++) {
+    const int32_t* magnitudes = energy + channel_frequency_starts[chan];
+    const int16_t* w = weights + channel_weight_starts[chan];
+    const int16_t* u = unweights + channel_weight_starts[chan];
+    for (int j = 0; j < channel_widths[chan]; j++) {
+      weight_accumulator += w[j] * static_cast<uint64_t>(magnitudes[j]);
+      unweight_accumulator += u[j] * static_cast<uint64_t>(magnitudes[j]);
+    }
+    channel_work[chan] = weight_accumulator;
+    weight_accumulator = unweight_accumulator;
+    unweight_accumulator = 0;
+  }
+
+  for (int i = 0; i < kNumChannels; i++) {
+    channel_signal[i] = sqrt64(channel_work[i + 1]) >> scale_down_shift;
+  }
+}
+
+// ---- Noise reduction, gain control and log
+
+void noise_reduction() {
+  for (int i = 0; i < kNumChannels; i++) {
+    const uint32_t smoothing = (i & 1) == 0 ? even_smoothing : odd_smoothing;
+    const uint32_t one_minus_smoothing =
+        (1 << kNoiseReductionBits) - smoothing;
+
+    const uint32_t signal_scaled_up = channel_signal[i] << kSmoothingBits;
+    uint32_t estimate =
+        ((static_cast<uint64_t>(signal_scaled_up) * smoothing) +
+         (static_cast<uint64_t>(noise_estimate[i]) * one_minus_smoothing)) >>
+        kNoiseReductionBits;
+    noise_estimate[i] = estimate;
+    if (estimate > signal_scaled_up) estimate = signal_scaled_up;
+
+    const uint32_t floor = (static_cast<uint64_t>(channel_signal[i]) *
+                            min_signal_remaining) >>
+                           kNoiseReductionBits;
+    const uint32_t subtracted = (signal_scaled_up - estimate) >> kSmoothingBits;
+    channel_signal[i] = subtracted > floor ? subtracted : floor;
+  }
+}
+
+int16_t wide_dynamic_function(uint32_t x) {
+  if (x <= 2) return gain_lut[x];
+  const int16_t interval = MostSignificantBit32(x);
+  const int16_t* lut = gain_lut + 4 * interval - 6;
+  const int16_t frac =
+      ((interval < 11) ? (x << (11 - interval)) : (x >> (interval - 11))) &
+      0x3FF;
+  int32_t result = (static_cast<int32_t>(lut[2]) * frac) >> 5;
+  result += static_cast<int32_t>(static_cast<uint32_t>(lut[1]) << 5);
+  result *= frac;
+  result = (result + (1 << 14)) >> 15;
+  result += lut[0];
+  return static_cast<int16_t>(result);
+}
+
+uint32_t pcan_shrink(uint32_t x) {
+  if (x < (2 << kPcanSnrBits)) {
+    return (x * x) >> (2 + 2 * kPcanSnrBits - kPcanOutputBits);
+  } else {
+    return (x >> (kPcanSnrBits - kPcanOutputBits)) - (1 << kPcanOutputBits);
+  }
+}
+
+void pcan_gain_control() {
+  for (int i = 0; i < kNumChannels; i++) {
+    const uint32_t gain = wide_dynamic_function(noise_estimate[i]);
+    const uint32_t snr =
+        (static_cast<uint64_t>(channel_signal[i]) * gain) >> snr_shift;
+    channel_signal[i] = pcan_shrink(snr);
+  }
+}
+
+uint32_t log2_fraction_part(uint32_t x, uint32_t log2x) {
+  int32_t frac = x - (1LL << log2x);
+  if (log2x < kLogScaleLog2) {
+    frac <<= kLogScaleLog2 - log2x;
+  } else {
+    frac >>= log2x - kLogScaleLog2;
+  }
+  const uint32_t base_seg = frac >> (kLogScaleLog2 - kLogSegmentsLog2);
+  const uint32_t seg_unit = (1U << kLogScaleLog2) >> kLogSegmentsLog2;
+  const int32_t c0 = kLogLut[base_seg];
+  const int32_t c1 = kLogLut[base_seg + 1];
+  const int32_t seg_base = seg_unit * base_seg;
+  const int32_t rel_pos = ((c1 - c0) * (frac - seg_base)) >> kLogScaleLog2;
+  return frac + c0 + rel_pos;
+}
+
+// Natural log of x, scaled by 2^kLogScaleShift.
+uint32_t log_scale(uint32_t x) {
+  const uint32_t integer = MostSignificantBit32(x) - 1;
+  const uint32_t fraction = log2_fraction_part(x, integer);
+  const uint32_t log2 = (integer << kLogScaleLog2) + fraction;
+  const uint32_t round = (1 << kLogScaleLog2) / 2;
+  const uint32_t loge =
+      (static_cast<uint64_t>(kLogCoeff) * log2 + round) >> kLogScaleLog2;
+  return ((loge << kLogScaleShift) + round) >> kLogScaleLog2;
+}
+
+// Converts each channel to the micro_speech model's input quantization. The
+// training pipeline divides the log scaled values, which range from 0 to
+// about 670, by 25.6 and the quantized input spans 0 to 26.
+void log_and_quantize(int8_t* features) {
+  constexpr int32_t value_scale = 256;
+  constexpr int32_t value_div = static_cast<int32_t>((25.6f * 26.0f) + 0.5f);
+  for (int i = 0; i < kNumChannels; i++) {
+    uint32_t value = channel_signal[i] << kCorrectionBits;
+    value = value > 1 ? log_scale(value) : 0;
+    if (value > 0xFFFF) value = 0xFFFF;
+    int32_t q =
+        ((static_cast<int32_t>(value) * value_scale) + (value_div / 2)) /
+        value_div;
+    q -= 128;
+    if (q < -128) q = -128;
+    if (q > 127) q = 127;
+    features[i] = q;
+  }
+}
+
+// ---- Table setup
+
+float freq_to_mel(float freq) {
+  return 1127.0 * log1p(static_cast<double>(freq) / 700.0);
+}
+
+int16_t quantize_weight(double weight) {
+  return floor(weight * (1 << kFilterbankBits) + 0.5);
+}
+
+void init_window() {
+  const float arg = kPi * 2.0 / kWindowSize;
+  for (int i = 0; i < kWindowSize; i++) {
+    float value = 0.5 - (0.5 * cos(static_cast<double>(arg) * (i + 0.5)));
+    window_coefficients[i] =
+        floor(static_cast<double>(value * (1 << kWindowBits)) + 0.5);
+  }
+}
+
+uint32_t twiddle(double phase) {
+  return pack({static_cast<int16_t>(floor(.5 + 32767 * cos(phase))),
+               static_cast<int16_t>(floor(.5 + 32767 * sin(phase)))});
+}
+
+void init_fft() {
+  for (int i = 0; i < kComplexFftSize; i++) {
+    twiddles[i] = twiddle(-2 * kPi * i / kComplexFftSize);
+  }
+  for (int i = 0; i < kComplexFftSize / 2; i++) {
+    super_twiddles[i] =
+        twiddle(-kPi * (static_cast<double>(i + 1) / kComplexFftSize + .5));
+  }
+  // Radix-4 stages take their input in base 4 digit reversed order.
+  for (int n = 0; n < kComplexFftSize; n++) {
+    int reversed = 0;
+    for (int rest = n, m = 1; m < kComplexFftSize; m *= 4, rest /= 4) {
+      reversed = reversed * 4 + rest % 4;
+    }
+    digit_reverse[n] = reversed;
+  }
+}
+
+void init_filterbank() {
+  float center_mel_freqs[kNumChannels + 1];
+  int16_t actual_channel_starts[kNumChannels + 1];
+  int16_t actual_channel_widths[kNumChannels + 1];
+
+  const float mel_low = freq_to_mel(kLowerBandLimit);
+  const float mel_hi = freq_to_mel(kUpperBandLimit);
+  const float mel_spacing =
+      (mel_hi - mel_low) / static_cast<float>(kNumChannels + 1);
+  for (int i = 0; i < kNumChannels + 1; i++) {
+    center_mel_freqs[i] = mel_low + (mel_spacing * (i + 1));
+  }
+
+  // DC is always excluded.
+  const float hz_per_sbin =
+      0.5 * AUDIO_FRONTEND_SAMPLE_RATE / (kSpectrumSize - 1);
+  filterbank_start_index =
+      1.5 + static_cast<double>(kLowerBandLimit / hz_per_sbin);
+  filterbank_end_index = 0;
+
+  int chan_freq_index_start = filterbank_start_index;
+  int weight_index_start = 0;
+  bool needs_zeros = false;
+  for (int chan = 0; chan < kNumChannels + 1; chan++) {
+    int freq_index = chan_freq_index_start;
+    while (freq_to_mel(freq_index * hz_per_sbin) <= center_mel_freqs[chan]) {
+      freq_index++;
+    }
+
+    const int width = freq_index - chan_freq_index_start;
+    actual_channel_starts[chan] = chan_freq_index_start;
+    actual_channel_widths[chan] = width;
+    if (width == 0) {
+      channel_frequency_starts[chan] = 0;
+      channel_weight_starts[chan] = 0;
+      channel_widths[chan] = kChannelBlockSize;
+      if (!needs_zeros) {
+        needs_zeros = true;
+        for (int j = 0; j < chan; j++) {
+          channel_weight_starts[j] += kChannelBlockSize;
+        }
+        weight_index_start += kChannelBlockSize;
+      }
+    } else {
+      const int aligned_start =
+          (chan_freq_index_start / kIndexAlignment) * kIndexAlignment;
+      const int aligned_width = chan_freq_index_start - aligned_start + width;
+      const int padded_width =
+          (((aligned_width - 1) / kChannelBlockSize) + 1) * kChannelBlockSize;
+      channel_frequency_starts[chan] = aligned_start;
+      channel_weight_starts[chan] = weight_index_start;
+      channel_widths[chan] = padded_width;
+      weight_index_start += padded_width;
+    }
+    chan_freq_index_start = freq_index;
+  }
+
+  memset(weights, 0, sizeof(weights));
+  memset(unweights, 0, sizeof(unweights));
+  for (int chan = 0; chan < kNumChannels + 1; chan++) {
+    int frequency = actual_channel_starts[chan];
+    const int frequency_offset = frequency - channel_frequency_starts[chan];
+    const int weight_start = channel_weight_starts[chan];
+    const float denom_val = chan == 0 ? mel_low : center_mel_freqs[chan - 1];
+    for (int j = 0; j < actual_channel_widths[chan]; j++, frequency++) {
+      const float weight =
+          (center_mel_freqs[chan] - freq_to_mel(frequency * hz_per_sbin)) /
+          (center_mel_freqs[chan] - denom_val);
+      const int weight_index = weight_start + frequency_offset + j;
+      weights[weight_index] =
+          quantize_weight(static_cast<double>(weight));
+      unweights[weight_index] =
+          quantize_weight(1.0 - static_cast<double>(weight));
+    }
+    if (frequency > filterbank_end_index) filterbank_end_index = frequency;
+  }
+}
+
+int16_t pcan_gain(int32_t input_bits, uint32_t x) {
+  const float x_as_float =
+      static_cast<float>(x) / (static_cast<uint32_t>(1) << input_bits);
+  const float gain_as_float =
+      (static_cast<uint32_t>(1) << kPcanGainBits) *
+      powf(x_as_float + kPcanOffset, -kPcanStrength);
+  if (gain_as_float > INT16_MAX) return INT16_MAX;
+  return static_cast<int16_t>(gain_as_float + 0.5f);
+}
+
+void init_gain_control() {
+  even_smoothing = kEvenSmoothing * (1 << kNoiseReductionBits);
+  odd_smoothing = kOddSmoothing * (1 << kNoiseReductionBits);
+  min_signal_remaining = kMinSignalRemaining * (1 << kNoiseReductionBits);
+
+  snr_shift = kPcanGainBits - kCorrectionBits - kPcanSnrBits;
+  const int32_t input_bits = kSmoothingBits - kCorrectionBits;
+  gain_lut[0] = pcan_gain(input_bits, 0);
+  gain_lut[1] = pcan_gain(input_bits, 1);
+  for (int interval = 2; interval <= kWideDynamicFunctionBits; interval++) {
+    const uint32_t x0 = static_cast<uint32_t>(1) << (interval - 1);
+    const uint32_t x1 = x0 + (x0 >> 1);
+    const uint32_t x2 =
+        (interval == kWideDynamicFunctionBits) ? x0 + (x0 - 1) : 2 * x0;
+
+    const int16_t y0 = pcan_gain(input_bits, x0);
+    const int16_t y1 = pcan_gain(input_bits, x1);
+    const int16_t y2 = pcan_gain(input_bits, x2);
+
+    const int32_t diff1 = static_cast<int32_t>(y1) - y0;
+    const int32_t diff2 = static_cast<int32_t>(y2) - y0;
+    const int32_t a1 = 4 * diff1 - diff2;
+    const int32_t a2 = diff2 - a1;
+
+    int16_t* lut = gain_lut + 4 * interval - 6;
+    lut[0] = y0;
+    lut[1] = static_cast<int16_t>(a1);
+    lut[2] = static_cast<int16_t>(a2);
+  }
+}
+
+}  // anonymous namespace
+
+void audio_frontend_init() {
+  init_window();
+  init_fft();
+  init_filterbank();
+  init_gain_control();
+  audio_frontend_reset();
+}
+
+void audio_frontend_reset() {
+  input_used = 0;
+  memset(noise_estimate, 0, sizeof(noise_estimate));
+  cycles = AudioFrontendCycles{};
+}
+
+int audio_frontend_process(const int16_t* samples, int num_samples,
+                           int8_t* features, bool* produced) {
+  *produced = false;
+  int to_copy = kWindowSize - input_used;
+  if (to_copy > num_samples) to_copy = num_samples;
+  memcpy(input + input_used, samples, to_copy * sizeof(input[0]));
+  input_used += to_copy;
+  if (input_used < kWindowSize) return to_copy;
+
+  uint64_t start = perf_get_mcycle64();
+  const int16_t max_abs = apply_window();
+  memmove(input, input + kHopSize, (kWindowSize - kHopSize) * sizeof(input[0]));
+  input_used -= kHopSize;
+  uint64_t end = perf_get_mcycle64();
+  cycles.window += end - start;
+
+  // Scale the FFT input for as much resolution as possible, and undo the
+  // scaling after the square root of the energies.
+  start = end;
+  const int input_shift = 15 - MostSignificantBit32(max_abs);
+  scale_fft_input(input_shift);
+  fft();
+  end = perf_get_mcycle64();
+  cycles.fft += end - start;
+
+  start = end;
+  filterbank(input_shift);
+  end = perf_get_mcycle64();
+  cycles.filterbank += end - start;
+
+  start = end;
+  noise_reduction();
+  pcan_gain_control();
+  log_and_quantize(features);
+  end = perf_get_mcycle64();
+  cycles.gain_log += end - start;
+
+  cycles.slices++;
+  *produced = true;
+  return to_copy;
+}
+
+int audio_frontend_generate(const int16_t* samples, int num_samples,
+                            int8_t* features, int max_slices) {
+  int slices = 0;
+  while (num_samples > 0 && slices < max_slices) {
+    bool produced;
+    int used = audio_frontend_process(
+        samples, num_samples, features + slices * kNumChannels, &produced);
+    samples += used;
+    num_samples -= used;
+    if (produced) slices++;
+  }
+  return slices;
+}
+
+uint32_t* audio_frontend_noise_estimate() { return noise_estimate; }
+
+const AudioFrontendCycles* audio_frontend_get_cycles() { return &cycles; }
+
+uint32_t audio_frontend_butterfly_sw(int funct7, uint32_t rs1, uint32_t rs2) {
+  return butterfly(funct7, rs1, rs2);
+}
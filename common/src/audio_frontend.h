@@ -0,0 +1,95 @@
+/*
+ * Copyright 2021 The CFU-Playground Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Integer audio feature frontend.
+//
+// Turns 16kHz, 16 bit PCM into the int8 feature slices that the micro_speech
+// model takes as input. The pipeline and its configuration are those of the
+// TensorFlow microfrontend as set up by micro_speech's
+// micro_features_generator.cc, and the output is bit exact with it:
+//
+//   30ms Hann window every 20ms -> 512 point fixed-point real FFT ->
+//   40 channel mel filterbank -> noise reduction -> PCAN gain control ->
+//   log scale -> int8 quantization.
+//
+// The FFT is a radix-4 transform with the same rounding as the fixed-point
+// kissfft used by the microfrontend. When AUDIO_FRONTEND_CFU_BUTTERFLY is
+// defined, its twiddle multiplications are done by a CFU instruction (see
+// audio_frontend_butterfly_sw() for the contract).
+
+#ifndef _AUDIO_FRONTEND_H
+#define _AUDIO_FRONTEND_H
+
+#include <stdint.h>
+
+#ifndef __cplusplus
+#error "audio_frontend.h is for C++ only"
+#endif
+
+#define AUDIO_FRONTEND_SAMPLE_RATE 16000
+#define AUDIO_FRONTEND_WINDOW_SAMPLES 480
+#define AUDIO_FRONTEND_HOP_SAMPLES 320
+#define AUDIO_FRONTEND_FFT_SIZE 512
+#define AUDIO_FRONTEND_NUM_CHANNELS 40
+
+// CFU function used for the butterfly ops, if enabled.
+#ifndef AUDIO_FRONTEND_CFU_FUNCT3
+#define AUDIO_FRONTEND_CFU_FUNCT3 6
+#endif
+
+// funct7 bits for the butterfly op.
+#define AUDIO_FRONTEND_BFLY_DIV4 0x1  // Divide rs1 by 4 first
+#define AUDIO_FRONTEND_BFLY_NO_MUL 0x2  // Do not multiply by rs2
+
+// Cycles spent in each stage of the frontend since the last reset.
+struct AudioFrontendCycles {
+  uint64_t window;
+  uint64_t fft;
+  uint64_t filterbank;  // Energy, mel filterbank and square root
+  uint64_t gain_log;    // Noise reduction, PCAN, log and quantization
+  int slices;
+};
+
+// Calculates the window, FFT, filterbank and gain tables, then resets.
+// Must be called once before any other function.
+void audio_frontend_init();
+
+// Clears buffered samples, the noise estimate and the cycle counts.
+void audio_frontend_reset();
+
+// Consumes up to num_samples samples. Whenever a full window has been
+// buffered, writes AUDIO_FRONTEND_NUM_CHANNELS features and stops. Returns the
+// number of samples consumed and sets *produced if features were written.
+int audio_frontend_process(const int16_t* samples, int num_samples,
+                           int8_t* features, bool* produced);
+
+// Converts a clip into consecutive feature slices, writing at most max_slices
+// of them. Returns the number of slices written.
+int audio_frontend_generate(const int16_t* samples, int num_samples,
+                            int8_t* features, int max_slices);
+
+// The per channel noise estimate, which tests may preset.
+uint32_t* audio_frontend_noise_estimate();
+
+const AudioFrontendCycles* audio_frontend_get_cycles();
+
+// Software model of the CFU butterfly op. Operands and result hold a complex
+// value with the real part in the low 16 bits and the imaginary part in the
+// high 16 bits, both Q15. The op optionally divides rs1 by 4, then multiplies
+// it by rs2, rounding both steps as fixed-point kissfft does.
+uint32_t audio_frontend_butterfly_sw(int funct7, uint32_t rs1, uint32_t rs2);
+
+#endif  // _AUDIO_FRONTEND_H
@@ -0,0 +1,115 @@
+/*
+ * Copyright 2021 The CFU-Playground Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "bank_planner.h"
+
+#include <cstdio>
+
+#include "proj_tflite.h"
+
+TfLiteStatus BankAwarePlanner::Init(unsigned char* scratch_buffer,
+                                    int scratch_buffer_size) {
+  tensor_ = -1;
+  num_buffers_ = 0;
+  num_constrained_ = 0;
+  return greedy_.Init(scratch_buffer, scratch_buffer_size);
+}
+
+// As AllocationInfoBuilder, a buffer is added for each tensor without data
+// that is not a variable, in order, followed by the scratch buffers.
+int BankAwarePlanner::NextTensor() {
+  const tflite::SubGraph* subgraph = model_->subgraphs()->Get(0);
+  const int num_tensors = subgraph->tensors()->size();
+  while (++tensor_ < num_tensors) {
+    const tflite::Tensor* tensor = subgraph->tensors()->Get(tensor_);
+    const tflite::Buffer* buffer = model_->buffers()->Get(tensor->buffer());
+    const bool has_data = buffer->data() && buffer->data()->size();
+    if (!has_data && !tensor->is_variable()) {
+      return tensor_;
+    }
+  }
+  tensor_ = num_tensors;
+  return -1;
+}
+
+TfLiteStatus BankAwarePlanner::AddBuffer(tflite::ErrorReporter* error_reporter,
+                                         int size, int first_time_used,
+                                         int last_time_used) {
+  const int index = num_buffers_++;
+  const int tensor = NextTensor();
+  if (index < kMaxBuffers) {
+    tensors_[index] = tensor;
+    placements_[index].alignment = 0;
+    if (tensor >= 0 &&
+        tflite_tensor_placement(model_, tensor, &placements_[index])) {
+      // Greedy planner offsets are multiples of 16, as are all sizes, so
+      // padding by the alignment leaves room to move to any offset.
+      size += placements_[index].alignment;
+      num_constrained_++;
+    }
+  }
+  return greedy_.AddBuffer(error_reporter, size, first_time_used,
+                           last_time_used);
+}
+
+TfLiteStatus BankAwarePlanner::AddBuffer(tflite::ErrorReporter* error_reporter,
+                                         int size, int first_time_used,
+                                         int last_time_used,
+                                         int offline_offset) {
+  const int index = num_buffers_++;
+  const int tensor = NextTensor();
+  if (index < kMaxBuffers) {
+    tensors_[index] = tensor;
+    placements_[index].alignment = 0;
+  }
+  return greedy_.AddBuffer(error_reporter, size, first_time_used,
+                           last_time_used, offline_offset);
+}
+
+size_t BankAwarePlanner::GetMaximumMemorySize() {
+  return greedy_.GetMaximumMemorySize();
+}
+
+int BankAwarePlanner::GetBufferCount() { return greedy_.GetBufferCount(); }
+
+TfLiteStatus BankAwarePlanner::GetOffsetForBuffer(
+    tflite::ErrorReporter* error_reporter, int buffer_index, int* offset) {
+  TF_LITE_ENSURE_STATUS(
+      greedy_.GetOffsetForBuffer(error_reporter, buffer_index, offset));
+  if (buffer_index < kMaxBuffers && placements_[buffer_index].alignment) {
+    const int alignment = placements_[buffer_index].alignment;
+    int shift = (static_cast<int>(placements_[buffer_index].offset) - *offset) %
+                alignment;
+    if (shift < 0) shift += alignment;
+    *offset += shift;
+    // Kept for the report, as the greedy planner's working memory is only
+    // valid while the plan is being made
+    offsets_[buffer_index] = *offset;
+  }
+  return kTfLiteOk;
+}
+
+void BankAwarePlanner::PrintMemoryPlan() { greedy_.PrintMemoryPlan(); }
+
+void BankAwarePlanner::PrintReport() const {
+  printf("Bank-aware placement: %d tensors constrained\n", num_constrained_);
+  for (int i = 0; i < num_buffers_ && i < kMaxBuffers; i++) {
+    if (!placements_[i].alignment) continue;
+    printf("  tensor %d at offset %d, bank %d\n", tensors_[i], offsets_[i],
+           offsets_[i] / static_cast<int>(kArenaBankWidth) %
+               static_cast<int>(kArenaBankCount));
+  }
+}
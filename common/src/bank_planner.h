@@ -0,0 +1,107 @@
+/*
+ * Copyright 2021 The CFU-Playground Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Bank-aware placement of tensors in the arena.
+//
+// On SoCs built with --separate-arena, the arena is striped across four
+// LRAM banks a word at a time (see soc/hps_lattice_nx.py), and the CFU may
+// read each bank through its own memory port. Two operands can be fetched in
+// the same cycle only if they are in different banks.
+//
+// The TFLM planner starts every tensor on a 16 byte boundary, which is
+// always bank 0. With BANK_AWARE_PLACEMENT defined, tflite.cc plans the arena
+// with a BankAwarePlanner instead, which asks the project where each tensor
+// should start through tflite_tensor_placement() (see proj_tflite.h).
+// Constrained tensors are padded by their alignment, then moved within the
+// padding to the requested offset.
+//
+// Offline planned tensors, scratch buffers and resident models are placed
+// as usual.
+
+#ifndef _BANK_PLANNER_H
+#define _BANK_PLANNER_H
+
+#include <cstdint>
+
+#include "tensorflow/lite/micro/compatibility.h"
+#include "tensorflow/lite/micro/memory_planner/greedy_memory_planner.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+
+// Arena banks, each one word wide
+constexpr uint32_t kArenaBankCount = 4;
+constexpr uint32_t kArenaBankWidth = 4;
+
+// Where a tensor starts: at offset bytes past a multiple of alignment.
+// alignment must be a multiple of 16, and offset a multiple of 4.
+struct TensorPlacement {
+  uint32_t alignment;
+  uint32_t offset;
+};
+
+// Placement for a tensor starting in the given bank
+inline TensorPlacement BankPlacement(int bank) {
+  return {kArenaBankCount * kArenaBankWidth, bank * kArenaBankWidth};
+}
+
+// Bank holding the given arena address
+inline int ArenaBank(const void* p) {
+  return (reinterpret_cast<uintptr_t>(p) / kArenaBankWidth) % kArenaBankCount;
+}
+
+class BankAwarePlanner : public tflite::MicroMemoryPlanner {
+ public:
+  explicit BankAwarePlanner(const tflite::Model* model) : model_(model) {}
+
+  TfLiteStatus Init(unsigned char* scratch_buffer,
+                    int scratch_buffer_size) override;
+  TfLiteStatus AddBuffer(tflite::ErrorReporter* error_reporter, int size,
+                         int first_time_used, int last_time_used) override;
+  TfLiteStatus AddBuffer(tflite::ErrorReporter* error_reporter, int size,
+                         int first_time_used, int last_time_used,
+                         int offline_offset) override;
+  size_t GetMaximumMemorySize() override;
+  int GetBufferCount() override;
+  TfLiteStatus GetOffsetForBuffer(tflite::ErrorReporter* error_reporter,
+                                  int buffer_index, int* offset) override;
+  void PrintMemoryPlan() override;
+
+  // Prints the bank of each constrained tensor, once allocated
+  void PrintReport() const;
+
+ private:
+  // Buffers beyond this number are not constrained
+  static constexpr int kMaxBuffers = 512;
+
+  // Returns the index of the tensor for the next buffer added, or -1 once
+  // all tensors have been added and the buffers are scratch buffers
+  int NextTensor();
+
+  const tflite::Model* model_;
+  tflite::GreedyMemoryPlanner greedy_;
+  // Index of the last tensor given a buffer
+  int tensor_ = -1;
+  int num_buffers_ = 0;
+  // Tensor, placement and planned offset of each buffer. Alignment is 0 for
+  // unconstrained buffers.
+  int16_t tensors_[kMaxBuffers];
+  TensorPlacement placements_[kMaxBuffers];
+  int32_t offsets_[kMaxBuffers];
+  int num_constrained_ = 0;
+
+  TF_LITE_REMOVE_VIRTUAL_DELETE;
+};
+
+#endif  // _BANK_PLANNER_H
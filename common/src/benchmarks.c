@@ -19,9 +19,11 @@
 #include <stdio.h>
 
 #include "assert.h"
+#include "cache_range.h"
 #include "menu.h"
 #include "perf.h"
 #include "generated/mem.h"
+#include <system.h>
 
 #if defined(PLATFORM_hps)
 #define BUF_SIZE (32 * 1024)  // must be at least 1024
@@ -158,6 +160,54 @@ static void __attribute__((noinline)) do_increment_mem(void) {
          end_time - start_time, (end_time - start_time) / total_iters);
 }
 
+// Returns cycles taken to load each word of len bytes from buf
+static unsigned int __attribute__((noinline))
+time_loads(const volatile int* buf, int len) {
+  unsigned int start_time = perf_get_mcycle();
+  for (int j = 0; j < len / 4; ++j) {
+    (void)buf[j];
+  }
+  return perf_get_mcycle() - start_time;
+}
+
+static void __attribute__((noinline)) do_cache_flush(void) {
+  puts("Hello, Cache Flush!\n");
+  int buf[BUF_SIZE];
+  // buf is both the range flushed and, past that, a working set that would
+  // be reloaded after the flush
+  const int work_len = 1024;
+  const int lens[] = {256, 1024, 4 * BUF_SIZE - work_len};
+  const volatile int* work = buf + BUF_SIZE - work_len / 4;
+  printf("%-22s %8s %8s %8s\n", "", "Bytes", "Cycles", "Reload");
+  for (size_t i = 0; i < sizeof(lens) / sizeof(lens[0]); i++) {
+    time_loads(work, work_len);
+    unsigned int start_time = perf_get_mcycle();
+    flush_cpu_dcache();
+    flush_l2_cache();
+    unsigned int whole = perf_get_mcycle() - start_time;
+    unsigned int whole_reload = time_loads(work, work_len);
+
+    start_time = perf_get_mcycle();
+    cache_flush_range(buf, lens[i]);
+    unsigned int flush = perf_get_mcycle() - start_time;
+    unsigned int flush_reload = time_loads(work, work_len);
+
+    start_time = perf_get_mcycle();
+    cache_invalidate_range(buf, lens[i]);
+    unsigned int invalidate = perf_get_mcycle() - start_time;
+    unsigned int invalidate_reload = time_loads(work, work_len);
+
+    printf("%-22s %8d %8u %8u\n", "whole caches", lens[i], whole,
+           whole_reload);
+    printf("%-22s %8d %8u %8u\n", "cache_flush_range", lens[i], flush,
+           flush_reload);
+    printf("%-22s %8d %8u %8u\n", "cache_invalidate_range", lens[i],
+           invalidate, invalidate_reload);
+  }
+  printf("Reload is cycles to then load a %d byte working set\n\n\n",
+         work_len);
+}
+
 static struct Menu MENU = {
     "Benchmarks Menu",
     "benchmark",
@@ -177,6 +227,8 @@ static struct Menu MENU = {
         MENU_ITEM('s', "sequential stores benchmark", do_stores),
         MENU_ITEM('i', "load-increment-store benchmark (expect misses)",
                   do_increment_mem),
+        MENU_ITEM('x', "cache flush cost, whole caches vs address ranges",
+                  do_cache_flush),
         MENU_END,
     },
 };
@@ -0,0 +1,76 @@
+/*
+ * Copyright 2021 The CFU-Playground Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "boot_timer.h"
+
+#include <stdio.h>
+
+#include "perf.h"
+
+static const char* names[BOOT_TIMER_MAX_MARKS];
+static uint64_t cycles[BOOT_TIMER_MAX_MARKS];
+static int num_marks;
+
+// Cycles spent paused, and the cycle counter when paused, or 0 if running
+static uint64_t paused_cycles;
+static uint64_t paused_at;
+
+void boot_timer_pause() {
+  if (!paused_at) {
+    paused_at = perf_get_mcycle64();
+  }
+}
+
+void boot_timer_resume() {
+  if (paused_at) {
+    paused_cycles += perf_get_mcycle64() - paused_at;
+    paused_at = 0;
+  }
+}
+
+void boot_timer_mark(const char* name) {
+  uint64_t now = (paused_at ? paused_at : perf_get_mcycle64()) - paused_cycles;
+  if (num_marks < BOOT_TIMER_MAX_MARKS) {
+    names[num_marks] = name;
+    cycles[num_marks] = now;
+    num_marks++;
+  }
+}
+
+int boot_timer_count() { return num_marks; }
+
+void boot_timer_rewind(int count) {
+  if (count < num_marks) {
+    num_marks = count;
+  }
+}
+
+uint64_t boot_timer_cycles(int index) {
+  return index >= 0 && index < num_marks ? cycles[index] : 0;
+}
+
+const char* boot_timer_name(int index) {
+  return index >= 0 && index < num_marks ? names[index] : NULL;
+}
+
+void boot_timer_print() {
+  printf("\"Phase\",\"Cycles since reset\",\"Cycles\"\n");
+  uint64_t previous = 0;
+  for (int i = 0; i < num_marks; i++) {
+    printf("%s,%llu,%llu\n", names[i], cycles[i], cycles[i] - previous);
+    previous = cycles[i];
+  }
+}
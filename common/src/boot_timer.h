@@ -0,0 +1,63 @@
+/*
+ * Copyright 2021 The CFU-Playground Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Timestamps for the phases between reset and the first inference.
+//
+// Each mark records the cycle counter, which counts from zero at reset, so
+// that the first mark also covers the startup code that runs before main().
+// tflite.cc marks each phase of loading a model and, after the first
+// inference with that model, prints the marks and the time to first result.
+// The menu pauses the timer while waiting for a selection, so that marks
+// leave out time spent waiting for the user.
+
+#ifndef _BOOT_TIMER_H
+#define _BOOT_TIMER_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Marks beyond this number are not recorded
+#define BOOT_TIMER_MAX_MARKS 16
+
+// Records the end of the named phase. The name must outlive the mark.
+void boot_timer_mark(const char* name);
+
+// Stops and restarts the timer. Marks count only the cycles while running.
+void boot_timer_pause();
+void boot_timer_resume();
+
+// Returns the number of marks recorded
+int boot_timer_count();
+
+// Discards all but the first count marks
+void boot_timer_rewind(int count);
+
+// Returns the cycles since reset at a mark, or 0 if there is no such mark
+uint64_t boot_timer_cycles(int index);
+
+// Returns the name of a mark, or NULL if there is no such mark
+const char* boot_timer_name(int index);
+
+// Prints each mark with its cycles since reset and since the previous mark
+void boot_timer_print();
+
+#ifdef __cplusplus
+}
+#endif
+#endif  // _BOOT_TIMER_H
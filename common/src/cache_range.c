@@ -0,0 +1,79 @@
+/*
+ * Copyright 2021 The CFU-Playground Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "cache_range.h"
+
+#include <generated/mem.h>
+#include <generated/soc.h>
+#include <stdint.h>
+#include <system.h>
+
+static void invalidate_cpu_dcache(void) {
+#ifdef CONFIG_CPU_HAS_DCACHE
+  flush_cpu_dcache();
+#endif
+}
+
+#if defined(CONFIG_L2_SIZE) && defined(MAIN_RAM_BASE)
+
+// LiteX's L2 cache is direct mapped, with lines of at least 16 bytes
+#define L2_LINE_BYTES 16
+
+// Evicts the L2 lines holding [start, end) by reading, for each, the
+// address CONFIG_L2_SIZE away, which maps to the same line. Dirty lines are
+// written back as they are evicted.
+static void evict_l2_range(uintptr_t start, uintptr_t end) {
+  const uintptr_t ram_end = MAIN_RAM_BASE + MAIN_RAM_SIZE;
+  if (start < MAIN_RAM_BASE) {
+    start = MAIN_RAM_BASE;
+  }
+  if (end > ram_end) {
+    end = ram_end;
+  }
+  if (start >= end) {
+    return;
+  }
+  // One pass over the size of the L2 evicts every line
+  if (end - start > CONFIG_L2_SIZE) {
+    end = start + CONFIG_L2_SIZE;
+  }
+  // The reads must miss in the data cache to reach the L2
+  invalidate_cpu_dcache();
+  for (uintptr_t addr = start & ~(uintptr_t)(L2_LINE_BYTES - 1); addr < end;
+       addr += L2_LINE_BYTES) {
+    uintptr_t alias = MAIN_RAM_BASE + ((addr - MAIN_RAM_BASE) ^ CONFIG_L2_SIZE);
+    (void)*(volatile uint32_t*)alias;
+  }
+}
+
+#else
+
+static void evict_l2_range(uintptr_t start, uintptr_t end) {
+  (void)start;
+  (void)end;
+}
+
+#endif  // CONFIG_L2_SIZE
+
+void cache_flush_range(const void* addr, size_t len) {
+  // The data cache holds nothing that memory does not
+  evict_l2_range((uintptr_t)addr, (uintptr_t)addr + len);
+}
+
+void cache_invalidate_range(const void* addr, size_t len) {
+  evict_l2_range((uintptr_t)addr, (uintptr_t)addr + len);
+  invalidate_cpu_dcache();
+}
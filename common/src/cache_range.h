@@ -0,0 +1,49 @@
+/*
+ * Copyright 2021 The CFU-Playground Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Cache maintenance over an address range, for memory shared with bus
+// masters that bypass the CPU caches, such as the video framebuffer DMA and
+// the CFU memory port. Use these in place of flush_cpu_dcache() and
+// flush_l2_cache(), which act on whole caches.
+//
+// VexRiscv's data cache is write-through, so only LiteX's L2 cache, which
+// is write-back and sits in front of main RAM, can hold data that memory
+// does not. VexRiscv cannot invalidate single lines of its data cache, so
+// invalidating any range invalidates all of it, as does flushing a range
+// in main RAM while there is an L2. The rest of the L2 is kept.
+
+#ifndef _CACHE_RANGE_H
+#define _CACHE_RANGE_H
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Writes the CPU's writes to [addr, addr + len) to memory, so that other
+// bus masters can read them
+void cache_flush_range(const void* addr, size_t len);
+
+// Discards cached copies of [addr, addr + len), so that the CPU reads what
+// other bus masters wrote. Flush CPU writes to the range first: lines that
+// the CPU has written may be written back over the other bus master's data.
+void cache_invalidate_range(const void* addr, size_t len);
+
+#ifdef __cplusplus
+}
+#endif
+#endif  // _CACHE_RANGE_H
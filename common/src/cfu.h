@@ -73,6 +73,16 @@
 
 #ifdef CFU_SOFTWARE_DEFINED
 #define cfu_op(funct3, funct7, rs1, rs2) cfu_op_sw(funct3, funct7, rs1, rs2)
+#elif defined(SIM_TRACE_CFU)
+// Allows simulation tracing to be scoped to a CFU function. See sim_trace.h.
+#include "sim_trace.h"
+#define cfu_op(funct3, funct7, rs1, rs2)                               \
+  ({                                                                   \
+    sim_trace_cfu_begin(funct3);                                       \
+    unsigned long cfu_op_result = cfu_op_hw(funct3, funct7, rs1, rs2); \
+    sim_trace_cfu_end();                                               \
+    cfu_op_result;                                                     \
+  })
 #else
 #define cfu_op(funct3, funct7, rs1, rs2) cfu_op_hw(funct3, funct7, rs1, rs2)
 #endif
@@ -0,0 +1,64 @@
+/*
+ * Copyright 2021 The CFU-Playground Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Per project hooks for CFU performance counters.
+//
+// A CFU may count the cycles it spends in each of four states. Projects whose
+// CFU implements counters override cfu_counters.cc to read them.
+
+#ifndef _CFU_COUNTERS_H
+#define _CFU_COUNTERS_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct CfuCounters {
+  // Cycles spent doing useful work
+  uint32_t busy;
+  // Cycles spent waiting for the CPU to supply input or parameters
+  uint32_t input_starved;
+  // Cycles spent waiting for the CPU to read output
+  uint32_t output_blocked;
+  // All other cycles
+  uint32_t idle;
+};
+
+// Returns non-zero if this project's CFU implements the counters
+int cfu_counters_supported();
+
+// Zeros the CFU counters
+void cfu_counters_reset();
+
+// Reads the current value of the CFU counters
+void cfu_counters_read(struct CfuCounters* counters);
+
+// Calculates result = end - start, counter by counter
+static inline void cfu_counters_diff(const struct CfuCounters* end,
+                                     const struct CfuCounters* start,
+                                     struct CfuCounters* result) {
+  result->busy = end->busy - start->busy;
+  result->input_starved = end->input_starved - start->input_starved;
+  result->output_blocked = end->output_blocked - start->output_blocked;
+  result->idle = end->idle - start->idle;
+}
+
+#ifdef __cplusplus
+}
+#endif
+#endif  // _CFU_COUNTERS_H
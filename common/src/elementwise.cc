@@ -0,0 +1,255 @@
+/*
+ * Copyright 2021 The CFU-Playground Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "elementwise.h"
+
+#include <algorithm>
+
+#include "tensorflow/lite/kernels/internal/common.h"
+#include "tensorflow/lite/kernels/internal/reference/integer_ops/add.h"
+
+namespace {
+
+// SWAR lanes are 16 bits wide, holding one int8 value biased to be
+// unsigned, so that sums and the clamp cannot carry into the next lane.
+constexpr uint32_t kLaneLow = 0x00010001;
+constexpr uint32_t kByteLanes = 0x00ff00ff;
+constexpr uint32_t kLaneHigh = 0x80008000;
+constexpr uint32_t kSignBits = 0x80808080;
+
+// Added to each lane so that it stays positive before the clamp.
+constexpr int32_t kLaneBias = 512;
+
+// Per Eval tables for the separable Add.
+int32_t add_tables[2][ELEMENTWISE_TABLE_SIZE];
+int8_t unary_table[ELEMENTWISE_TABLE_SIZE];
+
+inline bool is_word_aligned(const void* p) {
+  return (reinterpret_cast<uintptr_t>(p) & 3) == 0;
+}
+
+inline int8_t clamp(int32_t value, int32_t min, int32_t max) {
+  return static_cast<int8_t>(std::min(max, std::max(min, value)));
+}
+
+// Returns lanes of all ones where a >= b, else zero. Both must be < 0x8000.
+inline uint32_t lanes_ge(uint32_t a, uint32_t b) {
+  const uint32_t ge = (((a | kLaneHigh) - b) & kLaneHigh) >> 15;
+  return (ge << 16) - ge;
+}
+
+// Adds the even or odd bytes of two words, each in a 16 bit lane, and clamps.
+inline uint32_t add_lanes(uint32_t a, uint32_t b, uint32_t k, uint32_t lo,
+                          uint32_t hi) {
+  uint32_t t = a + b + k;
+  uint32_t keep = lanes_ge(t, lo);
+  t = (t & keep) | (lo & ~keep);
+  keep = lanes_ge(hi, t);
+  t = (t & keep) | (hi & ~keep);
+  return t - kLaneBias * kLaneLow;
+}
+
+// The rescale of the reference Add is an exact integer sum when both inputs
+// and the output have the same scale: each input is multiplied by 0.5 after
+// being shifted left, and the sum is multiplied by 2^(1 - left_shift).
+bool is_integer_add(const tflite::ArithmeticParams& params) {
+  return params.left_shift == 20 && params.input1_multiplier == 1 << 30 &&
+         params.input2_multiplier == 1 << 30 && params.input1_shift == 0 &&
+         params.input2_shift == 0 && params.output_multiplier == 1 << 30 &&
+         params.output_shift == 2 - params.left_shift;
+}
+
+inline int32_t add_rescale_input(int32_t value, int32_t multiplier,
+                                 int32_t shift, int left_shift) {
+  return tflite::MultiplyByQuantizedMultiplierSmallerThanOneExp(
+      value * (1 << left_shift), multiplier, shift);
+}
+
+void add_separable(const tflite::ArithmeticParams& params,
+                   const int8_t* input1, const int8_t* input2, int size,
+                   int8_t* output) {
+  for (int i = 0; i < ELEMENTWISE_TABLE_SIZE; i++) {
+    add_tables[0][i] =
+        add_rescale_input(params.input1_offset + i - 128,
+                          params.input1_multiplier, params.input1_shift,
+                          params.left_shift);
+    add_tables[1][i] =
+        add_rescale_input(params.input2_offset + i - 128,
+                          params.input2_multiplier, params.input2_shift,
+                          params.left_shift);
+  }
+  for (int i = 0; i < size; i++) {
+    const int32_t raw_sum =
+        add_tables[0][input1[i] + 128] + add_tables[1][input2[i] + 128];
+    const int32_t raw_output =
+        tflite::MultiplyByQuantizedMultiplierSmallerThanOneExp(
+            raw_sum, params.output_multiplier, params.output_shift) +
+        params.output_offset;
+    output[i] = clamp(raw_output, params.quantized_activation_min,
+                      params.quantized_activation_max);
+  }
+}
+
+inline int8_t add_func(int8_t x, int8_t y,
+                       const tflite::ArithmeticParams& params) {
+  return tflite::reference_integer_ops::AddFunc(x, y, params);
+}
+
+inline int8_t mul_func(int8_t x, int8_t y,
+                       const tflite::ArithmeticParams& params) {
+  const int32_t input1_val = params.input1_offset + x;
+  const int32_t input2_val = params.input2_offset + y;
+  return clamp(params.output_offset +
+                   tflite::MultiplyByQuantizedMultiplier(
+                       input1_val * input2_val, params.output_multiplier,
+                       params.output_shift),
+               params.quantized_activation_min,
+               params.quantized_activation_max);
+}
+
+}  // anonymous namespace
+
+void elementwise_add_offset(const int8_t* input1, const int8_t* input2,
+                            int32_t offset, int32_t min, int32_t max,
+                            int size, int8_t* output) {
+  int i = 0;
+  if (is_word_aligned(input1) && is_word_aligned(output) &&
+      (!input2 || is_word_aligned(input2))) {
+    // Each lane holds value + 128 for each input, so the constant removes
+    // the extra 128 from a second input.
+    const int32_t k = offset + kLaneBias - (input2 ? 128 : 0);
+    const uint32_t k_lanes = k * kLaneLow;
+    const uint32_t lo = (min + 128 + kLaneBias) * kLaneLow;
+    const uint32_t hi = (max + 128 + kLaneBias) * kLaneLow;
+    const uint32_t* in1 = reinterpret_cast<const uint32_t*>(input1);
+    const uint32_t* in2 = reinterpret_cast<const uint32_t*>(input2);
+    uint32_t* out = reinterpret_cast<uint32_t*>(output);
+    for (; i + 4 <= size; i += 4) {
+      const uint32_t a = *in1++ ^ kSignBits;
+      const uint32_t b = in2 ? *in2++ ^ kSignBits : 0;
+      const uint32_t even = add_lanes(a & kByteLanes, b & kByteLanes,
+                                      k_lanes, lo, hi);
+      const uint32_t odd = add_lanes((a >> 8) & kByteLanes,
+                                     (b >> 8) & kByteLanes, k_lanes, lo, hi);
+      *out++ = (even | (odd << 8)) ^ kSignBits;
+    }
+  }
+  for (; i < size; i++) {
+    output[i] = clamp(input1[i] + (input2 ? input2[i] : 0) + offset, min, max);
+  }
+}
+
+void elementwise_lookup(const int8_t* table, const int8_t* input, int size,
+                        int8_t* output) {
+  int i = 0;
+  if (is_word_aligned(input) && is_word_aligned(output)) {
+    const uint32_t* in = reinterpret_cast<const uint32_t*>(input);
+    uint32_t* out = reinterpret_cast<uint32_t*>(output);
+    for (; i + 4 <= size; i += 4) {
+      const uint32_t w = *in++ ^ kSignBits;
+      *out++ = static_cast<uint8_t>(table[w & 0xff]) |
+               static_cast<uint8_t>(table[(w >> 8) & 0xff]) << 8 |
+               static_cast<uint8_t>(table[(w >> 16) & 0xff]) << 16 |
+               static_cast<uint32_t>(static_cast<uint8_t>(table[w >> 24]))
+                   << 24;
+    }
+  }
+  for (; i < size; i++) {
+    output[i] = table[input[i] + 128];
+  }
+}
+
+bool elementwise_add(const tflite::ArithmeticParams& params,
+                     const int8_t* input1, int size1, const int8_t* input2,
+                     int size2, int8_t* output) {
+  if (size1 == size2) {
+    if (is_integer_add(params)) {
+      elementwise_add_offset(
+          input1, input2, params.input1_offset + params.input2_offset +
+                              params.output_offset,
+          params.quantized_activation_min, params.quantized_activation_max,
+          size1, output);
+      return true;
+    }
+    if (size1 < ELEMENTWISE_MIN_TABLE_ELEMENTS) return false;
+    add_separable(params, input1, input2, size1, output);
+    return true;
+  }
+
+  // One input is a single value, so the op is unary in the other.
+  const bool scalar_first = size1 == 1;
+  const int size = scalar_first ? size2 : size1;
+  if ((size1 != 1 && size2 != 1) || size < ELEMENTWISE_MIN_TABLE_ELEMENTS) {
+    return false;
+  }
+  const int8_t scalar = scalar_first ? *input1 : *input2;
+  for (int i = 0; i < ELEMENTWISE_TABLE_SIZE; i++) {
+    const int8_t x = static_cast<int8_t>(i - 128);
+    unary_table[i] = scalar_first ? add_func(scalar, x, params)
+                                  : add_func(x, scalar, params);
+  }
+  elementwise_lookup(unary_table, scalar_first ? input2 : input1, size,
+                     output);
+  return true;
+}
+
+bool elementwise_mul(const tflite::ArithmeticParams& params,
+                     const int8_t* input1, int size1, const int8_t* input2,
+                     int size2, int8_t* output) {
+  // With two full inputs, the reference kernel already has one multiply per
+  // element, so there is nothing to gain.
+  const bool scalar_first = size1 == 1;
+  const int size = scalar_first ? size2 : size1;
+  if (size1 == size2 || (size1 != 1 && size2 != 1) ||
+      size < ELEMENTWISE_MIN_TABLE_ELEMENTS) {
+    return false;
+  }
+  const int8_t scalar = scalar_first ? *input1 : *input2;
+  for (int i = 0; i < ELEMENTWISE_TABLE_SIZE; i++) {
+    const int8_t x = static_cast<int8_t>(i - 128);
+    unary_table[i] = scalar_first ? mul_func(scalar, x, params)
+                                  : mul_func(x, scalar, params);
+  }
+  elementwise_lookup(unary_table, scalar_first ? input2 : input1, size,
+                     output);
+  return true;
+}
+
+void elementwise_requantize_table(int32_t multiplier, int32_t shift,
+                                  int32_t input_zero_point,
+                                  int32_t output_zero_point, int8_t* table) {
+  for (int i = 0; i < ELEMENTWISE_TABLE_SIZE; i++) {
+    const int32_t output =
+        tflite::MultiplyByQuantizedMultiplier(i - 128 - input_zero_point,
+                                              multiplier, shift) +
+        output_zero_point;
+    table[i] = clamp(output, -128, 127);
+  }
+}
+
+void elementwise_requantize(int32_t multiplier, int32_t shift,
+                            int32_t input_zero_point,
+                            int32_t output_zero_point, const int8_t* table,
+                            const int8_t* input, int size, int8_t* output) {
+  // Same check as reference_ops::Requantize() for equal scales.
+  if (multiplier == 1 << 30 && shift == 1) {
+    elementwise_add_offset(input, nullptr,
+                           output_zero_point - input_zero_point, -128, 127,
+                           size, output);
+  } else {
+    elementwise_lookup(table, input, size, output);
+  }
+}
@@ -0,0 +1,86 @@
+/*
+ * Copyright 2021 The CFU-Playground Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Elementwise engine for int8 Add, Mul and Quantize.
+//
+// The reference kernels rescale every element with 64 bit multiplies. This
+// avoids them where the op's parameters allow:
+//
+//   * When the rescale is exactly an integer offset (Add with equal input and
+//     output scales, Quantize that only moves the zero point), four lanes are
+//     processed per 32 bit word, with the activation clamp done in SWAR.
+//   * When one side of the op is a single value, or for any int8 -> int8
+//     Quantize, the op is unary and is done by lookup in a 256 entry table.
+//   * Otherwise Add is separable: each input is rescaled through a table, so
+//     only the final rescale is done per element.
+//
+// Results are bit exact with the reference kernels. Every function reads an
+// element before writing the element at the same index, so the output may be
+// the same buffer as an input. scripts/tflite_memory_planner.py --in-place
+// plans models that way.
+//
+// The kernel overrides in common/src/tensorflow/lite/micro/kernels use this
+// when ELEMENTWISE_ENGINE is defined.
+
+#ifndef _ELEMENTWISE_H
+#define _ELEMENTWISE_H
+
+#include <stdint.h>
+
+#include "tensorflow/lite/kernels/internal/types.h"
+
+// Size of a unary op table, indexed by input value + 128.
+#define ELEMENTWISE_TABLE_SIZE 256
+
+// Fewest elements for which building a table at Eval time pays off.
+#define ELEMENTWISE_MIN_TABLE_ELEMENTS 256
+
+// Add, as reference_integer_ops::Add. size1 and size2 are the element counts
+// of the inputs; one may be 1, otherwise both must equal the output size.
+// Returns false, having done nothing, if the reference kernel should be used.
+bool elementwise_add(const tflite::ArithmeticParams& params,
+                     const int8_t* input1, int size1, const int8_t* input2,
+                     int size2, int8_t* output);
+
+// Mul, as reference_integer_ops::Mul, with the same contract as
+// elementwise_add(). Only the case of one single-value input is handled.
+bool elementwise_mul(const tflite::ArithmeticParams& params,
+                     const int8_t* input1, int size1, const int8_t* input2,
+                     int size2, int8_t* output);
+
+// Fills table with reference_ops::Requantize() of every int8 value.
+void elementwise_requantize_table(int32_t multiplier, int32_t shift,
+                                  int32_t input_zero_point,
+                                  int32_t output_zero_point, int8_t* table);
+
+// int8 -> int8 Quantize, using a table from elementwise_requantize_table().
+// The table is not read if the rescale is only a change of zero point.
+void elementwise_requantize(int32_t multiplier, int32_t shift,
+                            int32_t input_zero_point,
+                            int32_t output_zero_point, const int8_t* table,
+                            const int8_t* input, int size, int8_t* output);
+
+// Maps each element through a unary op table.
+void elementwise_lookup(const int8_t* table, const int8_t* input, int size,
+                        int8_t* output);
+
+// output = clamp(input1 + input2 + offset, min, max), four lanes at a time.
+// input2 may be null, in which case only input1 and offset are added.
+void elementwise_add_offset(const int8_t* input1, const int8_t* input2,
+                            int32_t offset, int32_t min, int32_t max,
+                            int size, int8_t* output);
+
+#endif  // _ELEMENTWISE_H
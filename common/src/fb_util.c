@@ -24,6 +24,7 @@
 #include <generated/mem.h>
 #include <system.h>
 
+#include "cache_range.h"
 #include "menu.h"
 #include "perf.h"
 
@@ -127,6 +128,29 @@ void fb_close()
     memset(fb_ptr, 0x00, fb_len);
 }
 
+void fb_flush()
+{
+    cache_flush_range((const void *) FB_BASE_ADDR,
+                      FB_WIDTH * FB_HEIGHT * sizeof(uint32_t));
+}
+
+void fb_flush_rect(uint32_t left, uint32_t top, uint32_t width,
+                   uint32_t height)
+{
+    const uint32_t *fb32_ptr = (const uint32_t *) FB_BASE_ADDR;
+
+    if (left >= FB_WIDTH || top >= FB_HEIGHT)
+        return;
+    width = width > (FB_WIDTH - left) ? (FB_WIDTH - left) : width;
+    height = height > (FB_HEIGHT - top) ? (FB_HEIGHT - top) : height;
+    if (width == 0 || height == 0)
+        return;
+
+    // From the first pixel of the top row to the last of the bottom row
+    cache_flush_range(fb32_ptr + top * FB_WIDTH + left,
+                      ((height - 1) * FB_WIDTH + width) * sizeof(uint32_t));
+}
+
 int32_t
 fb_fill_rect(uint32_t left, uint32_t top, uint32_t width, uint32_t height,
              uint32_t color)
@@ -439,16 +463,16 @@ void fb_fill(void)
 {
     fb_fill_rect(0, 0, 320, 240, 0x00FF0000);
     fb_fill_rect(320, 240, 320, 240, 0x00FF0000);
-    flush_cpu_dcache();
-    flush_l2_cache();
+    fb_flush_rect(0, 0, 320, 240);
+    fb_flush_rect(320, 240, 320, 240);
 }
 
 void fb_draw(void)
 {
     fb_draw_rect(0, 0, 320, 240, 0x00FFFF00);
     fb_draw_rect(320, 240, 320, 240, 0x00FF0000);
-    flush_cpu_dcache();
-    flush_l2_cache();
+    fb_flush_rect(0, 0, 320, 240);
+    fb_flush_rect(320, 240, 320, 240);
 }
 
 void fb_line(void)
@@ -458,8 +482,7 @@ void fb_line(void)
     fb_draw_line(0, 100, 100, 100, 0x0000FFFF, 1);
     fb_draw_line(0, 0, 320, 240, 0x000FFFFF, 1);
     fb_draw_line(0, 240, 320, 0, 0x00FFFFFF, 1);
-    flush_cpu_dcache();
-    flush_l2_cache();
+    fb_flush_rect(0, 0, 321, 241);
 }
 
 void fb_msg(void)
@@ -468,12 +491,13 @@ void fb_msg(void)
     static uint32_t color = 0x00889922;
 
     fb_draw_string(0, x, color, "Hello CFU Playground!!");
+    fb_flush_rect(0, x, FB_WIDTH, df_info.font_height);
     x = (x > FB_HEIGHT) ? 0 : (x + 16);
-    if (x == 0)
+    if (x == 0) {
         fb_clear();
+        fb_flush();
+    }
     color += 0x1234;
-    flush_cpu_dcache();
-    flush_l2_cache();
 }
 
 /*
@@ -43,6 +43,13 @@ void fb_init();
 void fb_clear();
 void fb_close();
 
+// Makes drawing visible to the video DMA: over the whole framebuffer, or
+// over a rectangle of it. The part of the rectangle outside the framebuffer
+// is ignored.
+void fb_flush();
+void fb_flush_rect(uint32_t left, uint32_t top, uint32_t width,
+                   uint32_t height);
+
 int32_t fb_fill_rect(uint32_t left, uint32_t top, uint32_t width,
                      uint32_t height, uint32_t color);
 int32_t fb_draw_rect(uint32_t left, uint32_t top, uint32_t width,
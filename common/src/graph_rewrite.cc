@@ -0,0 +1,405 @@
+/*
+ * Copyright 2021 The CFU-Playground Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "graph_rewrite.h"
+
+#include <cstdio>
+#include <cstring>
+
+#include "node_index.h"
+#include "tensorflow/lite/micro/kernels/conv.h"
+#include "tensorflow/lite/micro/memory_helpers.h"
+#include "tensorflow/lite/schema/schema_utils.h"
+
+namespace {
+
+constexpr int kMaxFusions = 8;
+constexpr int kMaxRecords = 32;
+// Maximum number of distinct op types that may take part in fusions
+constexpr int kMaxSlots = 4;
+
+const Fusion* fusions[kMaxFusions];
+int num_fusions = 0;
+
+FusionRecord records[kMaxRecords];
+int num_records = 0;
+
+tflite::BuiltinOperator OpCode(const tflite::Model* model,
+                               const tflite::Operator* op) {
+  return tflite::GetBuiltinCode(
+      model->operator_codes()->Get(op->opcode_index()));
+}
+
+bool Contains(const flatbuffers::Vector<int32_t>* v, int32_t value) {
+  for (size_t i = 0; i < v->size(); i++) {
+    if (v->Get(i) == value) return true;
+  }
+  return false;
+}
+
+// Returns the index of the only op consuming tensor, or -1 if there is not
+// exactly one consumer or if the tensor is a subgraph output.
+int SoleConsumer(const tflite::SubGraph* subgraph, int32_t tensor) {
+  if (Contains(subgraph->outputs(), tensor)) return -1;
+  int consumer = -1;
+  auto* ops = subgraph->operators();
+  for (size_t i = 0; i < ops->size(); i++) {
+    auto* inputs = ops->Get(i)->inputs();
+    for (size_t j = 0; j < inputs->size(); j++) {
+      if (inputs->Get(j) == tensor) {
+        if (consumer != -1) return -1;
+        consumer = i;
+      }
+    }
+  }
+  return consumer;
+}
+
+// Returns true if the memory planner keeps tensor alive until op runs: if it
+// is variable, constant, a subgraph output, or an input of op or a later op.
+bool LiveUntil(const tflite::Model* model, const tflite::SubGraph* subgraph,
+               int32_t tensor, int op) {
+  const tflite::Tensor* t = subgraph->tensors()->Get(tensor);
+  auto* buffer = model->buffers()->Get(t->buffer());
+  if (t->is_variable()) return true;
+  if (buffer && buffer->data() && buffer->data()->size()) return true;
+  if (Contains(subgraph->outputs(), tensor)) return true;
+  auto* ops = subgraph->operators();
+  for (size_t i = op; i < ops->size(); i++) {
+    if (Contains(ops->Get(i)->inputs(), tensor)) return true;
+  }
+  return false;
+}
+
+// Returns the number of elements in tensor, or -1 if its shape is unknown
+int64_t NumElements(const tflite::SubGraph* subgraph, int32_t tensor) {
+  auto* shape = subgraph->tensors()->Get(tensor)->shape();
+  if (shape == nullptr) return -1;
+  int64_t n = 1;
+  for (size_t i = 0; i < shape->size(); i++) {
+    if (shape->Get(i) < 0) return -1;
+    n *= shape->Get(i);
+  }
+  return n;
+}
+
+// Returns true if tensor "from" can be copied into tensor "to"
+bool Fits(const tflite::SubGraph* subgraph, int32_t from, int32_t to) {
+  auto* tensors = subgraph->tensors();
+  int64_t from_elements = NumElements(subgraph, from);
+  return tensors->Get(from)->type() == tensors->Get(to)->type() &&
+         from_elements >= 0 && NumElements(subgraph, to) >= from_elements;
+}
+
+bool IsFused(int op_index) {
+  for (int i = 0; i < num_records; i++) {
+    if (records[i].first_op == op_index || records[i].second_op == op_index) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Tries to apply fusion to first_op. Returns true if applied.
+bool TryFusion(const tflite::Model* model, const tflite::SubGraph* subgraph,
+               const Fusion* fusion, int first_op) {
+  auto* ops = subgraph->operators();
+  const tflite::Operator* first = ops->Get(first_op);
+  if (OpCode(model, first) != fusion->first || first->outputs()->size() != 1 ||
+      first->inputs()->size() < 1) {
+    return false;
+  }
+  int32_t first_output = first->outputs()->Get(0);
+  int second_op = SoleConsumer(subgraph, first_output);
+  if (second_op < 0 || IsFused(second_op)) return false;
+  const tflite::Operator* second = ops->Get(second_op);
+  if (OpCode(model, second) != fusion->second ||
+      second->outputs()->size() != 1) {
+    return false;
+  }
+
+  FusionRecord& r = records[num_records];
+  memset(&r, 0, sizeof(r));
+  if (!fusion->can_fuse(model, subgraph, first, second, r.params)) {
+    return false;
+  }
+  int32_t first_input = first->inputs()->Get(0);
+  r.copy_input = !LiveUntil(model, subgraph, first_input, second_op);
+  if (r.copy_input && !Fits(subgraph, first_input, first_output)) {
+    return false;
+  }
+  r.fusion = fusion;
+  r.first_op = first_op;
+  r.second_op = second_op;
+  r.first_input_tensor = first_input;
+  r.first_output_tensor = first_output;
+  r.second_output_tensor = second->outputs()->Get(0);
+  for (size_t i = 0; i < second->inputs()->size(); i++) {
+    if (second->inputs()->Get(i) == first_output) r.second_input = i;
+  }
+  num_records++;
+  return true;
+}
+
+FusionRecord* FindRecord(TfLiteContext* context, const TfLiteNode* node,
+                         bool* is_first) {
+  if (num_records == 0) return nullptr;
+  tflite::MicroGraph& graph = tflite::GetMicroContext(context)->graph();
+  if (graph.GetCurrentSubgraphIndex() != 0) return nullptr;
+  int op = node_index(context, node);
+  for (int i = 0; i < num_records; i++) {
+    if (records[i].first_op == op || records[i].second_op == op) {
+      *is_first = records[i].first_op == op;
+      return &records[i];
+    }
+  }
+  return nullptr;
+}
+
+// Points node at a copy of its input list, with the first op's input in
+// place of its output
+TfLiteStatus RewireInputs(TfLiteContext* context, TfLiteNode* node,
+                          FusionRecord* r) {
+  int size = node->inputs->size;
+  r->second_inputs = static_cast<TfLiteIntArray*>(
+      context->AllocatePersistentBuffer(
+          context, sizeof(TfLiteIntArray) + size * sizeof(int)));
+  TF_LITE_ENSURE(context, r->second_inputs != nullptr);
+  r->second_inputs->size = size;
+  for (int i = 0; i < size; i++) {
+    r->second_inputs->data[i] = node->inputs->data[i];
+  }
+  r->second_inputs->data[r->second_input] = r->first_input_tensor;
+  node->inputs = r->second_inputs;
+  return kTfLiteOk;
+}
+
+// Copies the first op's input into its output, where it will not be
+// overwritten before the second op runs
+TfLiteStatus CopyInput(TfLiteContext* context, const FusionRecord* r) {
+  const TfLiteEvalTensor* input =
+      context->GetEvalTensor(context, r->first_input_tensor);
+  TfLiteEvalTensor* output =
+      context->GetEvalTensor(context, r->first_output_tensor);
+  size_t bytes;
+  TF_LITE_ENSURE_STATUS(tflite::TfLiteEvalTensorByteLength(input, &bytes));
+  memcpy(output->data.data, input->data.data, bytes);
+  return kTfLiteOk;
+}
+
+// Dispatching registrations, one per op type taking part in a fusion. Each
+// slot wraps the original registration for that op type.
+TfLiteRegistration originals[kMaxSlots];
+TfLiteRegistration dispatchers[kMaxSlots];
+tflite::BuiltinOperator slot_ops[kMaxSlots];
+int num_slots = 0;
+
+template <int kSlot>
+TfLiteStatus DispatchPrepare(TfLiteContext* context, TfLiteNode* node) {
+  bool is_first;
+  FusionRecord* r = FindRecord(context, node, &is_first);
+  const TfLiteRegistration* original = &originals[kSlot];
+  if (r && is_first) return kTfLiteOk;
+  if (r) {
+    TF_LITE_ENSURE_STATUS(RewireInputs(context, node, r));
+    return r->fusion->prepare(context, node, original, r);
+  }
+  return original->prepare ? original->prepare(context, node) : kTfLiteOk;
+}
+
+template <int kSlot>
+TfLiteStatus DispatchInvoke(TfLiteContext* context, TfLiteNode* node) {
+  bool is_first;
+  const FusionRecord* r = FindRecord(context, node, &is_first);
+  const TfLiteRegistration* original = &originals[kSlot];
+  if (!r) return original->invoke(context, node);
+  if (is_first) return r->copy_input ? CopyInput(context, r) : kTfLiteOk;
+
+  // Read the copy of the first op's input for the duration of the op
+  TfLiteEvalTensor* input =
+      context->GetEvalTensor(context, r->first_input_tensor);
+  void* input_data = input->data.data;
+  if (r->copy_input) {
+    input->data.data =
+        context->GetEvalTensor(context, r->first_output_tensor)->data.data;
+  }
+  TfLiteStatus status = r->fusion->invoke
+                            ? r->fusion->invoke(context, node, original, r)
+                            : original->invoke(context, node);
+  input->data.data = input_data;
+  return status;
+}
+
+typedef TfLiteStatus (*KernelFn)(TfLiteContext*, TfLiteNode*);
+const KernelFn kDispatchPrepare[kMaxSlots] = {
+    DispatchPrepare<0>, DispatchPrepare<1>, DispatchPrepare<2>,
+    DispatchPrepare<3>};
+const KernelFn kDispatchInvoke[kMaxSlots] = {
+    DispatchInvoke<0>, DispatchInvoke<1>, DispatchInvoke<2>,
+    DispatchInvoke<3>};
+
+class FusingOpResolver : public tflite::MicroOpResolver {
+ public:
+  explicit FusingOpResolver(tflite::MicroOpResolver* base) : base_(base) {}
+
+  const TfLiteRegistration* FindOp(tflite::BuiltinOperator op) const override {
+    const TfLiteRegistration* registration = base_->FindOp(op);
+    if (registration == nullptr || !InAppliedFusion(op)) return registration;
+    for (int i = 0; i < num_slots; i++) {
+      if (slot_ops[i] == op) return &dispatchers[i];
+    }
+    if (num_slots == kMaxSlots) {
+      printf("Fusion: too many op types, not fusing %s\n",
+             tflite::EnumNameBuiltinOperator(op));
+      return registration;
+    }
+    int slot = num_slots++;
+    slot_ops[slot] = op;
+    originals[slot] = *registration;
+    dispatchers[slot] = *registration;
+    dispatchers[slot].prepare = kDispatchPrepare[slot];
+    dispatchers[slot].invoke = kDispatchInvoke[slot];
+    return &dispatchers[slot];
+  }
+
+  const TfLiteRegistration* FindOp(const char* op) const override {
+    return base_->FindOp(op);
+  }
+
+  BuiltinParseFunction GetOpDataParser(
+      tflite::BuiltinOperator op) const override {
+    return base_->GetOpDataParser(op);
+  }
+
+ private:
+  static bool InAppliedFusion(tflite::BuiltinOperator op) {
+    for (int i = 0; i < num_records; i++) {
+      if (records[i].fusion->first == op || records[i].fusion->second == op) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  tflite::MicroOpResolver* base_;
+};
+
+// PAD followed by VALID CONV_2D. The reference conv kernel treats positions
+// outside the input as the input zero point, which is exactly what PAD
+// writes, so the pad can be folded into the conv's padding values.
+bool PadConvCanFuse(const tflite::Model* model,
+                    const tflite::SubGraph* subgraph,
+                    const tflite::Operator* first,
+                    const tflite::Operator* second, int32_t* params) {
+  if (first->inputs()->size() != 2 || second->inputs()->Get(0) !=
+                                          first->outputs()->Get(0)) {
+    return false;
+  }
+  const tflite::Tensor* input = subgraph->tensors()->Get(first->inputs()->Get(0));
+  if (input->type() != tflite::TensorType_INT8) return false;
+  auto* options = second->builtin_options_as_Conv2DOptions();
+  if (options == nullptr || options->padding() != tflite::Padding_VALID) {
+    return false;
+  }
+
+  // Paddings must be a constant int32 [4, 2] tensor
+  const tflite::Tensor* paddings =
+      subgraph->tensors()->Get(first->inputs()->Get(1));
+  if (paddings->type() != tflite::TensorType_INT32) return false;
+  auto* buffer = model->buffers()->Get(paddings->buffer());
+  if (buffer == nullptr || buffer->data() == nullptr ||
+      buffer->data()->size() != 8 * sizeof(int32_t)) {
+    return false;
+  }
+  int32_t p[8];
+  memcpy(p, buffer->data()->data(), sizeof(p));
+
+  // Only height and width may be padded
+  if (p[0] || p[1] || p[6] || p[7]) return false;
+  params[0] = p[2];  // top
+  params[1] = p[4];  // left
+  return true;
+}
+
+TfLiteStatus PadConvPrepare(TfLiteContext* context, TfLiteNode* node,
+                            const TfLiteRegistration* original,
+                            const FusionRecord* record) {
+  // Accelerated conv kernels assume VALID means no padding. Clear it before
+  // the original prepare, so that kernels chosen there fall back to the
+  // reference kernel, which honours the padding values.
+  auto* params = static_cast<TfLiteConvParams*>(node->builtin_data);
+  params->padding = kTfLitePaddingUnknown;
+  TF_LITE_ENSURE_STATUS(original->prepare(context, node));
+  auto* data = static_cast<tflite::OpDataConv*>(node->user_data);
+  data->padding.height = record->params[0];
+  data->padding.width = record->params[1];
+  return kTfLiteOk;
+}
+
+}  // anonymous namespace
+
+const Fusion kFusionPadConv = {
+    "PAD+CONV_2D",
+    tflite::BuiltinOperator_PAD,
+    tflite::BuiltinOperator_CONV_2D,
+    PadConvCanFuse,
+    PadConvPrepare,
+    nullptr,
+};
+
+void graph_rewrite_register(const Fusion* fusion) {
+  for (int i = 0; i < num_fusions; i++) {
+    if (fusions[i] == fusion) return;
+  }
+  if (num_fusions == kMaxFusions) {
+    printf("Fusion %s: too many fusions\n", fusion->name);
+    return;
+  }
+  fusions[num_fusions++] = fusion;
+}
+
+int graph_rewrite_apply(const tflite::Model* model) {
+  num_records = 0;
+  num_slots = 0;
+  if (num_fusions == 0 || model->subgraphs()->size() < 1) return 0;
+
+  const tflite::SubGraph* subgraph = model->subgraphs()->Get(0);
+  size_t num_ops = subgraph->operators()->size();
+  for (size_t op = 0; op < num_ops && num_records < kMaxRecords; op++) {
+    if (IsFused(op)) continue;
+    for (int f = 0; f < num_fusions; f++) {
+      if (TryFusion(model, subgraph, fusions[f], op)) break;
+    }
+  }
+  return num_records;
+}
+
+void graph_rewrite_clear() { num_records = 0; }
+
+void graph_rewrite_print_report() {
+  if (num_fusions == 0) return;
+  printf("Fusions applied: %d\n", num_records);
+  for (int i = 0; i < num_records; i++) {
+    printf("  %-20s ops %3d, %3d\n", records[i].fusion->name,
+           records[i].first_op, records[i].second_op);
+  }
+}
+
+tflite::MicroOpResolver* graph_rewrite_resolver(
+    tflite::MicroOpResolver* base) {
+  static FusingOpResolver resolver(base);
+  return &resolver;
+}
@@ -0,0 +1,114 @@
+/*
+ * Copyright 2021 The CFU-Playground Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Load-time graph rewriting for kernel fusion.
+//
+// A fusion replaces a pair of ops, where the only consumer of the first op's
+// output is the second op, with a single fused kernel. The rewrite runs after
+// the model is parsed and before tensors are allocated:
+//
+//   1. The second op's input list is replaced, at prepare time, by a copy in
+//      the arena that names the first op's input in place of its output.
+//   2. The first op is skipped at prepare time. At invoke time it does
+//      nothing if the memory planner keeps its input alive until the second
+//      op runs. Otherwise it copies its input into its output tensor, which
+//      the planner does keep alive, and the second op reads it from there.
+//   3. The second op's prepare and invoke are replaced by the fusion's.
+//
+// The model flatbuffer is never modified, so models in ROM may be fused.
+// Fused nodes are found by their operator index.
+//
+// Projects add fusions by calling graph_rewrite_register() from
+// tflite_register_fusions() (see proj_tflite.h).
+
+#ifndef _GRAPH_REWRITE_H
+#define _GRAPH_REWRITE_H
+
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/micro/micro_op_resolver.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+
+// Number of parameters a fusion may capture at load time
+constexpr int kFusionMaxParams = 4;
+
+struct Fusion;
+
+// An applied fusion
+struct FusionRecord {
+  const Fusion* fusion;
+  // Indices of the first and second op in subgraph 0
+  int first_op;
+  int second_op;
+  // Index of the second op's input that was rewired
+  int second_input;
+  // Tensor consumed by the first op, which the second op reads instead
+  int32_t first_input_tensor;
+  // Tensor produced by the first op, originally consumed by the second
+  int32_t first_output_tensor;
+  // Tensor produced by the second op
+  int32_t second_output_tensor;
+  // Whether the first op copies its input into its output, because the
+  // input might be overwritten before the second op runs
+  bool copy_input;
+  // The second op's rewired input list, allocated at prepare time
+  TfLiteIntArray* second_inputs;
+  // Values captured by Fusion::can_fuse
+  int32_t params[kFusionMaxParams];
+};
+
+struct Fusion {
+  // Name printed in the report
+  const char* name;
+  tflite::BuiltinOperator first;
+  tflite::BuiltinOperator second;
+
+  // Called at load time. Returns true if the two ops may be fused, filling
+  // params with any values needed by prepare and invoke.
+  bool (*can_fuse)(const tflite::Model* model, const tflite::SubGraph* subgraph,
+                   const tflite::Operator* first,
+                   const tflite::Operator* second, int32_t* params);
+
+  // Replace the second op's prepare and invoke. original is the registration
+  // of the second op, which the fusion may call. invoke may be null, in which
+  // case the original invoke is used.
+  TfLiteStatus (*prepare)(TfLiteContext* context, TfLiteNode* node,
+                          const TfLiteRegistration* original,
+                          const FusionRecord* record);
+  TfLiteStatus (*invoke)(TfLiteContext* context, TfLiteNode* node,
+                         const TfLiteRegistration* original,
+                         const FusionRecord* record);
+};
+
+// Registers a fusion. Fusions are tried in registration order.
+void graph_rewrite_register(const Fusion* fusion);
+
+// Discards any previous rewrite, then applies registered fusions to subgraph
+// 0 of the model. Returns the number of fusions applied.
+int graph_rewrite_apply(const tflite::Model* model);
+
+// Discards any previous rewrite, so that no op is fused.
+void graph_rewrite_clear();
+
+// Prints the fusions applied by the last call to graph_rewrite_apply().
+void graph_rewrite_print_report();
+
+// Returns an op resolver that dispatches fused ops, wrapping base.
+tflite::MicroOpResolver* graph_rewrite_resolver(tflite::MicroOpResolver* base);
+
+// Fuses PAD into a following VALID CONV_2D on the reference conv kernel.
+extern const Fusion kFusionPadConv;
+
+#endif  // _GRAPH_REWRITE_H
@@ -0,0 +1,118 @@
+/*
+ * Copyright 2021 The CFU-Playground Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "integer_quantize.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "tensorflow/lite/kernels/internal/cppmath.h"
+
+namespace {
+
+// Maps float bit patterns to integers with the same order as the floats.
+// Negative floats have their magnitude bits flipped, so that larger
+// magnitudes sort lower. -0 sorts just below +0.
+inline int32_t order_key(int32_t bits) {
+  return bits ^ ((bits >> 31) & 0x7fffffff);
+}
+
+inline int32_t float_key(float value) {
+  int32_t bits;
+  memcpy(&bits, &value, sizeof(bits));
+  return order_key(bits);
+}
+
+inline float key_float(int32_t key) {
+  const int32_t bits = order_key(key);
+  float value;
+  memcpy(&value, &bits, sizeof(value));
+  return value;
+}
+
+// The reference quantization of a single value.
+int32_t quantize_one(float value, double scale, int32_t zero_point) {
+  const int32_t unclamped =
+      static_cast<int32_t>(
+          tflite::TfLiteRound(value / static_cast<float>(scale))) +
+      zero_point;
+  return std::min<int32_t>(std::max<int32_t>(unclamped, -128), 127);
+}
+
+// Returns the key of the smallest float that quantizes to at least q.
+int32_t find_threshold(int32_t q, double scale, int32_t zero_point) {
+  const float s = static_cast<float>(scale);
+  const float steps = static_cast<float>(q - zero_point);
+  // Values a whole step either side of the threshold
+  int32_t lo = float_key((steps - 1.0f) * s);
+  int32_t hi = float_key(steps * s);
+  // The threshold is usually within a few ulps of its estimate, so try a
+  // narrow bracket first.
+  const int32_t estimate = float_key((steps - 0.5f) * s);
+  if (quantize_one(key_float(estimate - 8), scale, zero_point) < q &&
+      quantize_one(key_float(estimate + 8), scale, zero_point) >= q) {
+    lo = estimate - 8;
+    hi = estimate + 8;
+  }
+  // Invariant: lo quantizes below q, hi to at least q
+  while (hi - lo > 1) {
+    const int32_t mid = lo + (hi - lo) / 2;
+    if (quantize_one(key_float(mid), scale, zero_point) >= q) {
+      hi = mid;
+    } else {
+      lo = mid;
+    }
+  }
+  return hi;
+}
+
+}  // anonymous namespace
+
+void integer_quantize_thresholds(double scale, int32_t zero_point,
+                                 int32_t* thresholds) {
+  for (int i = 0; i < INTEGER_QUANTIZE_NUM_THRESHOLDS; i++) {
+    thresholds[i] = find_threshold(i - 127, scale, zero_point);
+  }
+}
+
+void integer_quantize(const int32_t* thresholds, const float* input, int size,
+                      int8_t* output) {
+  for (int i = 0; i < size; i++) {
+    const int32_t key = float_key(input[i]);
+    // Count the thresholds at or below key
+    int count = 0;
+    for (int step = 128; step > 0; step >>= 1) {
+      if (thresholds[count + step - 1] <= key) {
+        count += step;
+      }
+    }
+    output[i] = static_cast<int8_t>(count - 128);
+  }
+}
+
+void integer_dequantize_table(double scale, int32_t zero_point, float* table) {
+  for (int i = 0; i < INTEGER_DEQUANTIZE_TABLE_SIZE; i++) {
+    const int32_t val = i - 128;
+    table[i] = static_cast<float>(scale * (val - zero_point));
+  }
+}
+
+void integer_dequantize(const float* table, const int8_t* input, int size,
+                        float* output) {
+  for (int i = 0; i < size; i++) {
+    output[i] = table[input[i] + 128];
+  }
+}
@@ -0,0 +1,58 @@
+/*
+ * Copyright 2021 The CFU-Playground Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Integer-only Quantize (float -> int8) and Dequantize (int8 -> float).
+//
+// Without an FPU, the reference kernels make soft-float library calls for
+// every element: a divide and a round to quantize, a double multiply and a
+// conversion to dequantize. Here the float work is done once, at Prepare
+// time, and results are bit exact with the reference kernels:
+//
+//   * Quantize is monotonic in its input, so it is described by the 255
+//     input values at which the output steps up. Each element is quantized
+//     by a binary search for its bit pattern among these, using integer
+//     compares only.
+//   * Dequantize has only 256 possible inputs, so it is a table lookup.
+//
+// The kernel overrides in common/src/tensorflow/lite/micro/kernels use these
+// when INTEGER_QUANTIZE is defined.
+
+#ifndef _INTEGER_QUANTIZE_H
+#define _INTEGER_QUANTIZE_H
+
+#include <stdint.h>
+
+#define INTEGER_QUANTIZE_NUM_THRESHOLDS 255
+#define INTEGER_DEQUANTIZE_TABLE_SIZE 256
+
+// Calculates the thresholds for quantizing with the given parameters, as
+// float bit patterns mapped to sort as signed integers.
+void integer_quantize_thresholds(double scale, int32_t zero_point,
+                                 int32_t* thresholds);
+
+// As reference_ops::AffineQuantize() with int8 output, for finite inputs
+// whose quantized value fits in an int32.
+void integer_quantize(const int32_t* thresholds, const float* input, int size,
+                      int8_t* output);
+
+// Fills table with reference_ops::Dequantize() of every int8 value.
+void integer_dequantize_table(double scale, int32_t zero_point, float* table);
+
+// Maps each element through a table from integer_dequantize_table().
+void integer_dequantize(const float* table, const int8_t* input, int size,
+                        float* output);
+
+#endif  // _INTEGER_QUANTIZE_H
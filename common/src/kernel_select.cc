@@ -0,0 +1,187 @@
+/*
+ * Copyright 2021 The CFU-Playground Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "kernel_select.h"
+
+#include <cstdio>
+#include <cstring>
+
+#include "node_index.h"
+#include "perf.h"
+
+namespace {
+
+constexpr int kMaxOps = 8;
+constexpr int kMaxChoices = 128;
+
+struct OpCandidates {
+  const char* op;
+  const KernelCandidate* candidates[kKernelSelectMaxCandidates];
+  int num_candidates;
+};
+
+OpCandidates ops[kMaxOps];
+int num_ops = 0;
+
+// Choices made since the last reset, in Prepare order
+KernelChoice* choices[kMaxChoices];
+int num_choices = 0;
+
+#ifdef KERNEL_SELECT_AUTOTUNE
+bool autotune = true;
+#else
+bool autotune = false;
+#endif
+
+OpCandidates* FindOp(const char* op) {
+  for (int i = 0; i < num_ops; i++) {
+    if (strcmp(ops[i].op, op) == 0) return &ops[i];
+  }
+  return nullptr;
+}
+
+void Record(KernelChoice* choice) {
+  for (int i = 0; i < num_choices; i++) {
+    if (choices[i] == choice) return;
+  }
+  if (num_choices < kMaxChoices) choices[num_choices++] = choice;
+}
+
+// Runs a candidate, recording the cycles taken in choice
+TfLiteStatus TimedRun(const KernelCandidate* candidate, TfLiteContext* context,
+                      TfLiteNode* node, KernelChoice* choice) {
+  uint32_t start = perf_get_mcycle();
+  TfLiteStatus status = candidate->run(context, node);
+  choice->cycles = perf_get_mcycle() - start;
+  return status;
+}
+
+TfLiteStatus Autotune(const OpCandidates& op, TfLiteContext* context,
+                      TfLiteNode* node, KernelChoice* choice) {
+  int best = -1;
+  uint32_t best_cycles = 0;
+  for (int i = 0; i < op.num_candidates; i++) {
+    if (!(choice->eligible & (1 << i))) continue;
+    if (TimedRun(op.candidates[i], context, node, choice) != kTfLiteOk) {
+      choice->eligible &= ~(1 << i);
+      continue;
+    }
+    if (best < 0 || choice->cycles < best_cycles) {
+      best = i;
+      best_cycles = choice->cycles;
+    }
+  }
+  choice->tuned = true;
+  if (best < 0) return kTfLiteError;
+  choice->candidate = best;
+  choice->cycles = best_cycles;
+  return kTfLiteOk;
+}
+
+}  // anonymous namespace
+
+void kernel_select_register(const char* op, const KernelCandidate* candidate) {
+  OpCandidates* entry = FindOp(op);
+  if (!entry) {
+    if (num_ops == kMaxOps) {
+      printf("Kernel select: too many ops, not registering %s for %s\n",
+             candidate->name, op);
+      return;
+    }
+    entry = &ops[num_ops++];
+    entry->op = op;
+    entry->num_candidates = 0;
+  }
+  if (entry->num_candidates == kKernelSelectMaxCandidates) {
+    printf("Kernel select: too many candidates, not registering %s for %s\n",
+           candidate->name, op);
+    return;
+  }
+  entry->candidates[entry->num_candidates++] = candidate;
+}
+
+bool kernel_select_choose(TfLiteContext* context, const TfLiteNode* node,
+                          const char* op, const void* description,
+                          KernelChoice* choice) {
+  memset(choice, 0, sizeof(*choice));
+  choice->op = -1;
+  choice->node = node_index(context, node);
+  OpCandidates* entry = FindOp(op);
+  if (!entry) return false;
+
+  int best = -1;
+  for (int i = 0; i < entry->num_candidates; i++) {
+    const KernelCandidate* candidate = entry->candidates[i];
+    if (candidate->can_run && !candidate->can_run(description)) continue;
+    choice->eligible |= 1 << i;
+    if (!candidate->cost) {
+      if (best < 0) best = i;
+      continue;
+    }
+    uint32_t estimate = candidate->cost(description);
+    if (best < 0 || !entry->candidates[best]->cost ||
+        estimate < choice->estimate) {
+      best = i;
+      choice->estimate = estimate;
+    }
+  }
+  if (best < 0) return false;
+  choice->op = entry - ops;
+  choice->candidate = best;
+  Record(choice);
+  return true;
+}
+
+TfLiteStatus kernel_select_run(TfLiteContext* context, TfLiteNode* node,
+                               KernelChoice* choice) {
+  const OpCandidates& op = ops[choice->op];
+  if (autotune && !choice->tuned) {
+    return Autotune(op, context, node, choice);
+  }
+  return TimedRun(op.candidates[choice->candidate], context, node, choice);
+}
+
+void kernel_select_set_autotune(bool enable) { autotune = enable; }
+
+bool kernel_select_autotune() { return autotune; }
+
+void kernel_select_reset() { num_choices = 0; }
+
+int kernel_select_count() { return num_choices; }
+
+void kernel_select_rewind(int count) {
+  if (count < num_choices) num_choices = count;
+}
+
+void kernel_select_print_report() {
+  if (num_choices == 0) return;
+  printf("Kernel choices (autotune %s):\n", autotune ? "on" : "off");
+  printf("%5s %-16s %-16s %10s %10s  %s\n", "Node", "Op", "Kernel",
+         "Estimate", "Cycles", "Eligible");
+  for (int i = 0; i < num_choices; i++) {
+    const KernelChoice* choice = choices[i];
+    const OpCandidates& op = ops[choice->op];
+    printf("%5d %-16s %-16s %10lu %10lu ", choice->node, op.op,
+           op.candidates[choice->candidate]->name, choice->estimate,
+           choice->cycles);
+    for (int j = 0; j < op.num_candidates; j++) {
+      if (choice->eligible & (1 << j)) {
+        printf(" %s", op.candidates[j]->name);
+      }
+    }
+    printf("%s\n", choice->tuned ? " (tuned)" : "");
+  }
+}
@@ -0,0 +1,109 @@
+/*
+ * Copyright 2021 The CFU-Playground Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Prepare-time choice between implementations of an op.
+//
+// A project registers candidate implementations of an op, each with a
+// predicate and, optionally, a cost estimate. A kernel taking part keeps a
+// KernelChoice in its node's user data, calls kernel_select_choose() from
+// its Prepare and, if a candidate was chosen, kernel_select_run() from its
+// Eval. The predicates are then not evaluated again at each Eval.
+//
+// The candidate chosen at Prepare is the eligible one with the lowest
+// estimate. Candidates without an estimate come after those with one, in
+// registration order. With autotuning on, the first Eval of each node runs
+// every eligible candidate, timing each, and keeps the fastest. Candidates
+// must then produce the same output and leave their inputs unchanged.
+//
+// Projects register candidates from tflite_register_kernels() (see
+// proj_tflite.h). Build with KERNEL_SELECT_AUTOTUNE to autotune by default.
+
+#ifndef _KERNEL_SELECT_H
+#define _KERNEL_SELECT_H
+
+#include <cstdint>
+
+#include "tensorflow/lite/c/common.h"
+
+// Maximum number of candidates for one op
+constexpr int kKernelSelectMaxCandidates = 8;
+
+struct KernelCandidate {
+  // Name printed in the report
+  const char* name;
+
+  // Called at Prepare with the op-specific description of the node that
+  // the kernel passed to kernel_select_choose(). Returns true if this
+  // candidate can run the node. Null if it can run any node.
+  bool (*can_run)(const void* description);
+
+  // Called at Prepare, as for can_run. Returns the estimated cycles to run
+  // the node. Null if there is no estimate.
+  uint32_t (*cost)(const void* description);
+
+  // Called at Eval to run the node
+  TfLiteStatus (*run)(TfLiteContext* context, TfLiteNode* node);
+};
+
+// The choice made for one node, kept in the node's user data
+struct KernelChoice {
+  // Index of the op among those registered, or -1 if none was chosen
+  int8_t op;
+  // Index of the chosen candidate
+  int8_t candidate;
+  // Whether the choice was made by timing the candidates
+  bool tuned;
+  // Bit n set if candidate n can run the node
+  uint8_t eligible;
+  // Estimated cycles of the chosen candidate, 0 if not estimated
+  uint32_t estimate;
+  // Cycles taken by the last run
+  uint32_t cycles;
+  // Index of the node in its subgraph, as in the model
+  int16_t node;
+};
+
+// Registers a candidate implementation of the named op, such as "CONV_2D".
+// Candidates are numbered in registration order.
+void kernel_select_register(const char* op, const KernelCandidate* candidate);
+
+// Chooses the candidate to run a node, given its op-specific description.
+// Returns false, with choice->op set to -1, if no candidate can run it.
+bool kernel_select_choose(TfLiteContext* context, const TfLiteNode* node,
+                          const char* op, const void* description,
+                          KernelChoice* choice);
+
+// Runs the node with the chosen candidate, first autotuning if enabled and
+// the node has not been tuned.
+TfLiteStatus kernel_select_run(TfLiteContext* context, TfLiteNode* node,
+                               KernelChoice* choice);
+
+void kernel_select_set_autotune(bool autotune);
+bool kernel_select_autotune();
+
+// Forgets the choices made for the last model. Called when loading a model.
+void kernel_select_reset();
+
+// Returns the number of choices recorded
+int kernel_select_count();
+
+// Forgets all but the first count choices
+void kernel_select_rewind(int count);
+
+// Prints the choice made for each node, in Prepare order
+void kernel_select_print_report();
+
+#endif  // _KERNEL_SELECT_H
@@ -22,6 +22,7 @@
 
 #include "base.h"
 #include "benchmarks.h"
+#include "boot_timer.h"
 #include "fb_util.h"
 #include "functional_cfu_tests.h"
 #include "instruction_handler.h"
@@ -30,7 +31,9 @@
 #include "perf.h"
 #include "playground_util/util_tests.h"
 #include "proj_menu.h"
+#include "sim_trace.h"
 #include "spiflash.h"
+#include "stack_usage.h"
 #include "tflite_unit_tests.h"
 
 #ifdef PLATFORM_sim
@@ -66,6 +69,8 @@ static struct Menu MENU = {
 #endif
 #ifdef PLATFORM_sim
         MENU_ITEM('t', "trace (only works in simulation)", trace_sim),
+        MENU_ITEM('T', "op-scoped trace (only works in simulation)",
+                  sim_trace_menu),
         MENU_ITEM('Q', "Exit (only works in simulation)", exit_sim),
 #endif
         MENU_SENTINEL,
@@ -73,7 +78,10 @@ static struct Menu MENU = {
 };
 
 int main(void) {
+  boot_timer_mark("startup");
+  stack_usage_paint();
   init_runtime();
+  boot_timer_mark("init_runtime");
   printf("Hello, %s!\n", "World");
 
   menu_run(&MENU);
@@ -0,0 +1,188 @@
+/*
+ * Copyright 2021 The CFU-Playground Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "memory_timeline.h"
+
+#include <cstdio>
+#include <cstring>
+
+#include "tensorflow/lite/micro/memory_helpers.h"
+#include "tensorflow/lite/micro/micro_arena_constants.h"
+#include "tensorflow/lite/micro/micro_error_reporter.h"
+#include "tensorflow/lite/schema/schema_utils.h"
+
+namespace {
+
+// Tensors beyond this number are not reported
+constexpr int kMaxTensors = 1024;
+
+// First and last op index at which each tensor is live, or -1 for tensors
+// that are not in the arena
+int16_t first_live[kMaxTensors];
+int16_t last_live[kMaxTensors];
+
+const char* OpName(const tflite::Model* model, const tflite::Operator* op) {
+  const tflite::OperatorCode* code =
+      model->operator_codes()->Get(op->opcode_index());
+  const tflite::BuiltinOperator builtin = tflite::GetBuiltinCode(code);
+  if (builtin == tflite::BuiltinOperator_CUSTOM && code->custom_code()) {
+    return code->custom_code()->c_str();
+  }
+  return tflite::EnumNameBuiltinOperator(builtin);
+}
+
+// Returns the offline planned offsets, as used by the TFLM allocator, or
+// nullptr if the model has none.
+const int32_t* OfflineOffsets(const tflite::Model* model, size_t num_tensors) {
+  static const char kName[] = "OfflineMemoryAllocation";
+  if (!model->metadata()) return nullptr;
+  for (size_t i = 0; i < model->metadata()->size(); i++) {
+    auto* metadata = model->metadata()->Get(i);
+    if (strncmp(metadata->name()->c_str(), kName, strlen(kName)) != 0) {
+      continue;
+    }
+    auto* data = model->buffers()->Get(metadata->buffer())->data();
+    const uint32_t* words = reinterpret_cast<const uint32_t*>(data->data());
+    if (words[2] != num_tensors) return nullptr;
+    return reinterpret_cast<const int32_t*>(&words[3]);
+  }
+  return nullptr;
+}
+
+// As AllocationInfoBuilder::AddTensors()
+void CalculateLifetimes(const tflite::Model* model,
+                        const tflite::SubGraph* subgraph, int num_tensors) {
+  const int num_ops = subgraph->operators()->size();
+  for (int i = 0; i < num_tensors; i++) {
+    first_live[i] = -1;
+    last_live[i] = -1;
+  }
+  for (size_t i = 0; subgraph->inputs() && i < subgraph->inputs()->size();
+       i++) {
+    first_live[subgraph->inputs()->Get(i)] = 0;
+  }
+  for (size_t i = 0; subgraph->outputs() && i < subgraph->outputs()->size();
+       i++) {
+    last_live[subgraph->outputs()->Get(i)] = num_ops - 1;
+  }
+  for (int i = num_ops - 1; i >= 0; i--) {
+    const tflite::Operator* op = subgraph->operators()->Get(i);
+    for (size_t n = 0; op->inputs() && n < op->inputs()->size(); n++) {
+      const int t = op->inputs()->Get(n);
+      if (t >= 0 && last_live[t] < i) last_live[t] = i;
+    }
+    for (size_t n = 0; op->outputs() && n < op->outputs()->size(); n++) {
+      const int t = op->outputs()->Get(n);
+      if (t < 0) continue;
+      if (first_live[t] == -1 || first_live[t] > i) first_live[t] = i;
+      if (last_live[t] < i) last_live[t] = i;
+    }
+  }
+
+  // Constant and variable tensors are not planned
+  for (int i = 0; i < num_tensors; i++) {
+    const tflite::Tensor* tensor = subgraph->tensors()->Get(i);
+    const tflite::Buffer* buffer = model->buffers()->Get(tensor->buffer());
+    if (tensor->is_variable() || (buffer->data() && buffer->data()->size())) {
+      first_live[i] = -1;
+    }
+  }
+}
+
+size_t TensorBytes(const tflite::Tensor* tensor) {
+  size_t bytes = 0;
+  size_t type_size;
+  tflite::BytesRequiredForTensor(*tensor, &bytes, &type_size,
+                                 tflite::GetMicroErrorReporter());
+  return tflite::AlignSizeUp(bytes, tflite::MicroArenaBufferAlignment());
+}
+
+bool IsLive(int tensor, int op) {
+  return first_live[tensor] >= 0 && first_live[tensor] <= op &&
+         op <= last_live[tensor];
+}
+
+// Returns true if an earlier tensor live at op shares tensor's offset
+bool IsShared(const int32_t* offsets, int tensor, int op) {
+  if (!offsets || offsets[tensor] < 0) return false;
+  for (int i = 0; i < tensor; i++) {
+    if (IsLive(i, op) && offsets[i] == offsets[tensor]) return true;
+  }
+  return false;
+}
+
+size_t LiveBytes(const tflite::SubGraph* subgraph, const int32_t* offsets,
+                 int num_tensors, int op) {
+  size_t total = 0;
+  for (int i = 0; i < num_tensors; i++) {
+    if (IsLive(i, op) && !IsShared(offsets, i, op)) {
+      total += TensorBytes(subgraph->tensors()->Get(i));
+    }
+  }
+  return total;
+}
+
+void PrintTensor(const tflite::SubGraph* subgraph, const int32_t* offsets,
+                 int tensor, int op) {
+  const tflite::Tensor* t = subgraph->tensors()->Get(tensor);
+  printf("  %4d %-8s", tensor, tflite::EnumNameTensorType(t->type()));
+  if (t->shape()) {
+    for (size_t d = 0; d < t->shape()->size(); d++) {
+      printf("%s%ld", d ? "x" : "", static_cast<long>(t->shape()->Get(d)));
+    }
+  }
+  printf(" %u bytes", TensorBytes(t));
+  if (IsShared(offsets, tensor, op)) printf(" (shared)");
+  printf(" %s\n", t->name() ? t->name()->c_str() : "");
+}
+
+}  // anonymous namespace
+
+void memory_timeline_print(const tflite::Model* model) {
+  const tflite::SubGraph* subgraph = model->subgraphs()->Get(0);
+  const int num_tensors = subgraph->tensors()->size();
+  const int num_ops = subgraph->operators()->size();
+  if (num_tensors > kMaxTensors) {
+    printf("Memory timeline: %d tensors, only %d supported\n", num_tensors,
+           kMaxTensors);
+    return;
+  }
+  CalculateLifetimes(model, subgraph, num_tensors);
+  const int32_t* offsets = OfflineOffsets(model, num_tensors);
+
+  int peak_op = 0;
+  size_t peak_bytes = 0;
+  for (int op = 0; op < num_ops; op++) {
+    const size_t bytes = LiveBytes(subgraph, offsets, num_tensors, op);
+    if (bytes > peak_bytes) {
+      peak_bytes = bytes;
+      peak_op = op;
+    }
+  }
+
+  printf("Memory timeline (live tensors while each op runs):\n");
+  for (int op = 0; op < num_ops; op++) {
+    const size_t bytes = LiveBytes(subgraph, offsets, num_tensors, op);
+    printf("Op %d %s: %u live bytes%s\n", op,
+           OpName(model, subgraph->operators()->Get(op)), bytes,
+           op == peak_op ? "  <== peak" : "");
+    for (int i = 0; i < num_tensors; i++) {
+      if (IsLive(i, op)) PrintTensor(subgraph, offsets, i, op);
+    }
+  }
+  printf("Peak %u live bytes at op %d (%s)\n", peak_bytes, peak_op,
+         OpName(model, subgraph->operators()->Get(peak_op)));
+}
@@ -0,0 +1,40 @@
+/*
+ * Copyright 2021 The CFU-Playground Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Per-op memory timeline.
+//
+// Prints, for each op in subgraph 0, the tensors that are live in the arena
+// while it runs, using the same lifetimes as the TFLM memory planner. The op
+// with the most live bytes is marked as the peak. Reducing peak memory means
+// shortening or shrinking the tensors live at that op - for example by fusing
+// the op that produces one of them, or by tiling.
+//
+// Tensors that the offline memory plan places at the same offset, such as
+// the input and output of an in-place op, are counted once. Scratch buffers
+// requested by kernels are not included.
+//
+// tflite.cc prints the timeline after AllocateTensors() when
+// TF_LITE_SHOW_MEMORY_USE is defined.
+
+#ifndef _MEMORY_TIMELINE_H
+#define _MEMORY_TIMELINE_H
+
+#include "tensorflow/lite/schema/schema_generated.h"
+
+// Prints the live tensors for each op of the model
+void memory_timeline_print(const tflite::Model* model);
+
+#endif  // _MEMORY_TIMELINE_H
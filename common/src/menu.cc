@@ -20,6 +20,7 @@
 #include <stdio.h>
 #include <string.h>
 
+#include "boot_timer.h"
 #include "playground_util/console.h"
 
 namespace {
@@ -40,7 +41,10 @@ void menu_print(struct Menu* menu) {
 
 // Get the menu selection
 struct MenuItem* menu_get_selection(struct Menu* menu) {
+  // Time waiting for the user is not part of boot or load times
+  boot_timer_pause();
   char c = readchar();
+  boot_timer_resume();
   putchar(c);
   for (struct MenuItem* p = menu->items; p->selection; p++) {
     if (c == p->selection) {
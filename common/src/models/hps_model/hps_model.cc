@@ -26,6 +26,22 @@
 #include "models/hps_model/second_0_320_240_1_20220117_135512_201k_26k_96ops.h"
 #include "tflite.h"
 
+#ifdef HPS_ADAPTIVE_RESOLUTION
+#include "perf.h"
+
+// A 160x120 variant of the 01_05_74ops model, made by
+// scripts/tflite_downscale.py
+#include "models/hps_model/hps_lowres_model.h"
+
+// Low resolution scores in this range are escalated to full resolution
+#ifndef HPS_ADAPTIVE_UNCERTAIN_MIN
+#define HPS_ADAPTIVE_UNCERTAIN_MIN -96
+#endif
+#ifndef HPS_ADAPTIVE_UNCERTAIN_MAX
+#define HPS_ADAPTIVE_UNCERTAIN_MAX 95
+#endif
+#endif
+
 namespace {
 
 int loaded_model = 0;
@@ -98,6 +114,90 @@ int32_t classify_zeros() {
 
 void do_classify_zeros() { printf("Result is %ld\n", classify_zeros()); }
 
+#ifdef HPS_ADAPTIVE_RESOLUTION
+constexpr int kLowResSlot = 0;
+constexpr int kFullResSlot = 1;
+
+// Loads both variants so that each frame can use either without reloading.
+// The low resolution model gets just the arena it uses, and the full
+// resolution model the rest. Returns false if they do not fit together.
+bool adaptive_load() {
+  if (tflite_select_resident_model(kFullResSlot)) {
+    return true;
+  }
+  puts("Loading low resolution and 01_05_74ops models");
+  if (!tflite_load_resident_model(kLowResSlot, hps_lowres_model,
+                                  hps_lowres_model_len,
+                                  TFLITE_RESIDENT_ARENA_FIT) ||
+      !tflite_load_resident_model(kFullResSlot, hps_model_2022_01_05_74ops,
+                                  hps_model_2022_01_05_74ops_len, 0)) {
+    puts("FAIL Low and full resolution models do not fit in the arena "
+         "together");
+    // Leave the menu with a usable model
+    do_init_01_05_74ops();
+    return false;
+  }
+  // Golden test expectations are for the full resolution model
+  loaded_model = 1;
+  return true;
+}
+
+// Classifies a 320x240 frame at 160x120, escalating to 320x240 when the
+// score is uncertain. Adds the cycles taken to *cycles.
+int32_t classify_adaptive(const unsigned char* frame, bool* escalated,
+                          uint64_t* cycles) {
+  tflite_select_resident_model(kLowResSlot);
+  tflite_set_input_unsigned_downscaled(frame, 2);
+  tflite_classify();
+  *cycles += tflite_get_classify_cycles();
+  int32_t score = tflite_get_output()[0];
+  *escalated = score >= HPS_ADAPTIVE_UNCERTAIN_MIN &&
+               score <= HPS_ADAPTIVE_UNCERTAIN_MAX;
+  if (*escalated) {
+    tflite_select_resident_model(kFullResSlot);
+    tflite_set_input_unsigned(frame);
+    tflite_classify();
+    *cycles += tflite_get_classify_cycles();
+    score = tflite_get_output()[0];
+  }
+  return score;
+}
+
+// Runs each test frame through the adaptive path and reports the average
+// cycles per frame, compared with always using full resolution.
+void do_adaptive_benchmark() {
+  if (!adaptive_load()) {
+    return;
+  }
+  const unsigned char* frames[] = {cat_picture, diagram};
+  const char* names[] = {"cat", "diagram"};
+  const int num_frames = sizeof(frames) / sizeof(frames[0]);
+  uint64_t adaptive_cycles = 0;
+  uint64_t full_cycles = 0;
+  int num_escalated = 0;
+  for (int i = 0; i < num_frames; i++) {
+    bool escalated;
+    uint64_t cycles = 0;
+    int32_t score = classify_adaptive(frames[i], &escalated, &cycles);
+    adaptive_cycles += cycles;
+    num_escalated += escalated;
+
+    tflite_select_resident_model(kFullResSlot);
+    tflite_set_input_unsigned(frames[i]);
+    tflite_classify();
+    full_cycles += tflite_get_classify_cycles();
+    printf("%-8s adaptive %4ld (%s), full resolution %4d\n", names[i], score,
+           escalated ? "escalated" : "low res", tflite_get_output()[0]);
+  }
+  printf("Escalated %d of %d frames\n", num_escalated, num_frames);
+  printf("Average cycles per frame: adaptive ");
+  perf_print_value(adaptive_cycles / num_frames);
+  printf(", full resolution ");
+  perf_print_value(full_cycles / num_frames);
+  printf("\n");
+}
+#endif
+
 // Golden tests: expected results
 struct GoldenTest {
   int32_t (*fn)();
@@ -152,6 +252,9 @@ struct Menu MENU = {
                   do_init_presence_2022017_96ops),
         MENU_ITEM('4', "Reinitialize with second_2022017_96ops model",
                   do_init_second_2022017_96ops),
+#ifdef HPS_ADAPTIVE_RESOLUTION
+        MENU_ITEM('a', "Adaptive resolution benchmark", do_adaptive_benchmark),
+#endif
         MENU_END,
     },
 };
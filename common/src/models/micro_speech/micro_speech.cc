@@ -17,13 +17,24 @@
 #include "models/micro_speech/micro_speech.h"
 
 #include <stdio.h>
+#include <string.h>
 
+#include "audio_frontend.h"
+#include "generated/soc.h"
 #include "menu.h"
 #include "models/micro_speech/model_micro_speech.h"
+#include "models/micro_speech/test_data/no_1000ms.h"
+#include "models/micro_speech/test_data/yes_1000ms.h"
+#include "perf.h"
 #include "tensorflow/lite/micro/examples/micro_speech/micro_features/no_micro_features_data.h"
 #include "tensorflow/lite/micro/examples/micro_speech/micro_features/yes_micro_features_data.h"
 #include "tflite.h"
 
+#ifdef AUDIO_FRONTEND_CFU_BUTTERFLY
+#include "cfu.h"
+#include "playground_util/random.h"
+#endif
+
 // The micro_speech model classifies speech based on the greatest of 4 scores.
 typedef struct {
   uint8_t silence_score;
@@ -76,6 +87,133 @@ static void do_classify_yes() {
          res.silence_score, res.unknown_score, res.yes_score, res.no_score);
 }
 
+// Input is one feature slice per hop of a one second clip.
+#define NUM_FEATURE_SLICES 49
+#define NUM_FEATURES (NUM_FEATURE_SLICES * AUDIO_FRONTEND_NUM_CHANNELS)
+
+static int8_t features[NUM_FEATURES];
+
+// Feeds 16 bit PCM to the audio frontend one hop at a time, as it would
+// arrive from a microphone. Returns the number of slices generated.
+static int generate_features(const unsigned char* pcm, unsigned int pcm_len) {
+  static bool initialized = false;
+  if (!initialized) {
+    audio_frontend_init();
+    initialized = true;
+  }
+  audio_frontend_reset();
+
+  int16_t samples[AUDIO_FRONTEND_HOP_SAMPLES];
+  int slices = 0;
+  for (unsigned int pos = 0;
+       pos < pcm_len && slices < NUM_FEATURE_SLICES;) {
+    unsigned int len = pcm_len - pos;
+    if (len > sizeof(samples)) len = sizeof(samples);
+    memcpy(samples, pcm + pos, len);
+    pos += len;
+    slices += audio_frontend_generate(
+        samples, len / sizeof(samples[0]),
+        features + slices * AUDIO_FRONTEND_NUM_CHANNELS,
+        NUM_FEATURE_SLICES - slices);
+  }
+  return slices;
+}
+
+static void do_classify_yes_audio() {
+  puts("Classify \"yes\" audio");
+  generate_features(yes_1000ms, yes_1000ms_len);
+  tflite_set_input(features);
+  MicroSpeechResult res = micro_speech_classify();
+  printf("  results-- silence: %d, unkown: %d, yes: %d, no: %d\n",
+         res.silence_score, res.unknown_score, res.yes_score, res.no_score);
+}
+
+// The frontend should produce exactly the features that were generated for
+// the clips by TFLM's microfrontend.
+static void do_frontend_golden_tests() {
+  struct {
+    const char* name;
+    const unsigned char* pcm;
+    unsigned int pcm_len;
+    const signed char* expected;
+  } cases[] = {
+      {"yes", yes_1000ms, yes_1000ms_len, g_yes_micro_f2e59fea_nohash_1_data},
+      {"no", no_1000ms, no_1000ms_len, g_no_micro_f9643d42_nohash_4_data},
+  };
+
+  bool failed = false;
+  for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+    int slices = generate_features(cases[i].pcm, cases[i].pcm_len);
+    int mismatches = 0;
+    for (int j = 0; j < NUM_FEATURES; j++) {
+      if (features[j] != cases[i].expected[j]) {
+        if (mismatches++ == 0) {
+          printf("*** \"%s\": feature %d is %d, expected %d\n", cases[i].name,
+                 j, features[j], cases[i].expected[j]);
+        }
+      }
+    }
+    if (slices != NUM_FEATURE_SLICES || mismatches) {
+      failed = true;
+      printf("*** Frontend test \"%s\" failed: %d slices, %d mismatches\n",
+             cases[i].name, slices, mismatches);
+    }
+  }
+
+  if (failed) {
+    puts("FAIL Audio frontend tests failed");
+  } else {
+    puts("OK   Audio frontend tests passed");
+  }
+}
+
+#ifdef AUDIO_FRONTEND_CFU_BUTTERFLY
+// Compares the CFU butterfly op against its software model.
+static bool check_cfu_butterfly() {
+  int64_t r = 1;
+  for (int i = 0; i < 1000; i++) {
+    int funct7 = i & (AUDIO_FRONTEND_BFLY_DIV4 | AUDIO_FRONTEND_BFLY_NO_MUL);
+    uint32_t rs1 = next_pseudo_random(&r);
+    uint32_t rs2 = next_pseudo_random(&r);
+    uint32_t hw = cfu_op(AUDIO_FRONTEND_CFU_FUNCT3, funct7, rs1, rs2);
+    uint32_t sw = audio_frontend_butterfly_sw(funct7, rs1, rs2);
+    if (hw != sw) {
+      printf("*** Butterfly(%d, %08lx, %08lx) = %08lx, expected %08lx\n",
+             funct7, rs1, rs2, hw, sw);
+      return false;
+    }
+  }
+  puts("CFU butterfly matches software model");
+  return true;
+}
+#endif
+
+static void do_frontend_benchmark() {
+#ifdef AUDIO_FRONTEND_CFU_BUTTERFLY
+  if (!check_cfu_butterfly()) return;
+#endif
+  uint64_t start = perf_get_mcycle64();
+  generate_features(yes_1000ms, yes_1000ms_len);
+  uint64_t total = perf_get_mcycle64() - start;
+
+  const AudioFrontendCycles* cycles = audio_frontend_get_cycles();
+  int hops = cycles->slices;
+  printf("Audio frontend, %d hops of %d samples\n", hops,
+         AUDIO_FRONTEND_HOP_SAMPLES);
+  printf("Cycles per hop:\n");
+  printf("  window:     %8lu\n", static_cast<uint32_t>(cycles->window / hops));
+  printf("  fft:        %8lu\n", static_cast<uint32_t>(cycles->fft / hops));
+  printf("  filterbank: %8lu\n",
+         static_cast<uint32_t>(cycles->filterbank / hops));
+  printf("  gain, log:  %8lu\n",
+         static_cast<uint32_t>(cycles->gain_log / hops));
+  printf("  total:      %8lu\n", static_cast<uint32_t>(total / hops));
+  printf("Real time budget per hop: %lu cycles\n",
+         static_cast<uint32_t>(static_cast<uint64_t>(CONFIG_CLOCK_FREQUENCY) *
+                               AUDIO_FRONTEND_HOP_SAMPLES /
+                               AUDIO_FRONTEND_SAMPLE_RATE));
+}
+
 #define NUM_GOLDEN 3
 
 static void do_golden_tests() {
@@ -123,8 +261,13 @@ static struct Menu MENU = {
         MENU_ITEM('1', "Run with zeros input", do_classify_zeros),
         MENU_ITEM('2', "Run with \"no\" input", do_classify_no),
         MENU_ITEM('3', "Run with \"yes\" input", do_classify_yes),
+        MENU_ITEM('4', "Run with \"yes\" audio, through audio frontend",
+                  do_classify_yes_audio),
         MENU_ITEM('g', "Run golden tests (check for expected outputs)",
                   do_golden_tests),
+        MENU_ITEM('f', "Run audio frontend golden tests",
+                  do_frontend_golden_tests),
+        MENU_ITEM('b', "Benchmark audio frontend", do_frontend_benchmark),
         MENU_END,
     },
 };
@@ -17,14 +17,17 @@
 #include "models/mlcommons_tiny_v01/anomd/anomd.h"
 
 #include <stdio.h>
+#include <string.h>
 
 #include "menu.h"
+#include "models/mlcommons_tiny_v01/anomd/anomd_blocked.h"
 #include "models/mlcommons_tiny_v01/anomd/test_data/quant_anomaly_0.h"
 #include "models/mlcommons_tiny_v01/anomd/test_data/quant_anomaly_1.h"
 #include "models/mlcommons_tiny_v01/anomd/test_data/quant_anomaly_2.h"
 #include "models/mlcommons_tiny_v01/anomd/test_data/quant_normal_0.h"
 #include "models/mlcommons_tiny_v01/anomd/test_data/quant_normal_1.h"
 #include "models/mlcommons_tiny_v01/anomd/test_data/quant_normal_2.h"
+#include "perf.h"
 #include "tflite.h"
 #include "tiny/v0.1/training/anomaly_detection/trained_models/ad01_int8.h"
 
@@ -98,6 +101,92 @@ static void do_golden_tests() {
   }
 }
 
+// Feature vectors in one clip: a 10s clip gives 313 frames of 128 mel bins,
+// and each vector is 5 consecutive frames.
+#define ANOMD_CLIP_VECTORS 309
+
+#define ANOMD_VECTOR_SIZE 640
+
+static int8_t block_inputs[ANOMD_BLOCKED_MAX_N * ANOMD_VECTOR_SIZE];
+static int8_t block_outputs[ANOMD_BLOCKED_MAX_N * ANOMD_VECTOR_SIZE];
+
+static bool blocked_init() {
+  if (!anomd_blocked_init(ad01_int8) ||
+      anomd_blocked_input_size() != ANOMD_VECTOR_SIZE ||
+      anomd_blocked_output_size() != ANOMD_VECTOR_SIZE) {
+    puts("Model not supported by blocked FC");
+    return false;
+  }
+  return true;
+}
+
+// Runs vectors [first, first + n) of the clip, cycling through the test
+// data, and returns the cycles taken by the model.
+static uint64_t run_block(int first, int n) {
+  for (int i = 0; i < n; i++) {
+    memcpy(block_inputs + i * ANOMD_VECTOR_SIZE,
+           mlcommons_tiny_v01_ad_dataset[(first + i) % NUM_GOLDEN].data,
+           ANOMD_VECTOR_SIZE);
+  }
+  uint64_t start = perf_get_mcycle64();
+  anomd_blocked_run(block_inputs, n, block_outputs);
+  return perf_get_mcycle64() - start;
+}
+
+static void do_blocked_golden_tests() {
+  if (!blocked_init()) return;
+  static const int block_sizes[] = {1, 3, NUM_GOLDEN};
+  bool failed = false;
+  for (int n : block_sizes) {
+    for (int first = 0; first < NUM_GOLDEN; first += n) {
+      run_block(first, n);
+      for (int i = 0; i < n; i++) {
+        uint32_t res = uint32_xor_reduction(
+            block_outputs + i * ANOMD_VECTOR_SIZE, ANOMD_VECTOR_SIZE);
+        uint32_t exp = mlcommons_tiny_v01_ad_dataset[first + i].actual;
+        if (res != exp) {
+          failed = true;
+          printf("*** Blocked test %d failed with N=%d: \n", first + i, n);
+          printf("actual: 32 bit xor: 0x%lx\n", res);
+          printf("expected: 32 bit xor: 0x%lx\n", exp);
+        }
+      }
+    }
+  }
+
+  if (failed) {
+    puts("FAIL Blocked golden tests failed");
+  } else {
+    puts("OK   Blocked golden tests passed");
+  }
+}
+
+// Reports the time to process one clip as the block size grows. With N=1
+// every vector streams all the weights, as the interpreter does.
+static void do_blocked_benchmark() {
+  if (!blocked_init()) return;
+
+  tflite_set_input(mlcommons_tiny_v01_ad_dataset[0].data);
+  tflite_classify();
+  uint64_t interpreter_cycles =
+      tflite_get_classify_cycles() * ANOMD_CLIP_VECTORS;
+
+  printf("Cycles per clip of %d vectors\n", ANOMD_CLIP_VECTORS);
+  printf("  interpreter ");
+  perf_print_value(interpreter_cycles);
+  printf(" (estimated from one vector)\n");
+  for (int n = 1; n <= ANOMD_BLOCKED_MAX_N; n *= 2) {
+    uint64_t cycles = 0;
+    for (int first = 0; first < ANOMD_CLIP_VECTORS; first += n) {
+      int len = ANOMD_CLIP_VECTORS - first < n ? ANOMD_CLIP_VECTORS - first : n;
+      cycles += run_block(first, len);
+    }
+    printf("  N=%-2d        ", n);
+    perf_print_value(cycles);
+    printf("\n");
+  }
+}
+
 static struct Menu MENU = {
     "Tests for anomd model",
     "anomd",
@@ -108,6 +197,10 @@ static struct Menu MENU = {
         MENU_ITEM('3', "Run with normal 1", do_classify_normal_1),
         MENU_ITEM('g', "Run golden tests (check for expected outputs)",
                   do_golden_tests),
+        MENU_ITEM('b', "Run golden tests with blocked FC",
+                  do_blocked_golden_tests),
+        MENU_ITEM('n', "Time per clip against blocked FC block size",
+                  do_blocked_benchmark),
         MENU_END,
     },
 };
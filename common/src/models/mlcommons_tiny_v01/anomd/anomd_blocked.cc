@@ -0,0 +1,278 @@
+/*
+ * Copyright 2021 The CFU-Playground Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "models/mlcommons_tiny_v01/anomd/anomd_blocked.h"
+
+#include <math.h>
+
+#include "tensorflow/lite/kernels/internal/common.h"
+#include "tensorflow/lite/kernels/internal/quantization_util.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+#include "tensorflow/lite/schema/schema_utils.h"
+
+namespace {
+
+constexpr int kMaxLayers = 16;
+constexpr int kMaxWidth = 640;
+constexpr int kMaxRows = 2048;
+
+struct Layer {
+  const int8_t* weights;  // output_depth rows of input_depth
+  const int32_t* bias;    // Includes the input offset times the row sum
+  int input_depth;
+  int output_depth;
+  int32_t output_multiplier;
+  int output_shift;
+  int32_t output_offset;
+  int32_t activation_min;
+  int32_t activation_max;
+};
+
+Layer layers[kMaxLayers];
+int num_layers;
+int32_t bias_storage[kMaxRows];
+
+// Intermediate results, alternating between layers.
+int8_t activations[2][ANOMD_BLOCKED_MAX_N * kMaxWidth];
+
+bool get_quantization(const tflite::Tensor* tensor, float* scale,
+                      int32_t* zero_point) {
+  const tflite::QuantizationParameters* q = tensor->quantization();
+  if (!q || !q->scale() || !q->zero_point() || q->scale()->size() != 1 ||
+      q->zero_point()->size() != 1) {
+    return false;
+  }
+  *scale = q->scale()->Get(0);
+  *zero_point = q->zero_point()->Get(0);
+  return true;
+}
+
+const uint8_t* get_data(const tflite::Model* model,
+                        const tflite::Tensor* tensor) {
+  const tflite::Buffer* buffer = model->buffers()->Get(tensor->buffer());
+  return buffer && buffer->data() ? buffer->data()->data() : nullptr;
+}
+
+// Matches CalculateActivationRangeQuantized() for int8 outputs.
+bool get_activation_range(tflite::ActivationFunctionType activation,
+                          float scale, int32_t zero_point, int32_t* min,
+                          int32_t* max) {
+  *min = -128;
+  *max = 127;
+  switch (activation) {
+    case tflite::ActivationFunctionType_NONE:
+      return true;
+    case tflite::ActivationFunctionType_RELU6:
+      *max = std::min(*max, zero_point + static_cast<int32_t>(
+                                             roundf(6.0f / scale)));
+      // fall through
+    case tflite::ActivationFunctionType_RELU:
+      *min = std::max(*min, zero_point);
+      return true;
+    default:
+      return false;
+  }
+}
+
+bool init_layer(const tflite::Model* model, const tflite::Operator* op,
+                Layer* layer, int* bias_used) {
+  const auto* tensors = model->subgraphs()->Get(0)->tensors();
+  const auto* inputs = op->inputs();
+  if (inputs->size() < 2 || op->outputs()->size() != 1) return false;
+  const tflite::Tensor* input = tensors->Get(inputs->Get(0));
+  const tflite::Tensor* filter = tensors->Get(inputs->Get(1));
+  const tflite::Tensor* bias = inputs->size() > 2 && inputs->Get(2) >= 0
+                                   ? tensors->Get(inputs->Get(2))
+                                   : nullptr;
+  const tflite::Tensor* output = tensors->Get(op->outputs()->Get(0));
+  if (input->type() != tflite::TensorType_INT8 ||
+      filter->type() != tflite::TensorType_INT8 ||
+      output->type() != tflite::TensorType_INT8 ||
+      (bias && bias->type() != tflite::TensorType_INT32)) {
+    return false;
+  }
+
+  const auto* options = op->builtin_options_as_FullyConnectedOptions();
+  if (options &&
+      options->weights_format() !=
+          tflite::FullyConnectedOptionsWeightsFormat_DEFAULT) {
+    return false;
+  }
+
+  float input_scale, filter_scale, output_scale;
+  int32_t input_zero_point, filter_zero_point, output_zero_point;
+  if (!get_quantization(input, &input_scale, &input_zero_point) ||
+      !get_quantization(filter, &filter_scale, &filter_zero_point) ||
+      !get_quantization(output, &output_scale, &output_zero_point) ||
+      filter_zero_point != 0) {
+    return false;
+  }
+
+  const auto* shape = filter->shape();
+  if (shape->size() != 2) return false;
+  layer->output_depth = shape->Get(0);
+  layer->input_depth = shape->Get(1);
+  if (layer->input_depth > kMaxWidth || layer->output_depth > kMaxWidth ||
+      *bias_used + layer->output_depth > kMaxRows) {
+    return false;
+  }
+
+  layer->weights = reinterpret_cast<const int8_t*>(get_data(model, filter));
+  const int32_t* bias_data =
+      bias ? reinterpret_cast<const int32_t*>(get_data(model, bias)) : nullptr;
+  if (!layer->weights || (bias && !bias_data)) return false;
+
+  // Fold the input offset into the bias, so that the inner loop only
+  // multiplies raw values.
+  int32_t* folded = bias_storage + *bias_used;
+  *bias_used += layer->output_depth;
+  for (int o = 0; o < layer->output_depth; o++) {
+    const int8_t* row = layer->weights + o * layer->input_depth;
+    int32_t row_sum = 0;
+    for (int d = 0; d < layer->input_depth; d++) {
+      row_sum += row[d];
+    }
+    folded[o] = (bias_data ? bias_data[o] : 0) - input_zero_point * row_sum;
+  }
+  layer->bias = folded;
+
+  // As GetQuantizedConvolutionMultipler() does for the reference kernel.
+  const double real_multiplier = static_cast<double>(input_scale) *
+                                 static_cast<double>(filter_scale) /
+                                 static_cast<double>(output_scale);
+  tflite::QuantizeMultiplier(real_multiplier, &layer->output_multiplier,
+                             &layer->output_shift);
+  layer->output_offset = output_zero_point;
+  return get_activation_range(
+      options ? options->fused_activation_function()
+              : tflite::ActivationFunctionType_NONE,
+      output_scale, output_zero_point, &layer->activation_min,
+      &layer->activation_max);
+}
+
+inline int8_t requantize(const Layer& layer, int o, int32_t acc) {
+  acc += layer.bias[o];
+  acc = tflite::MultiplyByQuantizedMultiplier(acc, layer.output_multiplier,
+                                              layer.output_shift);
+  acc += layer.output_offset;
+  acc = std::max(acc, layer.activation_min);
+  acc = std::min(acc, layer.activation_max);
+  return static_cast<int8_t>(acc);
+}
+
+inline int32_t dot(const int8_t* a, const int8_t* b, int depth) {
+  int32_t acc = 0;
+  for (int d = 0; d < depth; d++) {
+    acc += a[d] * b[d];
+  }
+  return acc;
+}
+
+// Multiplies n input vectors by the layer's weights. Works on two weight rows
+// and two input vectors at a time, so that each loaded value is used twice.
+void fully_connected(const Layer& layer, const int8_t* input, int n,
+                     int8_t* output) {
+  const int depth = layer.input_depth;
+  const int rows = layer.output_depth;
+  int o = 0;
+  for (; o + 1 < rows; o += 2) {
+    const int8_t* w0 = layer.weights + o * depth;
+    const int8_t* w1 = w0 + depth;
+    int b = 0;
+    for (; b + 1 < n; b += 2) {
+      const int8_t* x0 = input + b * depth;
+      const int8_t* x1 = x0 + depth;
+      int32_t acc00 = 0, acc01 = 0, acc10 = 0, acc11 = 0;
+      for (int d = 0; d < depth; d++) {
+        const int32_t w0d = w0[d];
+        const int32_t w1d = w1[d];
+        const int32_t x0d = x0[d];
+        const int32_t x1d = x1[d];
+        acc00 += w0d * x0d;
+        acc01 += w0d * x1d;
+        acc10 += w1d * x0d;
+        acc11 += w1d * x1d;
+      }
+      int8_t* out0 = output + b * rows + o;
+      int8_t* out1 = out0 + rows;
+      out0[0] = requantize(layer, o, acc00);
+      out0[1] = requantize(layer, o + 1, acc10);
+      out1[0] = requantize(layer, o, acc01);
+      out1[1] = requantize(layer, o + 1, acc11);
+    }
+    if (b < n) {
+      const int8_t* x = input + b * depth;
+      output[b * rows + o] = requantize(layer, o, dot(w0, x, depth));
+      output[b * rows + o + 1] = requantize(layer, o + 1, dot(w1, x, depth));
+    }
+  }
+  if (o < rows) {
+    const int8_t* w = layer.weights + o * depth;
+    for (int b = 0; b < n; b++) {
+      output[b * rows + o] =
+          requantize(layer, o, dot(w, input + b * depth, depth));
+    }
+  }
+}
+
+}  // anonymous namespace
+
+bool anomd_blocked_init(const unsigned char* model_data) {
+  num_layers = 0;
+  const tflite::Model* model = tflite::GetModel(model_data);
+  if (!model->subgraphs() || model->subgraphs()->size() != 1) return false;
+  const tflite::SubGraph* subgraph = model->subgraphs()->Get(0);
+  const auto* ops = subgraph->operators();
+  if (ops->size() > kMaxLayers || subgraph->inputs()->size() != 1 ||
+      subgraph->outputs()->size() != 1) {
+    return false;
+  }
+
+  int bias_used = 0;
+  int32_t previous_output = subgraph->inputs()->Get(0);
+  for (size_t i = 0; i < ops->size(); i++) {
+    const tflite::Operator* op = ops->Get(i);
+    const tflite::OperatorCode* code =
+        model->operator_codes()->Get(op->opcode_index());
+    if (tflite::GetBuiltinCode(code) !=
+            tflite::BuiltinOperator_FULLY_CONNECTED ||
+        op->inputs()->Get(0) != previous_output ||
+        !init_layer(model, op, &layers[i], &bias_used)) {
+      return false;
+    }
+    previous_output = op->outputs()->Get(0);
+  }
+  if (previous_output != subgraph->outputs()->Get(0)) return false;
+  num_layers = ops->size();
+  return true;
+}
+
+void anomd_blocked_run(const int8_t* inputs, int n, int8_t* outputs) {
+  const int8_t* input = inputs;
+  for (int i = 0; i < num_layers; i++) {
+    int8_t* output = i == num_layers - 1 ? outputs : activations[i & 1];
+    fully_connected(layers[i], input, n, output);
+    input = output;
+  }
+}
+
+int anomd_blocked_input_size() {
+  return num_layers ? layers[0].input_depth : 0;
+}
+
+int anomd_blocked_output_size() {
+  return num_layers ? layers[num_layers - 1].output_depth : 0;
+}
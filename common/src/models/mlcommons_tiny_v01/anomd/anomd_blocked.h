@@ -0,0 +1,44 @@
+/*
+ * Copyright 2021 The CFU-Playground Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Blocked execution of the anomd autoencoder.
+//
+// The interpreter runs the model on one feature vector at a time, so every
+// FullyConnected layer streams all of its weights from memory once per
+// vector. This runs a block of vectors through each layer together, as a
+// matrix-matrix product: each pair of weight rows is loaded once per block
+// and multiplied against pairs of input vectors. Results are bit exact with
+// the reference FullyConnected kernel.
+
+#ifndef _MLCOMMONS_TINY_V01_ANOMD_BLOCKED_H
+#define _MLCOMMONS_TINY_V01_ANOMD_BLOCKED_H
+
+#include <stdint.h>
+
+#define ANOMD_BLOCKED_MAX_N 16
+
+// Reads layer parameters from the model. Returns false if the model is not a
+// chain of int8 FullyConnected layers.
+bool anomd_blocked_init(const unsigned char* model_data);
+
+// Runs n (at most ANOMD_BLOCKED_MAX_N) consecutive input vectors through the
+// model, writing n consecutive output vectors.
+void anomd_blocked_run(const int8_t* inputs, int n, int8_t* outputs);
+
+int anomd_blocked_input_size();
+int anomd_blocked_output_size();
+
+#endif  // _MLCOMMONS_TINY_V01_ANOMD_BLOCKED_H
@@ -77,8 +77,7 @@ static void do_classify_0() {
   fb_draw_string(0,  10, 0x007FFF00, "Run test 0");
   fb_draw_buffer(0,  50, 160, 160, (const uint8_t *)golden_tests[0].data, 3);
   fb_draw_string(0, 220, 0x007FFF00, (const char *)msg_buff);
-  flush_cpu_dcache();
-  flush_l2_cache();
+  fb_flush();
 #endif
 }
 
@@ -95,8 +94,7 @@ static void do_classify_1() {
   fb_draw_string(0,  10, 0x007FFF00, "Run test 1");
   fb_draw_buffer(0,  50, 160, 160, (const uint8_t *)golden_tests[1].data, 3);
   fb_draw_string(0, 220, 0x007FFF00, (const char *)msg_buff);
-  flush_cpu_dcache();
-  flush_l2_cache();
+  fb_flush();
 #endif
 }
 
@@ -113,11 +111,23 @@ static void do_classify_special() {
   fb_draw_string(0, 10, 0x007FFF00, "Run special test");
   fb_draw_buffer(0, 50, 160, 160, (const uint8_t *)input_00001_18027, 3);
   fb_draw_string(0, 220, 0x007FFF00, (const char *)msg_buff);
-  flush_cpu_dcache();
-  flush_l2_cache();
+  fb_flush();
 #endif
 }
 
+void mnv2_load_model() { mnv2_init(); }
+
+int mnv2_num_golden_tests() { return NUM_GOLDEN; }
+
+int32_t mnv2_classify_golden_test(int index) {
+  tflite_set_input_unsigned(golden_tests[index].data);
+  return mnv2_classify();
+}
+
+int32_t mnv2_golden_test_expected(int index) {
+  return golden_tests[index].expected;
+}
+
 static void do_golden_tests() {
   bool failed = false;
 
@@ -146,8 +156,7 @@ static void do_golden_tests() {
     memset(msg_buff, 0x00, sizeof(msg_buff));
     snprintf(msg_buff, sizeof(msg_buff), "Result is %d, Expected is %d", actual, expected);
     fb_draw_string(0, 220, 0x007FFF00, (const char *)msg_buff);
-    flush_cpu_dcache();
-    flush_l2_cache();
+    fb_flush();
 #endif  
   }
 
@@ -177,8 +186,7 @@ void mnv2_menu() {
 
 #ifdef CSR_VIDEO_FRAMEBUFFER_BASE
   fb_init();
-  flush_cpu_dcache();
-  flush_l2_cache();
+  fb_flush();
 #endif
 
   menu_run(&MENU);
@@ -17,6 +17,8 @@
 #ifndef _MNV2H
 #define _MNV2H
 
+#include <stdint.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -24,6 +26,14 @@ extern "C" {
 // Mobile Net v2 model processing menu
 void mnv2_menu();
 
+// For projects that run the golden tests themselves: load the model, then
+// classify golden test inputs, which returns the score that
+// mnv2_golden_test_expected() gives for the reference kernels.
+void mnv2_load_model();
+int mnv2_num_golden_tests();
+int32_t mnv2_classify_golden_test(int index);
+int32_t mnv2_golden_test_expected(int index);
+
 #ifdef __cplusplus
 }
 #endif
@@ -64,8 +64,7 @@ static void do_classify_no_person() {
   fb_draw_string(0,  10, 0x007FFF00, "Classify Not Person");
   fb_draw_buffer(0,  50, 96, 96, (const uint8_t *)g_no_person_data, 1);
   fb_draw_string(0, 220, 0x007FFF00, (const char *)msg_buff);
-  flush_cpu_dcache();
-  flush_l2_cache();
+  fb_flush();
 #endif  
 }
 
@@ -83,8 +82,7 @@ static void do_classify_person() {
   fb_draw_string(0,  10, 0x007FFF00, "Classify Person");
   fb_draw_buffer(0,  50, 96, 96, (const uint8_t *)g_person_data, 1);
   fb_draw_string(0, 220, 0x007FFF00, (const char *)msg_buff);
-  flush_cpu_dcache();
-  flush_l2_cache();
+  fb_flush();
 #endif  
 }
 
@@ -109,8 +107,7 @@ static void do_golden_tests() {
   memset(msg_buff, 0x00, sizeof(msg_buff));
   snprintf(msg_buff, sizeof(msg_buff), "Result is %ld, Expected is %ld", actual[1], golden_results[1]);
   fb_draw_string(0, 220, 0x007FFF00, (const char *)msg_buff);
-  flush_cpu_dcache();
-  flush_l2_cache();
+  fb_flush();
 #endif 
   
   tflite_set_input(g_person_data);
@@ -123,8 +120,7 @@ static void do_golden_tests() {
   memset(msg_buff, 0x00, sizeof(msg_buff));
   snprintf(msg_buff, sizeof(msg_buff), "Result is %ld, Expected is %ld", actual[2], golden_results[2]);
   fb_draw_string(0, 220, 0x007FFF00, (const char *)msg_buff);
-  flush_cpu_dcache();
-  flush_l2_cache();
+  fb_flush();
 #endif 
 
   bool failed = false;
@@ -162,8 +158,7 @@ void pdti8_menu() {
 
 #ifdef CSR_VIDEO_FRAMEBUFFER_BASE
   fb_init();
-  flush_cpu_dcache();
-  flush_l2_cache();
+  fb_flush();
 #endif
   
   menu_run(&MENU);
@@ -0,0 +1,37 @@
+/*
+ * Copyright 2021 The CFU-Playground Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _NODE_INDEX_H
+#define _NODE_INDEX_H
+
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/micro/micro_allocator.h"
+#include "tensorflow/lite/micro/micro_context.h"
+
+// Returns the index of node among the operators of the subgraph being
+// prepared or invoked, or -1 if node is not one of its nodes. This is the
+// operator's index in the model.
+inline int node_index(TfLiteContext* context, const TfLiteNode* node) {
+  tflite::MicroGraph& graph = tflite::GetMicroContext(context)->graph();
+  const tflite::NodeAndRegistration* nodes =
+      graph.GetAllocations()[graph.GetCurrentSubgraphIndex()]
+          .node_and_registrations;
+  // Each node is the first member of its NodeAndRegistration
+  auto* entry = reinterpret_cast<const tflite::NodeAndRegistration*>(node);
+  return entry >= nodes ? entry - nodes : -1;
+}
+
+#endif  // _NODE_INDEX_H
@@ -17,3 +17,9 @@
 // Empty hooks to be overridden per-project
 void tflite_preload(const unsigned char* model_data, unsigned int model_length) {}
 void tflite_postload() {}
+void tflite_register_fusions() {}
+void tflite_register_kernels() {}
+bool tflite_tensor_placement(const tflite::Model* model, int tensor,
+                             TensorPlacement* placement) {
+  return false;
+}
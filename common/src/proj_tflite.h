@@ -19,10 +19,29 @@
 #ifndef _PROJ_TFLITE_H
 #define _PROJ_TFLITE_H
 
+namespace tflite {
+struct Model;
+}
+struct TensorPlacement;
+
 // Called before the model is loaded
 void tflite_preload(const unsigned char* model_data, unsigned int model_length);
 
 // Called after model successfully loaded
 void tflite_postload();
 
+// Called once, before any model is loaded. Register fusions here with
+// graph_rewrite_register().
+void tflite_register_fusions();
+
+// Called once, before any model is loaded. Register candidate kernels here
+// with kernel_select_register().
+void tflite_register_kernels();
+
+// Called while planning the arena with BANK_AWARE_PLACEMENT defined, for each
+// tensor of subgraph 0 placed in the arena. Returns true after filling
+// placement to constrain where the tensor starts (see bank_planner.h).
+bool tflite_tensor_placement(const tflite::Model* model, int tensor,
+                             TensorPlacement* placement);
+
 #endif  // _PROJ_TFLITE_H
\ No newline at end of file
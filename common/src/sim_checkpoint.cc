@@ -0,0 +1,51 @@
+/*
+ * Copyright 2021 The CFU-Playground Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "sim_checkpoint.h"
+
+#include <generated/csr.h>
+
+namespace {
+
+uint32_t input_seed = 0;
+int trace_op = -1;
+
+}  // anonymous namespace
+
+int sim_checkpoint() {
+#ifdef CSR_SIM_CHECKPOINT_BASE
+  sim_checkpoint_request_write(1);
+  // The simulator saves before acknowledging, so that a restored checkpoint
+  // continues from this loop.
+  while (!sim_checkpoint_ack_read()) {
+  }
+  const int restored = sim_checkpoint_restored_read();
+  if (restored) {
+    input_seed = sim_checkpoint_input_seed_read();
+    trace_op = static_cast<int>(sim_checkpoint_trace_op_read());
+  }
+  sim_checkpoint_request_write(0);
+  while (sim_checkpoint_ack_read()) {
+  }
+  return restored;
+#else
+  return 0;
+#endif
+}
+
+uint32_t sim_checkpoint_input_seed() { return input_seed; }
+
+int sim_checkpoint_trace_op() { return trace_op; }
@@ -0,0 +1,49 @@
+/*
+ * Copyright 2021 The CFU-Playground Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Checkpoint and restore for LiteX simulation.
+//
+// tflite_classify() calls sim_checkpoint() just before Invoke(). Running
+// with SIM_CHECKPOINT_SAVE set, the simulator saves its state there the
+// first time; running with SIM_CHECKPOINT_RESTORE set, it continues from
+// that state, with a new input and trace selection if asked. See
+// soc/sim_checkpoint.py and the checkpoint and resume targets in
+// proj/proj.mk. On other platforms, these functions do nothing.
+
+#ifndef _SIM_CHECKPOINT_H
+#define _SIM_CHECKPOINT_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Gives the simulator the chance to save a checkpoint. Returns non-zero if
+// execution has instead just continued from a restored checkpoint.
+int sim_checkpoint();
+
+// After a restore, the seed for a random input, or zero to keep the input
+uint32_t sim_checkpoint_input_seed();
+
+// After a restore, the index of the op to trace, or -1 to keep the trace
+// selection
+int sim_checkpoint_trace_op();
+
+#ifdef __cplusplus
+}
+#endif
+#endif  // _SIM_CHECKPOINT_H
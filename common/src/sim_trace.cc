@@ -0,0 +1,208 @@
+/*
+ * Copyright 2021 The CFU-Playground Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "sim_trace.h"
+
+#include <generated/csr.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "base.h"
+#include "menu.h"
+
+#define SIM_TRACE_STR(s) #s
+#define SIM_TRACE_XSTR(s) SIM_TRACE_STR(s)
+
+#ifndef SIM_TRACE_COUNT
+#define SIM_TRACE_COUNT 1
+#endif
+
+namespace {
+
+enum Selection {
+  kSelectNone,
+  kSelectOpIndex,
+  kSelectOpTag,
+  kSelectCfuFunct3,
+};
+
+#if defined(SIM_TRACE_OP_INDEX)
+Selection selection = kSelectOpIndex;
+#elif defined(SIM_TRACE_OP_TAG)
+Selection selection = kSelectOpTag;
+#elif defined(SIM_TRACE_CFU_FUNCT3)
+Selection selection = kSelectCfuFunct3;
+#else
+Selection selection = kSelectNone;
+#endif
+
+#ifdef SIM_TRACE_OP_INDEX
+int op_index = SIM_TRACE_OP_INDEX;
+#else
+int op_index = 0;
+#endif
+
+#ifdef SIM_TRACE_OP_TAG
+const char* op_tag = SIM_TRACE_XSTR(SIM_TRACE_OP_TAG);
+#else
+const char* op_tag = "CONV_2D";
+#endif
+
+#ifdef SIM_TRACE_CFU_FUNCT3
+int cfu_funct3 = SIM_TRACE_CFU_FUNCT3;
+#else
+int cfu_funct3 = 0;
+#endif
+
+// Maximum number of regions to trace per inference
+int trace_count = SIM_TRACE_COUNT;
+
+// Number of regions left to trace in this inference
+int remaining = SIM_TRACE_COUNT;
+
+bool tracing = false;
+
+void set_tracing(bool on) {
+#ifdef CSR_SIM_TRACE_BASE
+  sim_trace_enable_write(on ? 1 : 0);
+#endif
+  tracing = on;
+}
+
+void begin_region() {
+  if (remaining > 0) {
+    remaining--;
+    set_tracing(true);
+  }
+}
+
+void end_region() {
+  if (tracing) {
+    set_tracing(false);
+  }
+}
+
+void print_selection() {
+  switch (selection) {
+    case kSelectOpIndex:
+      printf("Tracing op %d", op_index);
+      break;
+    case kSelectOpTag:
+      printf("Tracing %s ops", op_tag);
+      break;
+    case kSelectCfuFunct3:
+      printf("Tracing CFU function %d", cfu_funct3);
+#ifndef SIM_TRACE_CFU
+      printf(" (not built with SIM_TRACE_CFU)");
+#endif
+      break;
+    default:
+      printf("Op-scoped tracing off\n");
+      return;
+  }
+  printf(", at most %d regions per inference\n", trace_count);
+}
+
+void do_select_op_index() {
+  sim_trace_select_op(read_val("Op index"));
+  print_selection();
+}
+
+void select_tag(const char* tag) {
+  op_tag = tag;
+  selection = kSelectOpTag;
+  sim_trace_arm();
+  print_selection();
+}
+
+void do_select_conv() { select_tag("CONV_2D"); }
+void do_select_depthwise_conv() { select_tag("DEPTHWISE_CONV_2D"); }
+void do_select_fully_connected() { select_tag("FULLY_CONNECTED"); }
+
+void do_select_cfu_funct3() {
+  cfu_funct3 = read_val("CFU function (funct3)");
+  selection = kSelectCfuFunct3;
+  sim_trace_arm();
+  print_selection();
+}
+
+void do_set_count() {
+  trace_count = read_val("Max regions per inference");
+  sim_trace_arm();
+  print_selection();
+}
+
+void do_select_none() {
+  selection = kSelectNone;
+  end_region();
+  print_selection();
+}
+
+void do_show() { print_selection(); }
+
+struct Menu MENU = {
+    "Op-Scoped Simulation Trace",
+    "trace",
+    {
+        MENU_ITEM('i', "trace op at index", do_select_op_index),
+        MENU_ITEM('c', "trace CONV_2D ops", do_select_conv),
+        MENU_ITEM('d', "trace DEPTHWISE_CONV_2D ops",
+                  do_select_depthwise_conv),
+        MENU_ITEM('f', "trace FULLY_CONNECTED ops", do_select_fully_connected),
+        MENU_ITEM('u', "trace CFU function", do_select_cfu_funct3),
+        MENU_ITEM('n', "set max regions per inference", do_set_count),
+        MENU_ITEM('o', "turn op-scoped tracing off", do_select_none),
+        MENU_ITEM('s', "show current selection", do_show),
+        MENU_END,
+    },
+};
+
+}  // anonymous namespace
+
+void sim_trace_op_begin(int index, const char* tag) {
+  if ((selection == kSelectOpIndex && index == op_index) ||
+      (selection == kSelectOpTag && strcmp(tag, op_tag) == 0)) {
+    begin_region();
+  }
+}
+
+void sim_trace_op_end() {
+  if (selection != kSelectCfuFunct3) {
+    end_region();
+  }
+}
+
+void sim_trace_cfu_begin(int funct3) {
+  if (selection == kSelectCfuFunct3 && funct3 == cfu_funct3) {
+    begin_region();
+  }
+}
+
+void sim_trace_cfu_end() {
+  if (selection == kSelectCfuFunct3) {
+    end_region();
+  }
+}
+
+void sim_trace_arm() { remaining = trace_count; }
+
+void sim_trace_select_op(int index) {
+  op_index = index;
+  selection = kSelectOpIndex;
+  sim_trace_arm();
+}
+
+void sim_trace_menu() { menu_run(&MENU); }
@@ -0,0 +1,60 @@
+/*
+ * Copyright 2021 The CFU-Playground Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Op-scoped waveform capture for LiteX simulation.
+//
+// Turns simulation tracing on around a selected region only, keeping trace
+// files small and simulation fast. The region may be:
+//   - the op at a given index in the model,
+//   - ops with a given tag (e.g. "CONV_2D"), or
+//   - calls to a given CFU function (requires SIM_TRACE_CFU, see cfu.h).
+//
+// Defaults may be set from the project Makefile:
+//   DEFINES += SIM_TRACE_OP_INDEX=37
+//   DEFINES += SIM_TRACE_OP_TAG=CONV_2D
+//   DEFINES += SIM_TRACE_CFU SIM_TRACE_CFU_FUNCT3=1
+//   DEFINES += SIM_TRACE_COUNT=4
+// and changed at runtime from the main menu. On other platforms, these
+// functions do nothing.
+
+#ifndef _SIM_TRACE_H
+#define _SIM_TRACE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Called by the profiler at the beginning and end of each op
+void sim_trace_op_begin(int index, const char* tag);
+void sim_trace_op_end();
+
+// Called around each CFU instruction when SIM_TRACE_CFU is defined
+void sim_trace_cfu_begin(int funct3);
+void sim_trace_cfu_end();
+
+// Re-arms the trace selection, ready for the next inference
+void sim_trace_arm();
+
+// Selects the op at the given index for tracing
+void sim_trace_select_op(int index);
+
+// Menu for choosing what to trace
+void sim_trace_menu();
+
+#ifdef __cplusplus
+}
+#endif
+#endif  // _SIM_TRACE_H
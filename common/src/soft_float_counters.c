@@ -0,0 +1,130 @@
+/*
+ * Copyright 2021 The CFU-Playground Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "soft_float_counters.h"
+
+#include <stdio.h>
+
+#ifdef COUNT_SOFT_FLOAT
+
+// Under the soft-float calling convention, a float is passed and returned
+// like a uint32_t and a double like a uint64_t. The wrappers use integer
+// types, so that they cannot themselves call the library.
+typedef uint32_t F;
+typedef uint64_t D;
+typedef int32_t I;
+typedef uint32_t U;
+typedef int64_t L;
+
+// Routines to count, with their return and argument types. The list of
+// --wrap options in common/Makefile must match.
+#define SOFT_FLOAT_ROUTINES(UNARY, BINARY) \
+  BINARY(__addsf3, F, F)                   \
+  BINARY(__subsf3, F, F)                   \
+  BINARY(__mulsf3, F, F)                   \
+  BINARY(__divsf3, F, F)                   \
+  BINARY(__adddf3, D, D)                   \
+  BINARY(__subdf3, D, D)                   \
+  BINARY(__muldf3, D, D)                   \
+  BINARY(__divdf3, D, D)                   \
+  UNARY(__extendsfdf2, D, F)               \
+  UNARY(__truncdfsf2, F, D)                \
+  UNARY(__fixsfsi, I, F)                   \
+  UNARY(__fixdfsi, I, D)                   \
+  UNARY(__fixunssfsi, U, F)                \
+  UNARY(__fixunsdfsi, U, D)                \
+  UNARY(__fixsfdi, L, F)                   \
+  UNARY(__fixdfdi, L, D)                   \
+  UNARY(__floatsisf, F, I)                 \
+  UNARY(__floatsidf, D, I)                 \
+  UNARY(__floatunsisf, F, U)               \
+  UNARY(__floatunsidf, D, U)               \
+  UNARY(__floatdisf, F, L)                 \
+  UNARY(__floatdidf, D, L)                 \
+  BINARY(__eqsf2, I, F)                    \
+  BINARY(__nesf2, I, F)                    \
+  BINARY(__ltsf2, I, F)                    \
+  BINARY(__lesf2, I, F)                    \
+  BINARY(__gtsf2, I, F)                    \
+  BINARY(__gesf2, I, F)                    \
+  BINARY(__unordsf2, I, F)                 \
+  BINARY(__eqdf2, I, D)                    \
+  BINARY(__nedf2, I, D)                    \
+  BINARY(__ltdf2, I, D)                    \
+  BINARY(__ledf2, I, D)                    \
+  BINARY(__gtdf2, I, D)                    \
+  BINARY(__gedf2, I, D)                    \
+  BINARY(__unorddf2, I, D)
+
+#define ROUTINE_INDEX(name, ret, arg) name##_index,
+enum { SOFT_FLOAT_ROUTINES(ROUTINE_INDEX, ROUTINE_INDEX) NUM_ROUTINES };
+
+#define ROUTINE_NAME(name, ret, arg) #name,
+static const char* routine_names[NUM_ROUTINES] = {
+    SOFT_FLOAT_ROUTINES(ROUTINE_NAME, ROUTINE_NAME)};
+
+static uint32_t counts[NUM_ROUTINES];
+static uint32_t total;
+
+#define WRAP_UNARY(name, ret, arg)             \
+  ret __real_##name(arg);                      \
+  ret __wrap_##name(arg a) {                   \
+    counts[name##_index]++;                    \
+    total++;                                   \
+    return __real_##name(a);                   \
+  }
+
+#define WRAP_BINARY(name, ret, arg)            \
+  ret __real_##name(arg, arg);                 \
+  ret __wrap_##name(arg a, arg b) {            \
+    counts[name##_index]++;                    \
+    total++;                                   \
+    return __real_##name(a, b);                \
+  }
+
+SOFT_FLOAT_ROUTINES(WRAP_UNARY, WRAP_BINARY)
+
+int soft_float_counters_supported() { return 1; }
+
+void soft_float_counters_reset() {
+  for (int i = 0; i < NUM_ROUTINES; i++) {
+    counts[i] = 0;
+  }
+  total = 0;
+}
+
+uint32_t soft_float_counters_total() { return total; }
+
+void soft_float_counters_print() {
+  printf("Soft-float calls: %lu\n", total);
+  for (int i = 0; i < NUM_ROUTINES; i++) {
+    if (counts[i]) {
+      printf("  %-14s %lu\n", routine_names[i], counts[i]);
+    }
+  }
+}
+
+#else
+
+int soft_float_counters_supported() { return 0; }
+
+void soft_float_counters_reset() {}
+
+uint32_t soft_float_counters_total() { return 0; }
+
+void soft_float_counters_print() {}
+
+#endif  // COUNT_SOFT_FLOAT
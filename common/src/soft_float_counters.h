@@ -0,0 +1,51 @@
+/*
+ * Copyright 2021 The CFU-Playground Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Counts calls to the soft-float library.
+//
+// On CPUs without an FPU, the compiler turns each float or double operation
+// into a call to a library routine such as __mulsf3. When COUNT_SOFT_FLOAT
+// is defined, common/Makefile links with --wrap for each of those routines,
+// so that every call is counted on its way to the library. The profiler then
+// reports the calls made by each op.
+//
+// Without COUNT_SOFT_FLOAT, all counts read as zero.
+
+#ifndef _SOFT_FLOAT_COUNTERS_H
+#define _SOFT_FLOAT_COUNTERS_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Returns non-zero if soft-float calls are being counted
+int soft_float_counters_supported();
+
+// Zeros all counts
+void soft_float_counters_reset();
+
+// Returns the number of calls made to any soft-float routine
+uint32_t soft_float_counters_total();
+
+// Prints the number of calls made to each routine called at least once
+void soft_float_counters_print();
+
+#ifdef __cplusplus
+}
+#endif
+#endif  // _SOFT_FLOAT_COUNTERS_H
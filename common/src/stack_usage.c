@@ -0,0 +1,88 @@
+/*
+ * Copyright 2021 The CFU-Playground Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "stack_usage.h"
+
+#ifdef SHOW_STACK_USAGE
+
+// Defined by the linker script. The stack starts at _fstack + 4 and may grow
+// down to _end.
+extern uint32_t _fstack[];
+extern uint32_t _end[];
+
+#define STACK_PAINT 0x57ac57acu
+
+// Lowest painted word
+static uint32_t* paint_bottom;
+
+static inline uint32_t* stack_top() { return _fstack + 1; }
+
+static inline uint32_t* stack_pointer() {
+  uint32_t* sp;
+  asm volatile("mv %0, sp" : "=r"(sp));
+  return sp;
+}
+
+// Returns the lowest word that no longer holds the paint
+static uint32_t* lowest_used() {
+  uint32_t* p = paint_bottom;
+  while (p < stack_top() && *p == STACK_PAINT) {
+    p++;
+  }
+  return p;
+}
+
+// Everything below sp is free, so painting up to it is safe, as long as
+// painting itself uses no stack.
+static inline __attribute__((always_inline)) void paint(uint32_t* from, uint32_t* to) {
+  for (uint32_t* p = from; p < to; p++) {
+    *p = STACK_PAINT;
+  }
+}
+
+int stack_usage_supported() { return 1; }
+
+void stack_usage_paint() {
+  uint32_t* sp = stack_pointer();
+  const uint32_t max_words = STACK_USAGE_PAINT_BYTES / sizeof(uint32_t);
+  paint_bottom = sp - _end > (int)max_words ? sp - max_words : _end;
+  paint(paint_bottom, sp);
+}
+
+void stack_usage_reset() {
+  if (paint_bottom) {
+    paint(lowest_used(), stack_pointer());
+  }
+}
+
+uint32_t stack_usage_depth() {
+  if (!paint_bottom) {
+    return 0;
+  }
+  return (stack_top() - lowest_used()) * sizeof(uint32_t);
+}
+
+#else
+
+int stack_usage_supported() { return 0; }
+
+void stack_usage_paint() {}
+
+void stack_usage_reset() {}
+
+uint32_t stack_usage_depth() { return 0; }
+
+#endif  // SHOW_STACK_USAGE
@@ -0,0 +1,62 @@
+/*
+ * Copyright 2021 The CFU-Playground Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+// Measures stack depth by painting.
+//
+// With SHOW_STACK_USAGE defined, main() fills the unused stack below it with
+// a pattern at boot. The deepest point the stack has reached is then the
+// lowest word no longer holding the pattern. The progress profiler in
+// tflite.cc repaints before each op and measures after it, to report the
+// deepest stack each op reached.
+//
+// The stack grows down from _fstack towards _end, and the linker script
+// checks that at least _stack_size bytes are left for it (see STACK_SIZE in
+// proj/proj_template/Makefile). Use the measured depth to choose
+// STACK_SIZE before growing the tensor arena.
+//
+// Without SHOW_STACK_USAGE, all depths read as zero.
+
+#ifndef _STACK_USAGE_H
+#define _STACK_USAGE_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Depths beyond this are not measured, to limit the time spent painting
+#ifndef STACK_USAGE_PAINT_BYTES
+#define STACK_USAGE_PAINT_BYTES (128 * 1024)
+#endif
+
+// Returns non-zero if stack usage is being measured
+int stack_usage_supported();
+
+// Paints the stack below the caller. Call once, early in main().
+void stack_usage_paint();
+
+// Repaints the stack used since the last paint or reset, below the caller
+void stack_usage_reset();
+
+// Returns the deepest the stack has been since the last paint or reset, in
+// bytes below the top of the stack. Returns STACK_USAGE_PAINT_BYTES or more
+// if the painted area was exhausted.
+uint32_t stack_usage_depth();
+
+#ifdef __cplusplus
+}
+#endif
+#endif  // _STACK_USAGE_H
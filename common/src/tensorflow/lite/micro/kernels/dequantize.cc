@@ -0,0 +1,134 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/kernels/internal/reference/dequantize.h"
+
+#include "integer_quantize.h"
+#include "tensorflow/lite/c/builtin_op_data.h"
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/kernels/internal/quantization_util.h"
+#include "tensorflow/lite/kernels/internal/reference/quantize.h"
+#include "tensorflow/lite/kernels/internal/reference/requantize.h"
+#include "tensorflow/lite/kernels/internal/tensor_ctypes.h"
+#include "tensorflow/lite/kernels/kernel_util.h"
+#include "tensorflow/lite/micro/kernels/dequantize.h"
+#include "tensorflow/lite/micro/kernels/kernel_util.h"
+#include "tensorflow/lite/micro/micro_error_reporter.h"
+#include "tensorflow/lite/micro/micro_utils.h"
+
+namespace tflite {
+
+#ifdef INTEGER_QUANTIZE
+namespace {
+
+struct DequantizeIntegerOpData {
+  // First, so that DequantizePrepare() can use this as its own op data.
+  DequantizeOpData reference;
+  // For int8 input
+  float table[INTEGER_DEQUANTIZE_TABLE_SIZE];
+};
+
+TfLiteStatus DequantizeIntegerPrepare(TfLiteContext* context,
+                                      TfLiteNode* node) {
+  TF_LITE_ENSURE_STATUS(DequantizePrepare(context, node));
+  auto* data = static_cast<DequantizeIntegerOpData*>(node->user_data);
+  MicroContext* micro_context = GetMicroContext(context);
+  TfLiteTensor* input = micro_context->AllocateTempInputTensor(node, 0);
+  if (input->type == kTfLiteInt8) {
+    integer_dequantize_table(data->reference.quantization_params.scale,
+                             data->reference.quantization_params.zero_point,
+                             data->table);
+  }
+  micro_context->DeallocateTempTfLiteTensor(input);
+  return kTfLiteOk;
+}
+
+}  // namespace
+#endif
+
+void* DequantizeInit(TfLiteContext* context, const char* buffer,
+                     size_t length) {
+  TFLITE_DCHECK(context->AllocatePersistentBuffer != nullptr);
+#ifdef INTEGER_QUANTIZE
+  return context->AllocatePersistentBuffer(context,
+                                           sizeof(DequantizeIntegerOpData));
+#else
+  return context->AllocatePersistentBuffer(context, sizeof(DequantizeOpData));
+#endif
+}
+
+TfLiteStatus DequantizeEval(TfLiteContext* context, TfLiteNode* node) {
+  TFLITE_DCHECK(node->user_data != nullptr);
+  DequantizeOpData* data = static_cast<DequantizeOpData*>(node->user_data);
+
+  const TfLiteEvalTensor* input = tflite::micro::GetEvalInput(context, node, 0);
+  TfLiteEvalTensor* output = tflite::micro::GetEvalOutput(context, node, 0);
+
+  if (output->type == kTfLiteFloat32) {
+    switch (input->type) {
+      case kTfLiteInt8:
+#ifdef INTEGER_QUANTIZE
+        integer_dequantize(
+            static_cast<DequantizeIntegerOpData*>(node->user_data)->table,
+            tflite::micro::GetTensorData<int8_t>(input),
+            ElementCount(*input->dims),
+            tflite::micro::GetTensorData<float>(output));
+#else
+        reference_ops::Dequantize(data->quantization_params,
+                                  tflite::micro::GetTensorShape(input),
+                                  tflite::micro::GetTensorData<int8_t>(input),
+                                  tflite::micro::GetTensorShape(output),
+                                  tflite::micro::GetTensorData<float>(output));
+#endif
+        break;
+      case kTfLiteInt16:
+        reference_ops::Dequantize(data->quantization_params,
+                                  tflite::micro::GetTensorShape(input),
+                                  tflite::micro::GetTensorData<int16_t>(input),
+                                  tflite::micro::GetTensorShape(output),
+                                  tflite::micro::GetTensorData<float>(output));
+        break;
+      default:
+        MicroPrintf("Input %s, output %s not supported.",
+                    TfLiteTypeGetName(input->type),
+                    TfLiteTypeGetName(output->type));
+        return kTfLiteError;
+    }
+  } else {
+    MicroPrintf("Input %s, output %s not supported.",
+                TfLiteTypeGetName(input->type),
+                TfLiteTypeGetName(output->type));
+    return kTfLiteError;
+  }
+
+  return kTfLiteOk;
+}
+
+TfLiteRegistration Register_DEQUANTIZE() {
+  return {/*init=*/DequantizeInit,
+          /*free=*/nullptr,
+#ifdef INTEGER_QUANTIZE
+          /*prepare=*/DequantizeIntegerPrepare,
+#else
+          /*prepare=*/DequantizePrepare,
+#endif
+          /*invoke=*/DequantizeEval,
+          /*profiling_string=*/nullptr,
+          /*builtin_code=*/0,
+          /*custom_name=*/nullptr,
+          /*version=*/0};
+}
+
+}  // namespace tflite
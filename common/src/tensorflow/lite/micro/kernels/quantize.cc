@@ -0,0 +1,143 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/micro/kernels/quantize.h"
+
+#include "elementwise.h"
+#include "integer_quantize.h"
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/kernels/internal/quantization_util.h"
+#include "tensorflow/lite/kernels/internal/tensor_ctypes.h"
+#include "tensorflow/lite/kernels/kernel_util.h"
+#include "tensorflow/lite/micro/kernels/kernel_util.h"
+#include "tensorflow/lite/micro/micro_utils.h"
+
+namespace tflite {
+namespace {
+
+#if defined(ELEMENTWISE_ENGINE) || defined(INTEGER_QUANTIZE)
+struct OpDataQuantize {
+  // First, so that the reference Eval can use this as its own op data.
+  OpDataQuantizeReference reference;
+  TfLiteType input_type;
+  TfLiteType output_type;
+#ifdef ELEMENTWISE_ENGINE
+  // For int8 -> int8
+  int8_t table[ELEMENTWISE_TABLE_SIZE];
+#endif
+#ifdef INTEGER_QUANTIZE
+  // For float -> int8
+  int32_t thresholds[INTEGER_QUANTIZE_NUM_THRESHOLDS];
+#endif
+};
+
+void* Init(TfLiteContext* context, const char* buffer, size_t length) {
+  TFLITE_DCHECK(context->AllocatePersistentBuffer != nullptr);
+  return context->AllocatePersistentBuffer(context, sizeof(OpDataQuantize));
+}
+
+TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
+  TF_LITE_ENSURE_STATUS(PrepareQuantizeReference(context, node));
+  auto* data = static_cast<OpDataQuantize*>(node->user_data);
+
+  MicroContext* micro_context = GetMicroContext(context);
+  TfLiteTensor* input = micro_context->AllocateTempInputTensor(node, 0);
+  TfLiteTensor* output = micro_context->AllocateTempOutputTensor(node, 0);
+  data->input_type = input->type;
+  data->output_type = output->type;
+  micro_context->DeallocateTempTfLiteTensor(input);
+  micro_context->DeallocateTempTfLiteTensor(output);
+
+  if (data->output_type != kTfLiteInt8) {
+    return kTfLiteOk;
+  }
+#ifdef ELEMENTWISE_ENGINE
+  if (data->input_type == kTfLiteInt8) {
+    elementwise_requantize_table(
+        data->reference.requantize_output_multiplier,
+        data->reference.requantize_output_shift,
+        data->reference.input_zero_point,
+        data->reference.quantization_params.zero_point, data->table);
+  }
+#endif
+#ifdef INTEGER_QUANTIZE
+  if (data->input_type == kTfLiteFloat32) {
+    integer_quantize_thresholds(data->reference.quantization_params.scale,
+                                data->reference.quantization_params.zero_point,
+                                data->thresholds);
+  }
+#endif
+  return kTfLiteOk;
+}
+
+TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
+  auto* data = static_cast<OpDataQuantize*>(node->user_data);
+  const TfLiteEvalTensor* input = tflite::micro::GetEvalInput(context, node, 0);
+  TfLiteEvalTensor* output = tflite::micro::GetEvalOutput(context, node, 0);
+#ifdef ELEMENTWISE_ENGINE
+  if (data->input_type == kTfLiteInt8 && data->output_type == kTfLiteInt8) {
+    elementwise_requantize(data->reference.requantize_output_multiplier,
+                           data->reference.requantize_output_shift,
+                           data->reference.input_zero_point,
+                           data->reference.quantization_params.zero_point,
+                           data->table,
+                           tflite::micro::GetTensorData<int8_t>(input),
+                           ElementCount(*input->dims),
+                           tflite::micro::GetTensorData<int8_t>(output));
+    return kTfLiteOk;
+  }
+#endif
+#ifdef INTEGER_QUANTIZE
+  if (data->input_type == kTfLiteFloat32 &&
+      data->output_type == kTfLiteInt8) {
+    integer_quantize(data->thresholds,
+                     tflite::micro::GetTensorData<float>(input),
+                     ElementCount(*input->dims),
+                     tflite::micro::GetTensorData<int8_t>(output));
+    return kTfLiteOk;
+  }
+#endif
+  return EvalQuantizeReference(context, node);
+}
+#else
+void* Init(TfLiteContext* context, const char* buffer, size_t length) {
+  TFLITE_DCHECK(context->AllocatePersistentBuffer != nullptr);
+  return context->AllocatePersistentBuffer(context,
+                                           sizeof(OpDataQuantizeReference));
+}
+
+TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
+  return PrepareQuantizeReference(context, node);
+}
+
+TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
+  return EvalQuantizeReference(context, node);
+}
+#endif
+
+}  // namespace
+
+TfLiteRegistration Register_QUANTIZE() {
+  return {/*init=*/Init,
+          /*free=*/nullptr,
+          /*prepare=*/Prepare,
+          /*invoke=*/Eval,
+          /*profiling_string=*/nullptr,
+          /*builtin_code=*/0,
+          /*custom_name=*/nullptr,
+          /*version=*/0};
+}
+
+}  // namespace tflite
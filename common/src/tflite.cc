@@ -16,9 +16,20 @@
 
 #include <cstdint>
 
+#include "accel_coverage.h"
+#include "bank_planner.h"
+#include "boot_timer.h"
+#include "cfu_counters.h"
+#include "graph_rewrite.h"
+#include "kernel_select.h"
+#include "memory_timeline.h"
 #include "perf.h"
 #include "playground_util/random.h"
 #include "proj_tflite.h"
+#include "sim_checkpoint.h"
+#include "sim_trace.h"
+#include "soft_float_counters.h"
+#include "stack_usage.h"
 #include "tensorflow/lite/micro/all_ops_resolver.h"
 #include "tensorflow/lite/micro/micro_error_reporter.h"
 #include "tensorflow/lite/micro/micro_interpreter.h"
@@ -34,6 +45,10 @@
 #define INTERPRETER_TYPE MicroInterpreter
 #endif
 
+#if defined(BANK_AWARE_PLACEMENT) && defined(TF_LITE_SHOW_MEMORY_USE)
+#error "BANK_AWARE_PLACEMENT needs the plain MicroInterpreter"
+#endif
+
 // For C++ exceptions
 void* __dso_handle = &__dso_handle;
 
@@ -41,23 +56,210 @@ void* __dso_handle = &__dso_handle;
 // TfLM global objects
 namespace {
 
-// A profiler that prints a "." for each profile event begun
+// A profiler that prints a "." for each profile event begun.
+//
+// Records the exact cycles taken by each event, as well as the ticks that
+// MicroProfiler records.
+// With SHOW_CFU_COUNTERS defined, also records the change in CFU counters
+// over each event, with COUNT_SOFT_FLOAT the number of soft-float calls, and
+// with SHOW_STACK_USAGE the deepest stack reached.
+// With SHOW_ACCEL_COVERAGE, tells accel_coverage which op is running.
+// In simulation, turns tracing on around selected events.
 class ProgressProfiler : public tflite::MicroProfiler {
  public:
   virtual uint32_t BeginEvent(const char* tag) {
 #ifndef HIDE_PROGRESS_DOTS
     printf(".");
 #endif
-    return tflite::MicroProfiler::BeginEvent(tag);
+#ifdef SHOW_STACK_USAGE
+    // Repaint before the event starts, so as not to count the time
+    stack_usage_reset();
+#endif
+    uint32_t handle = tflite::MicroProfiler::BeginEvent(tag);
+#ifdef SHOW_CFU_COUNTERS
+    if (handle < kMaxCfuCounterEvents) {
+      cfu_tags_[handle] = tag;
+      num_cfu_events_ = handle + 1;
+    }
+    cfu_counters_read(&cfu_start_);
+#endif
+#ifdef COUNT_SOFT_FLOAT
+    if (handle < kMaxSoftFloatEvents) {
+      soft_float_tags_[handle] = tag;
+      num_soft_float_events_ = handle + 1;
+    }
+    soft_float_start_ = soft_float_counters_total();
+#endif
+#ifdef SHOW_STACK_USAGE
+    if (handle < kMaxStackEvents) {
+      stack_tags_[handle] = tag;
+      num_stack_events_ = handle + 1;
+    }
+#endif
+    sim_trace_op_begin(handle, tag);
+    accel_coverage_op_begin(handle, tag);
+    if (handle < kMaxCycleEvents) {
+      cycle_tags_[handle] = tag;
+      num_cycle_events_ = handle + 1;
+    }
+    cycle_start_ = perf_get_mcycle64();
+    return handle;
+  }
+
+  virtual void EndEvent(uint32_t event_handle) {
+    const uint64_t cycle_end = perf_get_mcycle64();
+    if (event_handle < kMaxCycleEvents) {
+      cycles_[event_handle] = cycle_end - cycle_start_;
+    }
+    sim_trace_op_end();
+#ifdef COUNT_SOFT_FLOAT
+    if (event_handle < kMaxSoftFloatEvents) {
+      soft_float_calls_[event_handle] =
+          soft_float_counters_total() - soft_float_start_;
+    }
+#endif
+#ifdef SHOW_CFU_COUNTERS
+    struct CfuCounters end;
+    cfu_counters_read(&end);
+#endif
+    tflite::MicroProfiler::EndEvent(event_handle);
+#ifdef SHOW_STACK_USAGE
+    if (event_handle < kMaxStackEvents) {
+      stack_depths_[event_handle] = stack_usage_depth();
+    }
+#endif
+#ifdef SHOW_CFU_COUNTERS
+    if (event_handle < kMaxCfuCounterEvents) {
+      cfu_counters_diff(&end, &cfu_start_, &cfu_deltas_[event_handle]);
+    }
+#endif
+  }
+
+  void ClearAll() {
+    ClearEvents();
+    num_cycle_events_ = 0;
+#ifdef SHOW_CFU_COUNTERS
+    num_cfu_events_ = 0;
+    cfu_counters_reset();
+#endif
+#ifdef COUNT_SOFT_FLOAT
+    num_soft_float_events_ = 0;
+    soft_float_counters_reset();
+#endif
+#ifdef SHOW_STACK_USAGE
+    num_stack_events_ = 0;
+#endif
+    accel_coverage_reset();
+  }
+
+  // Prints the cycles taken by each event in the same form as LogCsv().
+  // Ticks are cycles / 1024, which is too coarse to compare small ops. In
+  // Renode, which counts one cycle per instruction executed, these are
+  // instruction counts, and renode_perf_gate.py checks them.
+  void LogCyclesCsv() const {
+    uint64_t total = 0;
+    printf("\"Event\",\"Tag\",\"Cycles\"\n");
+    for (uint32_t i = 0; i < num_cycle_events_; ++i) {
+      printf("%lu,%s,%llu\n", i, cycle_tags_[i], cycles_[i]);
+      total += cycles_[i];
+    }
+    printf("%llu cycles in events\n", total);
+  }
+
+  // Prints CFU counters for each event in the same form as LogCsv().
+  void LogCfuCountersCsv() const {
+#ifdef SHOW_CFU_COUNTERS
+    if (!cfu_counters_supported()) {
+      printf("CFU counters not supported.\n");
+      return;
+    }
+    struct CfuCounters total = {0, 0, 0, 0};
+    printf("\"Event\",\"Tag\",\"Busy\",\"Input Starved\","
+           "\"Output Blocked\",\"Idle\"\n");
+    for (uint32_t i = 0; i < num_cfu_events_; ++i) {
+      const struct CfuCounters& c = cfu_deltas_[i];
+      printf("%lu,%s,%lu,%lu,%lu,%lu\n", i, cfu_tags_[i], c.busy,
+             c.input_starved, c.output_blocked, c.idle);
+      total.busy += c.busy;
+      total.input_starved += c.input_starved;
+      total.output_blocked += c.output_blocked;
+      total.idle += c.idle;
+    }
+    printf("CFU busy %lu, input starved %lu, output blocked %lu, idle %lu\n",
+           total.busy, total.input_starved, total.output_blocked, total.idle);
+#endif
+  }
+
+  // Prints soft-float calls for each event in the same form as LogCsv().
+  void LogSoftFloatCsv() const {
+#ifdef COUNT_SOFT_FLOAT
+    printf("\"Event\",\"Tag\",\"Soft-float calls\"\n");
+    for (uint32_t i = 0; i < num_soft_float_events_; ++i) {
+      printf("%lu,%s,%lu\n", i, soft_float_tags_[i], soft_float_calls_[i]);
+    }
+    soft_float_counters_print();
+#endif
+  }
+
+  // Prints the deepest stack reached by each event in the same form as
+  // LogCsv().
+  void LogStackUsageCsv() const {
+#ifdef SHOW_STACK_USAGE
+    uint32_t deepest = 0;
+    printf("\"Event\",\"Tag\",\"Stack bytes\"\n");
+    for (uint32_t i = 0; i < num_stack_events_; ++i) {
+      printf("%lu,%s,%lu\n", i, stack_tags_[i], stack_depths_[i]);
+      deepest = stack_depths_[i] > deepest ? stack_depths_[i] : deepest;
+    }
+    printf("Deepest stack %lu bytes", deepest);
+    if (deepest >= STACK_USAGE_PAINT_BYTES) {
+      printf(" or more - increase STACK_USAGE_PAINT_BYTES to measure");
+    }
+    printf("\n");
+#endif
   }
 
  private:
+  // Events beyond this number are not recorded
+  static constexpr uint32_t kMaxCycleEvents = 128;
+
+  const char* cycle_tags_[kMaxCycleEvents];
+  uint64_t cycles_[kMaxCycleEvents];
+  uint64_t cycle_start_;
+  uint32_t num_cycle_events_ = 0;
+#ifdef SHOW_CFU_COUNTERS
+  // Events beyond this number are not recorded
+  static constexpr uint32_t kMaxCfuCounterEvents = 128;
+
+  const char* cfu_tags_[kMaxCfuCounterEvents];
+  struct CfuCounters cfu_deltas_[kMaxCfuCounterEvents];
+  struct CfuCounters cfu_start_;
+  uint32_t num_cfu_events_ = 0;
+#endif
+#ifdef COUNT_SOFT_FLOAT
+  // Events beyond this number are not recorded
+  static constexpr uint32_t kMaxSoftFloatEvents = 128;
+
+  const char* soft_float_tags_[kMaxSoftFloatEvents];
+  uint32_t soft_float_calls_[kMaxSoftFloatEvents];
+  uint32_t soft_float_start_;
+  uint32_t num_soft_float_events_ = 0;
+#endif
+#ifdef SHOW_STACK_USAGE
+  // Events beyond this number are not recorded
+  static constexpr uint32_t kMaxStackEvents = 128;
+
+  const char* stack_tags_[kMaxStackEvents];
+  uint32_t stack_depths_[kMaxStackEvents];
+  uint32_t num_stack_events_ = 0;
+#endif
+
   TF_LITE_REMOVE_VIRTUAL_DELETE;
 };
 
 tflite::ErrorReporter* error_reporter = nullptr;
 tflite::MicroOpResolver* op_resolver = nullptr;
-tflite::MicroProfiler* profiler = nullptr;
+ProgressProfiler* profiler = nullptr;
 
 const tflite::Model* model = nullptr;
 tflite::INTERPRETER_TYPE* interpreter = nullptr;
@@ -91,6 +293,10 @@ constexpr int kTensorArenaSize = const_max<int>(
 #ifdef INCLUDE_MODEL_HPS
     256 * 1024,
 #endif
+#if defined(INCLUDE_MODEL_HPS) && defined(HPS_ADAPTIVE_RESOLUTION)
+    // The full and low resolution HPS models, resident together
+    (256 + 96) * 1024,
+#endif
 #ifdef INLCUDE_MODEL_MLCOMMONS_TINY_V01_ANOMD
     3 * 1024,
 #endif
@@ -111,6 +317,92 @@ static uint8_t tensor_arena[kTensorArenaSize] __attribute__((section(".arena")))
 #else
 static uint8_t tensor_arena[kTensorArenaSize];
 #endif
+
+// Models loaded with tflite_load_resident_model(), each with its own
+// interpreter and its own part of the arena
+constexpr int kMaxResidentModels = 2;
+alignas(tflite::INTERPRETER_TYPE) unsigned char
+    resident_buf[kMaxResidentModels][sizeof(tflite::INTERPRETER_TYPE)];
+tflite::INTERPRETER_TYPE* resident_interpreters[kMaxResidentModels];
+size_t resident_arena_used = 0;
+
+uint64_t last_classify_cycles = 0;
+
+// Set while the current interpreter's tensors are yet to be allocated
+bool allocation_pending = false;
+
+// Set from loading a model until its first inference
+bool first_result_pending = false;
+
+// Boot marks made before the first model was loaded, or -1 until then
+int num_boot_marks = -1;
+
+// Boot timer cycles when the current model was selected
+uint64_t load_start_cycles = 0;
+
+// Cycles taken to load each resident model, and whether it is yet to give
+// a result
+uint64_t resident_load_cycles[kMaxResidentModels];
+bool resident_first_result_pending[kMaxResidentModels];
+
+#ifdef BANK_AWARE_PLACEMENT
+BankAwarePlanner* bank_planner = nullptr;
+#endif
+
+void unload_resident_models() {
+  for (int i = 0; i < kMaxResidentModels; i++) {
+    if (resident_interpreters[i]) {
+      if (interpreter == resident_interpreters[i]) {
+        interpreter = nullptr;
+      }
+      resident_interpreters[i]->~INTERPRETER_TYPE();
+      resident_interpreters[i] = nullptr;
+    }
+  }
+  resident_arena_used = 0;
+}
+
+void print_input_dims() {
+  auto input = interpreter->input(0);
+  auto dims = input->dims;
+  printf("Input: %d bytes, %d dims:", input->bytes, dims->size);
+  for (int ii = 0; ii < dims->size; ++ii) {
+    printf(" %d", dims->data[ii]);
+  }
+  puts("\n");
+}
+
+// Prints where time went between reset and the first result from the
+// current model. Time waiting at the menu is left out.
+void print_time_to_first_result() {
+  const uint64_t end = boot_timer_cycles(boot_timer_count() - 1);
+  boot_timer_print();
+  printf("Time to first result: ");
+  perf_print_value(end - load_start_cycles);
+  printf(" cycles from model selection, ");
+  perf_print_value(end);
+  printf(" since reset\n");
+}
+
+// As above, for a resident model given its first result. Other models may
+// run between loading and first use, so this adds the load and Invoke
+// cycles, leaving out setting the input.
+void print_resident_time_to_first_result() {
+  for (int i = 0; i < kMaxResidentModels; i++) {
+    if (interpreter != resident_interpreters[i] ||
+        !resident_first_result_pending[i]) {
+      continue;
+    }
+    resident_first_result_pending[i] = false;
+    printf("Resident model %d: time to first result ", i);
+    perf_print_value(resident_load_cycles[i] + last_classify_cycles);
+    printf(" cycles, ");
+    perf_print_value(resident_load_cycles[i]);
+    printf(" loading and ");
+    perf_print_value(last_classify_cycles);
+    printf(" in Invoke\n");
+  }
+}
 }  // anonymous namespace
 
 uint8_t *tflite_tensor_arena = tensor_arena;
@@ -134,17 +426,69 @@ static void tflite_init() {
   // needed by this graph.
   //
   static tflite::AllOpsResolver resolver;
-  op_resolver = &resolver;
+
+  // Fusions are applied at load time, see graph_rewrite.h
+#ifdef FUSE_PAD_CONV
+  graph_rewrite_register(&kFusionPadConv);
+#endif
+  tflite_register_fusions();
+  op_resolver = graph_rewrite_resolver(&resolver);
+
+  // Kernels are chosen at prepare time, see kernel_select.h
+  tflite_register_kernels();
 
   // profiler
   static ProgressProfiler micro_profiler;
   profiler = &micro_profiler;
 }
 
+bool tflite_prepare() {
+  if (!allocation_pending) {
+    return true;
+  }
+  allocation_pending = false;
+
+  // Allocate memory from the tensor_arena for the model's tensors. This
+  // also runs each op's Init and Prepare.
+  TfLiteStatus allocate_status = interpreter->AllocateTensors();
+  boot_timer_mark("AllocateTensors");
+  if (allocate_status != kTfLiteOk) {
+    TF_LITE_REPORT_ERROR(error_reporter, "AllocateTensors() failed");
+    return false;
+  }
+
+#ifdef TF_LITE_SHOW_MEMORY_USE
+  interpreter->GetMicroAllocator().PrintAllocations();
+  memory_timeline_print(model);
+#endif
+#ifdef BANK_AWARE_PLACEMENT
+  bank_planner->PrintReport();
+#endif
+  graph_rewrite_print_report();
+  kernel_select_print_report();
+
+  // Get information about the memory area to use for the model's input.
+  print_input_dims();
+
+  tflite_postload();
+  boot_timer_mark("postload");
+  return true;
+}
+
 void tflite_load_model(const unsigned char* model_data,
                        unsigned int model_length) {
+  // Keep the marks made during boot, but not those of an earlier model
+  if (num_boot_marks < 0) {
+    num_boot_marks = boot_timer_count();
+  }
+  boot_timer_rewind(num_boot_marks);
+  boot_timer_mark("model selected");
+  load_start_cycles = boot_timer_cycles(boot_timer_count() - 1);
+
   tflite_init();
+  boot_timer_mark("tflite_init");
   tflite_preload(model_data, model_length);
+  unload_resident_models();
   if (interpreter) {
     interpreter->~INTERPRETER_TYPE();
     interpreter = nullptr;
@@ -153,57 +497,154 @@ void tflite_load_model(const unsigned char* model_data,
   // Map the model into a usable data structure. This doesn't involve any
   // copying or parsing, it's a very lightweight operation.
   model = tflite::GetModel(model_data);
+  graph_rewrite_apply(model);
+  kernel_select_reset();
+  boot_timer_mark("map model");
 
   // Build an interpreter to run the model with.
   // NOLINTNEXTLINE(runtime-global-variables)
   alignas(tflite::INTERPRETER_TYPE) static unsigned char
       buf[sizeof(tflite::INTERPRETER_TYPE)];
+#ifdef BANK_AWARE_PLACEMENT
+  // Plan the arena with the project's placement constraints
+  alignas(BankAwarePlanner) static unsigned char
+      planner_buf[sizeof(BankAwarePlanner)];
+  if (bank_planner) {
+    bank_planner->~BankAwarePlanner();
+  }
+  bank_planner = new (planner_buf) BankAwarePlanner(model);
+  tflite::MicroAllocator* allocator = tflite::MicroAllocator::Create(
+      tensor_arena, kTensorArenaSize, bank_planner, error_reporter);
+  interpreter = new (buf) tflite::INTERPRETER_TYPE(
+      model, *op_resolver, allocator, error_reporter, nullptr, profiler);
+#else
   interpreter = new (buf)
       tflite::INTERPRETER_TYPE(model, *op_resolver, tensor_arena,
                                kTensorArenaSize, error_reporter, nullptr, profiler);
+#endif
+  boot_timer_mark("interpreter");
+  allocation_pending = true;
+  first_result_pending = true;
 
-  // Allocate memory from the tensor_arena for the model's tensors.
-  TfLiteStatus allocate_status = interpreter->AllocateTensors();
-  if (allocate_status != kTfLiteOk) {
-    TF_LITE_REPORT_ERROR(error_reporter, "AllocateTensors() failed");
-    return;
+#ifndef LAZY_PREPARE
+  tflite_prepare();
+#endif
+}
+
+bool tflite_load_resident_model(int slot, const unsigned char* model_data,
+                                unsigned int model_length, size_t arena_bytes) {
+  uint64_t start = perf_get_mcycle64();
+  tflite_init();
+  if (slot < 0 || slot >= kMaxResidentModels || resident_interpreters[slot]) {
+    printf("Resident model slot %d not available\n", slot);
+    return false;
+  }
+  size_t available = kTensorArenaSize - resident_arena_used;
+  bool fit = arena_bytes == TFLITE_RESIDENT_ARENA_FIT;
+  if (arena_bytes == 0 || fit) {
+    arena_bytes = available;
+  }
+  if (arena_bytes > available) {
+    printf("Resident model needs %u arena bytes, %u available\n", arena_bytes,
+           available);
+    return false;
   }
+  tflite_preload(model_data, model_length);
 
-#ifdef TF_LITE_SHOW_MEMORY_USE
-  interpreter->GetMicroAllocator().PrintAllocations();
-#endif
+  // A model loaded by tflite_load_model() owns the whole arena
+  bool is_resident = false;
+  for (int i = 0; i < kMaxResidentModels; i++) {
+    is_resident |= (interpreter == resident_interpreters[i]);
+  }
+  if (interpreter && !is_resident) {
+    interpreter->~INTERPRETER_TYPE();
+    interpreter = nullptr;
+  }
+  // Resident models are prepared as they are loaded, and report their time
+  // to first result separately
+  allocation_pending = false;
+  first_result_pending = false;
 
-  // Get information about the memory area to use for the model's input.
-  auto input = interpreter->input(0);
-  auto dims = input->dims;
-  printf("Input: %d bytes, %d dims:", input->bytes, dims->size);
-  for (int ii = 0; ii < dims->size; ++ii) {
-    printf(" %d", dims->data[ii]);
+  // Fusion records are kept for one model at a time, so resident models are
+  // not fused. The kernel choice report covers all resident models.
+  model = tflite::GetModel(model_data);
+  graph_rewrite_clear();
+  if (resident_arena_used == 0) {
+    kernel_select_reset();
   }
-  puts("\n");
+  tflite::INTERPRETER_TYPE* resident = new (resident_buf[slot])
+      tflite::INTERPRETER_TYPE(model, *op_resolver,
+                               tensor_arena + resident_arena_used, arena_bytes,
+                               error_reporter, nullptr, profiler);
+  int num_choices = kernel_select_count();
+  if (resident->AllocateTensors() != kTfLiteOk) {
+    TF_LITE_REPORT_ERROR(error_reporter, "AllocateTensors() failed");
+    resident->~INTERPRETER_TYPE();
+    return false;
+  }
+  if (fit) {
+    // TFLM places persistent buffers at the top of the arena, so the arena
+    // cannot be cut down in place: allocate again in what was used. The
+    // kernel choices recorded by the first allocation pointed into it.
+    arena_bytes = (resident->arena_used_bytes() + 15) & ~15;
+    resident->~INTERPRETER_TYPE();
+    kernel_select_rewind(num_choices);
+    resident = new (resident_buf[slot]) tflite::INTERPRETER_TYPE(
+        model, *op_resolver, tensor_arena + resident_arena_used, arena_bytes,
+        error_reporter, nullptr, profiler);
+    if (resident->AllocateTensors() != kTfLiteOk) {
+      TF_LITE_REPORT_ERROR(error_reporter, "AllocateTensors() failed");
+      resident->~INTERPRETER_TYPE();
+      return false;
+    }
+  }
+  printf("Resident model %d: %u of %u arena bytes used\n", slot,
+         resident->arena_used_bytes(), arena_bytes);
+  kernel_select_print_report();
+
+  // Keep the next model's part of the arena aligned
+  resident_arena_used += (arena_bytes + 15) & ~15;
+  resident_interpreters[slot] = resident;
+  interpreter = resident;
+  print_input_dims();
 
   tflite_postload();
+  resident_load_cycles[slot] = perf_get_mcycle64() - start;
+  resident_first_result_pending[slot] = true;
+  return true;
+}
+
+bool tflite_select_resident_model(int slot) {
+  if (slot < 0 || slot >= kMaxResidentModels || !resident_interpreters[slot]) {
+    return false;
+  }
+  interpreter = resident_interpreters[slot];
+  return true;
 }
 
 void tflite_set_input_zeros(void) {
+  tflite_prepare();
   auto input = interpreter->input(0);
   memset(input->data.int8, 0, input->bytes);
   printf("Zeroed %d bytes at %p\n", input->bytes, input->data.int8);
 }
 
 void tflite_set_input_zeros_float() {
+  tflite_prepare();
   auto input = interpreter->input(0);
   memset(input->data.f, 0, input->bytes);
   printf("Zeroed %d bytes at %p\n", input->bytes, input->data.f);
 }
 
 void tflite_set_input(const void* data) {
+  tflite_prepare();
   auto input = interpreter->input(0);
   memcpy(input->data.int8, data, input->bytes);
   printf("Copied %d bytes at %p\n", input->bytes, input->data.int8);
 }
 
 void tflite_set_input_unsigned(const unsigned char* data) {
+  tflite_prepare();
   auto input = interpreter->input(0);
   for (size_t i = 0; i < input->bytes; i++) {
     input->data.int8[i] = static_cast<int>(data[i]) - 128;
@@ -211,7 +652,35 @@ void tflite_set_input_unsigned(const unsigned char* data) {
   printf("Set %d bytes at %p\n", input->bytes, input->data.int8);
 }
 
+void tflite_set_input_unsigned_downscaled(const unsigned char* data,
+                                          int factor) {
+  tflite_prepare();
+  auto input = interpreter->input(0);
+  const int height = input->dims->data[1];
+  const int width = input->dims->data[2];
+  const int depth = input->dims->data[3];
+  const int count = factor * factor;
+  int8_t* out = input->data.int8;
+  for (int y = 0; y < height; y++) {
+    for (int x = 0; x < width; x++) {
+      for (int c = 0; c < depth; c++) {
+        int sum = 0;
+        for (int fy = 0; fy < factor; fy++) {
+          const unsigned char* row =
+              data + ((y * factor + fy) * width * factor + x * factor) * depth;
+          for (int fx = 0; fx < factor; fx++) {
+            sum += row[fx * depth + c];
+          }
+        }
+        *out++ = static_cast<int>((sum + count / 2) / count) - 128;
+      }
+    }
+  }
+  printf("Set %d bytes at %p\n", input->bytes, input->data.int8);
+}
+
 void tflite_set_input_float(const float* data) {
+  tflite_prepare();
   auto input = interpreter->input(0);
   memcpy(input->data.f, data, input->bytes);
   printf("Copied %d bytes at %p\n", input->bytes, input->data.f);
@@ -219,6 +688,7 @@ void tflite_set_input_float(const float* data) {
 
 void tflite_randomize_input(int64_t seed) {
   int64_t r = seed;
+  tflite_prepare();
   auto input = interpreter->input(0);
   for (size_t i = 0; i < input->bytes; i++) {
     input->data.int8[i] = static_cast<int8_t>(next_pseudo_random(&r));
@@ -227,6 +697,7 @@ void tflite_randomize_input(int64_t seed) {
 }
 
 void tflite_set_grid_input(void) {
+  tflite_prepare();
   auto input = interpreter->input(0);
   size_t height = input->dims->data[1];
   size_t width = input->dims->data[2];
@@ -244,9 +715,28 @@ int8_t* tflite_get_output() { return interpreter->output(0)->data.int8; }
 float* tflite_get_output_float() { return interpreter->output(0)->data.f; }
 
 void tflite_classify() {
+  if (!tflite_prepare()) {
+    return;
+  }
+  if (first_result_pending) {
+    boot_timer_mark("set input");
+  }
+
+  // In simulation, a checkpoint may be saved here, to be continued from
+  // with a different input or trace selection.
+  if (sim_checkpoint()) {
+    if (sim_checkpoint_input_seed()) {
+      tflite_randomize_input(sim_checkpoint_input_seed());
+    }
+    if (sim_checkpoint_trace_op() >= 0) {
+      sim_trace_select_op(sim_checkpoint_trace_op());
+    }
+  }
+
   // Run the model on this input and make sure it succeeds.
-  profiler->ClearEvents();
+  profiler->ClearAll();
   perf_reset_all_counters();
+  sim_trace_arm();
 
   // perf_set_mcycle is a no-op for some boards, start and end used instead.
   uint64_t start = perf_get_mcycle64();
@@ -254,13 +744,31 @@ void tflite_classify() {
     puts("Invoke failed.");
   }
   uint64_t end = perf_get_mcycle64();
+  last_classify_cycles = end - start;
 #ifndef NPROFILE
   printf("\n");
   profiler->LogCsv();
+  profiler->LogCyclesCsv();
+  profiler->LogCfuCountersCsv();
+  profiler->LogSoftFloatCsv();
+  profiler->LogStackUsageCsv();
+  accel_coverage_print();
   perf_print_all_counters();
 #endif
   perf_print_value(end - start);  // Possible overflow is intentional here.
   printf(" cycles total\n");
+
+  if (first_result_pending) {
+    first_result_pending = false;
+    boot_timer_mark("first Invoke");
+    print_time_to_first_result();
+  }
+  print_resident_time_to_first_result();
 }
 
-int8_t* get_input() { return interpreter->input(0)->data.int8; }
+uint64_t tflite_get_classify_cycles() { return last_classify_cycles; }
+
+int8_t* get_input() {
+  tflite_prepare();
+  return interpreter->input(0)->data.int8;
+}
@@ -30,10 +30,37 @@
 // Sets up TfLite with a given model
 void tflite_load_model(const unsigned char* model_data,
                        unsigned int model_length);
+
+// Allocates tensors and prepares each op, if not yet done for the current
+// model. With LAZY_PREPARE defined, tflite_load_model() only maps the model
+// and builds the interpreter, leaving this to be called when convenient -
+// otherwise it is done on first use. Returns false if allocation fails.
+bool tflite_prepare();
+
+// Loads a model that stays resident alongside others, so that switching
+// between models does not repeat AllocateTensors(). Each resident model takes
+// arena_bytes of the tensor arena (0 for all that remains, or
+// TFLITE_RESIDENT_ARENA_FIT for just what it uses) and is selected after
+// loading. Returns false if the model does not fit.
+// tflite_load_model() unloads all resident models. Resident models are not
+// fused (see graph_rewrite.h).
+bool tflite_load_resident_model(int slot, const unsigned char* model_data,
+                                unsigned int model_length, size_t arena_bytes);
+// Sizes a resident model's arena by allocating its tensors once in all that
+// remains, then again in the bytes that used.
+#define TFLITE_RESIDENT_ARENA_FIT ((size_t)-1)
+// Makes a resident model the target of the functions below. Returns false if
+// no model is loaded in the slot.
+bool tflite_select_resident_model(int slot);
+
 void tflite_set_input_zeros(void);
 void tflite_set_input_zeros_float();
 void tflite_set_input(const void* data);
 void tflite_set_input_unsigned(const unsigned char* data);
+// Sets input from unsigned data that is factor times the input's width and
+// height, averaging each factor x factor block.
+void tflite_set_input_unsigned_downscaled(const unsigned char* data,
+                                          int factor);
 void tflite_set_input_float(const float* data);
 void tflite_randomize_input(int64_t seed);
 void tflite_set_grid_input(void);
@@ -41,6 +68,9 @@ void tflite_set_grid_input(void);
 // Run classification with data already set into input.
 void tflite_classify();
 
+// Cycles taken by the most recent tflite_classify()
+uint64_t tflite_get_classify_cycles();
+
 // Obtain the result vector
 int8_t* tflite_get_output();
 float* tflite_get_output_float();
@@ -15,6 +15,17 @@
 #include "tflite_unit_tests.h"
 
 #include <cstdio>
+#include <cstring>
+
+#include "elementwise.h"
+#include "integer_quantize.h"
+#include "playground_util/random.h"
+#include "tensorflow/lite/kernels/internal/quantization_util.h"
+#include "tensorflow/lite/kernels/internal/reference/integer_ops/add.h"
+#include "tensorflow/lite/kernels/internal/reference/dequantize.h"
+#include "tensorflow/lite/kernels/internal/reference/integer_ops/mul.h"
+#include "tensorflow/lite/kernels/internal/reference/quantize.h"
+#include "tensorflow/lite/kernels/internal/reference/requantize.h"
 
 //
 // Unit test prototypes. Because of the way these names are generated, they are
@@ -23,6 +34,168 @@
 extern int conv_test(int argc, char** argv);
 extern int depthwise_conv_test(int argc, char** argv);
 
+namespace {
+
+constexpr int kElementwiseTestSize = 1001;
+int8_t ew_input1[kElementwiseTestSize + 3];
+int8_t ew_input2[kElementwiseTestSize];
+int8_t ew_expected[kElementwiseTestSize];
+int8_t ew_output[kElementwiseTestSize + 3];
+
+int check_elementwise(const char* name, const int8_t* actual, int size) {
+  for (int i = 0; i < size; i++) {
+    if (actual[i] != ew_expected[i]) {
+      printf("  %s: FAIL at %d, got %d, expected %d\n", name, i, actual[i],
+             ew_expected[i]);
+      return 1;
+    }
+  }
+  printf("  %s: OK\n", name);
+  return 0;
+}
+
+tflite::ArithmeticParams add_params(float scale1, float scale2,
+                                    float output_scale) {
+  tflite::ArithmeticParams params = {};
+  params.input1_offset = 3;
+  params.input2_offset = -100;
+  params.output_offset = -7;
+  params.left_shift = 20;
+  const double twice_max_input_scale =
+      2 * static_cast<double>(std::max(scale1, scale2));
+  tflite::QuantizeMultiplierSmallerThanOneExp(
+      static_cast<double>(scale1) / twice_max_input_scale,
+      &params.input1_multiplier, &params.input1_shift);
+  tflite::QuantizeMultiplierSmallerThanOneExp(
+      static_cast<double>(scale2) / twice_max_input_scale,
+      &params.input2_multiplier, &params.input2_shift);
+  tflite::QuantizeMultiplierSmallerThanOneExp(
+      twice_max_input_scale /
+          ((1 << params.left_shift) * static_cast<double>(output_scale)),
+      &params.output_multiplier, &params.output_shift);
+  params.quantized_activation_min = -7;  // ReLU
+  params.quantized_activation_max = 127;
+  return params;
+}
+
+// Compares the elementwise engine with the reference kernels, including
+// running in place and on unaligned buffers.
+void elementwise_test() {
+  const int n = kElementwiseTestSize;
+  int64_t r = 1;
+  for (int i = 0; i < n; i++) {
+    ew_input1[i] = next_pseudo_random(&r);
+    ew_input2[i] = next_pseudo_random(&r);
+  }
+  int failures = 0;
+
+  // Equal scales: SWAR
+  tflite::ArithmeticParams params = add_params(0.1f, 0.1f, 0.1f);
+  for (int i = 0; i < n; i++) {
+    ew_expected[i] = tflite::reference_integer_ops::AddFunc(
+        ew_input1[i], ew_input2[i], params);
+  }
+  elementwise_add(params, ew_input1, n, ew_input2, n, ew_output);
+  failures += check_elementwise("add, equal scales", ew_output, n);
+  elementwise_add(params, ew_input1, n, ew_input2, n, ew_output + 1);
+  failures += check_elementwise("add, unaligned", ew_output + 1, n);
+
+  // Different scales: separable tables
+  params = add_params(0.1f, 0.37f, 0.21f);
+  for (int i = 0; i < n; i++) {
+    ew_expected[i] = tflite::reference_integer_ops::AddFunc(
+        ew_input1[i], ew_input2[i], params);
+  }
+  elementwise_add(params, ew_input1, n, ew_input2, n, ew_output);
+  failures += check_elementwise("add, different scales", ew_output, n);
+
+  // Single value: unary table
+  for (int i = 0; i < n; i++) {
+    ew_expected[i] = tflite::reference_integer_ops::AddFunc(
+        ew_input2[0], ew_input1[i], params);
+  }
+  elementwise_add(params, ew_input2, 1, ew_input1, n, ew_output);
+  failures += check_elementwise("add, single value", ew_output, n);
+
+  params.output_multiplier = 1518500250;
+  params.output_shift = -5;
+  for (int i = 0; i < n; i++) {
+    tflite::reference_integer_ops::MulElementwise(
+        1, params, ew_input1 + i, ew_input2, ew_expected + i);
+  }
+  elementwise_mul(params, ew_input1, n, ew_input2, 1, ew_output);
+  failures += check_elementwise("mul, single value", ew_output, n);
+
+  int8_t table[ELEMENTWISE_TABLE_SIZE];
+  const int32_t multipliers[] = {1 << 30, 1518500250};
+  const int32_t shifts[] = {1, 0};
+  for (int m = 0; m < 2; m++) {
+    tflite::reference_ops::Requantize(ew_input1, n, multipliers[m], shifts[m],
+                                      -20, 50, ew_expected);
+    elementwise_requantize_table(multipliers[m], shifts[m], -20, 50, table);
+    elementwise_requantize(multipliers[m], shifts[m], -20, 50, table,
+                           ew_input1, n, ew_input1);
+    failures += check_elementwise(
+        m == 0 ? "quantize, in place, equal scales" : "quantize, in place",
+        ew_input1, n);
+  }
+  printf("  %d failures\n", failures);
+}
+
+// Compares integer Quantize and Dequantize with the reference kernels, on
+// values either side of every quantization threshold.
+void integer_quantize_test() {
+  static float values[3 * INTEGER_QUANTIZE_NUM_THRESHOLDS];
+  static int32_t thresholds[INTEGER_QUANTIZE_NUM_THRESHOLDS];
+  static float table[INTEGER_DEQUANTIZE_TABLE_SIZE];
+  static float dequantized[2][INTEGER_DEQUANTIZE_TABLE_SIZE];
+  static int8_t quantized[2][3 * INTEGER_QUANTIZE_NUM_THRESHOLDS];
+  const int n = 3 * INTEGER_QUANTIZE_NUM_THRESHOLDS;
+  tflite::RuntimeShape shape(1, n);
+  tflite::QuantizationParams q;
+  q.zero_point = -3;
+  q.scale = 0.0237;
+  integer_quantize_thresholds(q.scale, q.zero_point, thresholds);
+  for (int i = 0; i < INTEGER_QUANTIZE_NUM_THRESHOLDS; i++) {
+    // Undo the mapping that makes float bit patterns sort as integers
+    int32_t bits = thresholds[i] ^ ((thresholds[i] >> 31) & 0x7fffffff);
+    for (int d = -1; d <= 1; d++) {
+      const int32_t neighbour = bits + (bits < 0 ? -d : d);
+      memcpy(&values[3 * i + d + 1], &neighbour, sizeof(float));
+    }
+  }
+  tflite::reference_ops::AffineQuantize(q, shape, values, shape,
+                                        quantized[0]);
+  integer_quantize(thresholds, values, n, quantized[1]);
+  int failures = 0;
+  for (int i = 0; i < n; i++) {
+    if (quantized[0][i] != quantized[1][i]) {
+      printf("  quantize: FAIL at %d\n", i);
+      failures++;
+      break;
+    }
+  }
+
+  int8_t all[INTEGER_DEQUANTIZE_TABLE_SIZE];
+  for (int i = 0; i < INTEGER_DEQUANTIZE_TABLE_SIZE; i++) {
+    all[i] = static_cast<int8_t>(i - 128);
+  }
+  tflite::RuntimeShape table_shape(1, INTEGER_DEQUANTIZE_TABLE_SIZE);
+  tflite::DequantizationParams dq = {0.0237, -3};
+  tflite::reference_ops::Dequantize(dq, table_shape, all, table_shape,
+                                    dequantized[0]);
+  integer_dequantize_table(dq.scale, dq.zero_point, table);
+  integer_dequantize(table, all, INTEGER_DEQUANTIZE_TABLE_SIZE,
+                     dequantized[1]);
+  if (memcmp(dequantized[0], dequantized[1], sizeof(dequantized[0]))) {
+    printf("  dequantize: FAIL\n");
+    failures++;
+  }
+  printf("  %d failures\n", failures);
+}
+
+}  // anonymous namespace
+
 // Run tflite unit tests
 void tflite_do_tests() {
   // conv test from conv_test.cc
@@ -31,4 +204,8 @@ void tflite_do_tests() {
   // depthwise conv test from depthwise_conv_test.cc
   puts("DEPTHWISE_CONV TEST:");
   depthwise_conv_test(0, NULL);
+  puts("ELEMENTWISE TEST:");
+  elementwise_test();
+  puts("INTEGER QUANTIZE TEST:");
+  integer_quantize_test();
 }
@@ -59,7 +59,7 @@ ACCELERATOR_CONFIGURATION_LAYOUT = [
     ('output_activation_min', signed(8)),
     #  The maximum output value
     ('output_activation_max', signed(8)),
-    # Address of start of input data, in bytes
+    # Address of start of input data, in bytes from start of input window
     ('input_base_addr', 18),
     # How many pixels in output row
     ('num_pixels_x', 9),
@@ -69,7 +69,7 @@ ACCELERATOR_CONFIGURATION_LAYOUT = [
     ('pixel_advance_y', 8),
     # The number of 8bit values in the input channel - divisible by 16
     ('input_channel_depth', unsigned_upto(Constants.MAX_CHANNEL_DEPTH)),
-    # Number of output channels - divisible by 4
+    # Number of output channels - divisible by OUTPUT_CHANNEL_GROUP
     ('output_channel_depth', unsigned_upto(Constants.MAX_CHANNEL_DEPTH)),
     # Number of 8bit output values produced. Expected to be a multiple of 16.
     ('num_output_values', 18),
@@ -125,6 +125,9 @@ class AcceleratorCore(SimpleElaboratable):
     output: Endpoint(unsigned(32)), out
       The 8 bit output values as 4 byte words. Values are produced in an
       algorithm dependent order.
+
+    running: Signal(), out
+      High from start until all output values have been produced.
     """
 
     def __init__(self, specialize_nx=False):
@@ -138,6 +141,7 @@ class AcceleratorCore(SimpleElaboratable):
         self.lram_data = [Signal(32, name=f"lram_data{i}") for i in range(4)]
         self.post_process_params = Endpoint(POST_PROCESS_PARAMS)
         self.output = Endpoint(unsigned(32))
+        self.running = Signal()
 
     def build_filter_store(self, m):
         m.submodules['filter_store'] = store = FilterStore()
@@ -165,9 +169,12 @@ class AcceleratorCore(SimpleElaboratable):
         f0 = self.create_fetcher(m, stop, 'f0', Mode0InputFetcher)
         f1 = self.create_fetcher(m, stop, 'f1', Mode1InputFetcher)
 
-        # Additional config for fetcher1
+        # Each pixel is fetched once per group of output channels
         repeats = (self.config.output_channel_depth //
                    Const(Constants.SYS_ARRAY_WIDTH))
+        m.d.comb += f0.num_repeats.eq(repeats)
+
+        # Additional config for fetcher1
         m.d.comb += [
             f1.num_pixels_x.eq(self.config.num_pixels_x),
             f1.pixel_advance_x.eq(self.config.pixel_advance_x),
@@ -239,7 +246,7 @@ class AcceleratorCore(SimpleElaboratable):
         ar = ResetInserter(self.reset)(AccumulatorReader())
         m.submodules['acc_reader'] = ar
         m.d.comb += ar.half_mode.eq(~self.config.mode)
-        for i in range(8):
+        for i in range(Constants.SYS_ARRAY_MACC_BLOCKS):
             m.d.comb += [
                 ar.accumulator[i].eq(accumulators[i]),
                 ar.accumulator_new[i].eq(accumulator_news[i]),
@@ -248,6 +255,7 @@ class AcceleratorCore(SimpleElaboratable):
         m.d.comb += connect(ar.output, al.stream_in)
         m.d.comb += al.num_allowed.eq(self.config.num_output_values)
         m.d.comb += al.start.eq(self.start)
+        m.d.comb += self.running.eq(al.running)
         return al.stream_out, al.finished
 
     def elab(self, m):
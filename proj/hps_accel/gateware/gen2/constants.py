@@ -15,9 +15,18 @@
 """Constants shared between gateware and C++"""
 
 import argparse
+import os
 import sys
 
 
+def _array_size(name, default, allowed):
+    """Reads a systolic array dimension from the environment."""
+    value = int(os.environ.get(name, default))
+    if value not in allowed:
+        raise ValueError(f"{name}={value}: must be one of {allowed}")
+    return value
+
+
 class Constants:
     ###########################################################################
     # Funct3 codes - used to route CFU to instructions
@@ -64,16 +73,31 @@ class Constants:
     # Number of items in FIFO
     REG_FIFO_ITEMS = 21
 
+    # Performance counters, counting cycles since last reset.
+    # Write any value to REG_PERF_RESET to zero all counters.
+    REG_PERF_RESET = 22
+    REG_PERF_BUSY = 23
+    REG_PERF_INPUT_STARVED = 24
+    REG_PERF_OUTPUT_BLOCKED = 25
+    REG_PERF_IDLE = 26
+
+    # CPU address of the start of the input window. REG_INPUT_BASE_ADDR is
+    # written with a CPU address, from which this value is subtracted.
+    REG_INPUT_WINDOW_BASE = 27
+
     # Maximum number of 8-bit channels per pixel
     MAX_CHANNEL_DEPTH = 512
 
-    # Height (A dimension, aka activation values, aka inputs)
-    # Must be a power of 2. Only tested with value 4
-    SYS_ARRAY_HEIGHT = 4
+    # Height (A dimension, aka activation values, aka inputs), set with
+    # HPS_SYS_ARRAY_HEIGHT in the environment. Each row takes a pixel from
+    # one of the four LRAMs, so this must be 4.
+    SYS_ARRAY_HEIGHT = _array_size('HPS_SYS_ARRAY_HEIGHT', 4, (4,))
 
-    # Width (B dimension, aka filter values) of the Systolic array
-    # Must be a power of 2. Only tested with value 2
-    SYS_ARRAY_WIDTH = 2
+    # Width (B dimension, aka filter values) of the Systolic array, set with
+    # HPS_SYS_ARRAY_WIDTH in the environment. Each column calculates one
+    # output channel. AccumulatorReader passes on one value per cycle, which
+    # keeps up with two columns but not more, so this must be 2.
+    SYS_ARRAY_WIDTH = _array_size('HPS_SYS_ARRAY_WIDTH', 2, (2,))
 
     # Total Number of MACC blocks in Systolic array
     SYS_ARRAY_MACC_BLOCKS = SYS_ARRAY_HEIGHT * SYS_ARRAY_WIDTH
@@ -81,12 +105,23 @@ class Constants:
     # Total number of separate store
     NUM_FILTER_STORES = SYS_ARRAY_WIDTH
 
+    # Output channels are calculated in groups of this many: a whole number
+    # of columns, and of the four channels in each output word
+    OUTPUT_CHANNEL_GROUP = max(4, SYS_ARRAY_WIDTH)
+
     # Depth of filter storage, per store
     FILTER_WORDS_PER_STORE = 512
 
     # Number of words in the output queue
     OUTPUT_FIFO_DEPTH = 1024
 
+    # Number of bytes of input visible to the accelerator: four LRAMs, each of
+    # 16K 32 bit words
+    INPUT_WINDOW_BYTES = 4 * 16 * 1024 * 4
+
+    # Input window base after reset - the arena origin in soc/hps_soc.py
+    INPUT_WINDOW_DEFAULT_BASE = 0x60000000
+
     # Accelerator Mode
     MODE_0 = 0  # For input layers
     MODE_1 = 1  # For other layers
@@ -106,16 +141,27 @@ def main():
         description='Write C header file with constants')
     'outfile',
     parser.add_argument('output', metavar='FILE', nargs='?',
-                        type=argparse.FileType('w'), default=sys.stdout,
                         help='Where to send output')
     args = parser.parse_args()
 
-    with args.output as f:
-        print(CC_FILE_HEADER, file=f)
-        for name, value in vars(Constants).items():
-            if not name.startswith('_'):
-                print(f"#define {name} {value}", file=f)
-        print(CC_FILE_TAIL, file=f)
+    lines = [CC_FILE_HEADER]
+    for name, value in vars(Constants).items():
+        if not name.startswith('_'):
+            lines.append(f"#define {name} {value}")
+    lines.append(CC_FILE_TAIL)
+    text = '\n'.join(lines) + '\n'
+
+    if not args.output:
+        sys.stdout.write(text)
+        return
+    # As for cfu.v, only update when changed, so that the Makefile can run
+    # this every time without causing a rebuild
+    if os.path.exists(args.output):
+        with open(args.output) as f:
+            if f.read() == text:
+                return
+    with open(args.output, 'w') as f:
+        f.write(text)
 
 
 if __name__ == "__main__":
@@ -13,7 +13,7 @@
 # limitations under the License.
 
 from amaranth import Cat, Mux, Record, Signal, signed, unsigned
-from amaranth_cfu import Cfu, InstructionBase
+from amaranth_cfu import Cfu, InstructionBase, PerfCounters
 
 from .accelerator import AcceleratorCore, ACCELERATOR_CONFIGURATION_LAYOUT
 from .constants import Constants
@@ -52,6 +52,8 @@ class GetInstruction(InstructionBase):
         The value to return for the fifo item count register.
     reg_verify_value: Signal(32), in
         The value to return for the verify register.
+    reg_perf_values: {int: Signal(32)}, in
+        Values to return for each of the performance counter registers.
 
     output_words: Endpoint(unsigned(32)), in
         Stream of output words from accelerator.
@@ -61,6 +63,12 @@ class GetInstruction(InstructionBase):
         super().__init__()
         self.reg_fifo_items_value = Signal(32)
         self.reg_verify_value = Signal(32)
+        self.reg_perf_values = {
+            reg: Signal(32, name=f"reg_perf_{reg}")
+            for reg in [Constants.REG_PERF_BUSY,
+                        Constants.REG_PERF_INPUT_STARVED,
+                        Constants.REG_PERF_OUTPUT_BLOCKED,
+                        Constants.REG_PERF_IDLE]}
         self.output_words = Endpoint(unsigned(32))
 
     def elab(self, m):
@@ -86,6 +94,10 @@ class GetInstruction(InstructionBase):
                         m.d.sync += self.done.eq(1)
                     with m.Elif(self.funct7 == Constants.REG_OUTPUT_WORD):
                         get_output()
+                    for reg, value in self.reg_perf_values.items():
+                        with m.Elif(self.funct7 == reg):
+                            m.d.sync += self.output.eq(value)
+                            m.d.sync += self.done.eq(1)
             with m.State("WAIT_OUTPUT"):
                 get_output()
 
@@ -105,9 +117,13 @@ class SetInstruction(InstructionBase):
     accelerator_reset: Signal(), out
        Toggles when reset register written
 
+    perf_reset: Signal(), out
+       Toggles when performance counter reset register written
+
     config: Record(ACCELERATOR_CONFIGURATION_LAYOUT), out
        Configuration values for accelerator core, as received
-       from set instructions.
+       from set instructions. The input base address is received as a CPU
+       address and stored relative to the input window base.
 
     filter_output: Endpoint(FILTER_WRITE_COMMAND), out
         Write command for filter store
@@ -121,6 +137,7 @@ class SetInstruction(InstructionBase):
         self.reg_verify_value = Signal(32)
         self.accelerator_start = Signal()
         self.accelerator_reset = Signal()
+        self.perf_reset = Signal()
         self.config = Record(ACCELERATOR_CONFIGURATION_LAYOUT)
         self.filter_output = Endpoint(FILTER_WRITE_COMMAND)
         self.post_process_params = Endpoint(POST_PROCESS_PARAMS)
@@ -129,12 +146,16 @@ class SetInstruction(InstructionBase):
         # Default toggles to off
         m.d.sync += self.accelerator_start.eq(0)
         m.d.sync += self.accelerator_reset.eq(0)
+        m.d.sync += self.perf_reset.eq(0)
         m.d.sync += self.filter_output.valid.eq(0)
         m.d.sync += self.post_process_params.valid.eq(0)
 
         # All sets take exactly one cycle
         m.d.sync += self.done.eq(0)
 
+        # CPU address of the first byte visible through the LRAM ports
+        window_base = Signal(32, reset=Constants.INPUT_WINDOW_DEFAULT_BASE)
+
         # Perform action
         with m.If(self.start):
             with m.Switch(self.funct7):
@@ -144,6 +165,8 @@ class SetInstruction(InstructionBase):
                     m.d.sync += self.accelerator_start.eq(1)
                 with m.Case(Constants.REG_ACCELERATOR_RESET):
                     m.d.sync += self.accelerator_reset.eq(1)
+                with m.Case(Constants.REG_PERF_RESET):
+                    m.d.sync += self.perf_reset.eq(1)
                 with m.Case(Constants.REG_FILTER_WRITE):
                     m.d.sync += [
                         self.filter_output.payload.store.eq(self.in0[16:]),
@@ -163,8 +186,11 @@ class SetInstruction(InstructionBase):
                     m.d.sync += self.config.output_activation_min.eq(self.in0s)
                 with m.Case(Constants.REG_OUTPUT_ACTIVATION_MAX):
                     m.d.sync += self.config.output_activation_max.eq(self.in0s)
+                with m.Case(Constants.REG_INPUT_WINDOW_BASE):
+                    m.d.sync += window_base.eq(self.in0)
                 with m.Case(Constants.REG_INPUT_BASE_ADDR):
-                    m.d.sync += self.config.input_base_addr.eq(self.in0)
+                    m.d.sync += self.config.input_base_addr.eq(
+                        self.in0 - window_base)
                 with m.Case(Constants.REG_NUM_PIXELS_X):
                     m.d.sync += self.config.num_pixels_x.eq(self.in0)
                 with m.Case(Constants.REG_PIXEL_ADVANCE_X):
@@ -265,6 +291,30 @@ class HpsCfu(Cfu):
         # Connect verify functionality
         m.d.comb += get.reg_verify_value.eq(set_.reg_verify_value + 1)
 
+        # Connect performance counters. The accelerator is starved of input
+        # between reset and start, while the CPU loads filters and parameters.
+        m.submodules['perf'] = perf = PerfCounters()
+        waiting_for_start = Signal()
+        with m.If(set_.accelerator_reset):
+            m.d.sync += waiting_for_start.eq(1)
+        with m.If(set_.accelerator_start):
+            m.d.sync += waiting_for_start.eq(0)
+        m.d.comb += [
+            perf.reset.eq(set_.perf_reset),
+            perf.busy.eq(core.running),
+            perf.input_starved.eq(waiting_for_start),
+            perf.output_blocked.eq(
+                core.output.valid & ~core.output.ready),
+            get.reg_perf_values[Constants.REG_PERF_BUSY].eq(
+                perf.busy_count),
+            get.reg_perf_values[Constants.REG_PERF_INPUT_STARVED].eq(
+                perf.input_starved_count),
+            get.reg_perf_values[Constants.REG_PERF_OUTPUT_BLOCKED].eq(
+                perf.output_blocked_count),
+            get.reg_perf_values[Constants.REG_PERF_IDLE].eq(
+                perf.idle_count),
+        ]
+
         return {
             Constants.INS_GET: get,
             Constants.INS_SET: set_,
@@ -56,8 +56,12 @@ class EvenPixelAddressGenerator(SimpleElaboratable):
 
     next: Signal(), in
         Indicates current address has been used. Address will be produced a
-        total of eight times each. On the eighth next toggle, a new address
-        will be available on the following cycle.
+        total of num_repeats times each. On the last of these next toggles,
+        a new address will be available on the following cycle.
+
+    num_repeats: Signal(unsigned_upto(64)), in
+        Number of times each address is used: once for each group of
+        SYS_ARRAY_WIDTH output channels. Set before start.
     """
 
     # Number of addresses to generate for each row. There 160 output pixels
@@ -72,15 +76,17 @@ class EvenPixelAddressGenerator(SimpleElaboratable):
         self.addr = Signal(18)
         self.start = Signal()
         self.next = Signal()
+        self.num_repeats = Signal(unsigned_upto(64))
 
     def elab(self, m):
         pixel_x = Signal(8)
         pixel_row_begin_addr = Signal(18)
-        next_count = Signal(3)
+        next_count = Signal.like(self.num_repeats)
 
         with m.If(self.next):
             m.d.sync += next_count.eq(next_count + 1)
-            with m.If(next_count == 7):
+            with m.If(next_count + 1 == self.num_repeats):
+                m.d.sync += next_count.eq(0)
                 last_x = pixel_x + 1 == self.NUM_ADDRESSES_X
                 with m.If(last_x):
                     m.d.sync += [
@@ -254,6 +260,10 @@ class Mode0InputFetcher(SimpleElaboratable):
     base_addr: Signal(18), in
         A base byte address, added to all results
 
+    num_repeats: Signal(unsigned_upto(64)), in
+        Number of times to fetch each pixel: the output channel depth
+        divided by SYS_ARRAY_WIDTH.
+
     ram_mux_phase: Signal(range(4)), out
         The phase provided to the RamMux
 
@@ -280,6 +290,7 @@ class Mode0InputFetcher(SimpleElaboratable):
         self.reset = Signal()
         self.start = Signal()
         self.base_addr = Signal(18)
+        self.num_repeats = Signal(unsigned_upto(64))
         self.ram_mux_phase = Signal(range(4))
         self.ram_mux_addr = [Signal(14, name=f"rm_addr{i}") for i in range(4)]
         self.ram_mux_data = [Signal(32, name=f"rm_data{i}") for i in range(4)]
@@ -292,6 +303,7 @@ class Mode0InputFetcher(SimpleElaboratable):
         m.submodules["pixel_ag"] = pixel_ag = EvenPixelAddressGenerator()
         m.d.comb += pixel_ag.base_addr.eq(self.base_addr),
         m.d.comb += pixel_ag.start.eq(self.start),
+        m.d.comb += pixel_ag.num_repeats.eq(self.num_repeats),
 
         # Generate value addresses from each pixel
         m.submodules["value_ag"] = value_ag = ValueAddressGenerator()
@@ -18,6 +18,7 @@ from amaranth_cfu import SimpleElaboratable
 from amaranth import (
     signed, unsigned, Array, Cat, Module, Mux, Record, Signal, ResetInserter
 )
+from amaranth.utils import log2_int
 
 from .constants import Constants
 from .mem import LoopingAddressGenerator
@@ -419,22 +420,30 @@ class ReadingProducer(SimpleElaboratable):
 class AccumulatorReader(SimpleElaboratable):
     """Reads accumulators, in turn as values become available.
 
-    In normal mode, reads all 8 accumulators. In half_mode, reads
-    just accumulators 0, 1, 4 and 5.
+    Accumulator i + j * a_size is from row i and column j of the systolic
+    array. In normal mode, reads all accumulators. In half_mode, reads
+    just the first half of the rows of each column: with the default 4x2
+    array, accumulators 0, 1, 4 and 5.
 
     Parameters
     ----------
 
+    a_size: int
+        Height of the systolic array. A power of 2.
+
+    b_size: int
+        Width of the systolic array. A power of 2.
+
     accumulator_shape: Shape
         Defaults to signed(32)
 
     Attributes
     ----------
 
-    accumulator: [Signal(accumulator_shape)] * 8, in
+    accumulator: [Signal(accumulator_shape)] * (a_size * b_size), in
       The value to select.
 
-    accumulator_new: [Signal()] * 8, in
+    accumulator_new: [Signal()] * (a_size * b_size), in
       Strobes when new value available in accumulator.
 
     half_mode: Signal(), in
@@ -445,10 +454,15 @@ class AccumulatorReader(SimpleElaboratable):
       are available are lost.
     """
 
-    def __init__(self, accumulator_shape=signed(32)):
+    def __init__(self, a_size=Constants.SYS_ARRAY_HEIGHT,
+                 b_size=Constants.SYS_ARRAY_WIDTH,
+                 accumulator_shape=signed(32)):
+        self._a_size = a_size
+        self._num = num = a_size * b_size
         self.accumulator = [Signal(accumulator_shape,
-                                   name=f"acc_{i}") for i in range(8)]
-        self.accumulator_new = [Signal(name=f"acc_new_{i}") for i in range(8)]
+                                   name=f"acc_{i}") for i in range(num)]
+        self.accumulator_new = [Signal(name=f"acc_new_{i}")
+                                for i in range(num)]
         self.half_mode = Signal()
         self.output = Endpoint(accumulator_shape)
 
@@ -458,19 +472,22 @@ class AccumulatorReader(SimpleElaboratable):
             m.d.sync += self.output.valid.eq(0)
 
         # Set flag to remember that value is available
-        flags = Array(Signal(name=f"flag_{i}") for i in range(8))
-        for i in range(8):
+        flags = Array(Signal(name=f"flag_{i}") for i in range(self._num))
+        for i in range(self._num):
             with m.If(self.accumulator_new[i]):
                 m.d.sync += flags[i].eq(1)
 
         # Calculate index of value to output
-        index = Signal(range(8))
-        next_index = Signal(range(8))
+        index = Signal(range(self._num))
+        next_index = Signal(range(self._num))
         with m.If(self.half_mode):
-            # counts: 0, 1, 4, 5, 0 ...
-            m.d.comb += next_index[1].eq(0)
-            m.d.comb += Cat(next_index[0], next_index[2]
-                            ).eq(Cat(index[0], index[2]) + 1)
+            # Skips the top bit of the row number. For a 4x2 array, counts
+            # 0, 1, 4, 5, 0 ...
+            top_row_bit = log2_int(self._a_size) - 1
+            others = Cat(index[:top_row_bit], index[top_row_bit + 1:])
+            m.d.comb += next_index[top_row_bit].eq(0)
+            m.d.comb += Cat(next_index[:top_row_bit],
+                            next_index[top_row_bit + 1:]).eq(others + 1)
         with m.Else():
             m.d.comb += next_index.eq(index + 1)
 
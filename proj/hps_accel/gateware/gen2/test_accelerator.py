@@ -48,16 +48,16 @@ class AcceleratorCoreTest(TestBase):
         return AcceleratorCore()
 
     def extract_filter_data(self, data):
-        # Splits filter data into "evens" and "odds" for the two columns of the
-        # systolic array.
+        # Splits filter data between the columns of the systolic array:
+        # output channel c is calculated by column c % NUM_FILTER_STORES.
         dims = data.filter_dims
         filter_data = data.filter_data
         # Group by words that are used to calculate a single output value
         num_filters_per_output = dims[1] * dims[2] * dims[3]
         filters_by_output = group(filter_data, num_filters_per_output // 4)
-        # Split into two sets of groups
-        evens, odds = filters_by_output[::2], filters_by_output[1::2]
-        return flatten(evens), flatten(odds)
+        # Split into one set of groups per store
+        stores = Constants.NUM_FILTER_STORES
+        return [flatten(filters_by_output[i::stores]) for i in range(stores)]
 
     def reset_dut(self):
         yield self.dut.reset.eq(1)
@@ -79,7 +79,8 @@ class AcceleratorCoreTest(TestBase):
         in_x_dim = data.input_dims[2]
         out_x_dim = data.output_dims[2]
         output_depth = data.output_dims[3]
-        filter_words_per_store = num_filter_values // 4 // 2
+        filter_words_per_store = (num_filter_values // 4 //
+                                  Constants.NUM_FILTER_STORES)
         yield dut.config.mode.eq(input_depth > 1)
         yield dut.config.input_offset.eq(data.input_offset)
         yield dut.config.num_filter_words.eq(filter_words_per_store)
@@ -111,7 +112,7 @@ class AcceleratorCoreTest(TestBase):
         # Load filters
         filter_data = self.extract_filter_data(data)
         for addr in range(filter_words_per_store):
-            for store in range(2):
+            for store in range(Constants.NUM_FILTER_STORES):
                 inp = dut.write_filter_input
                 yield inp.payload.store.eq(store)
                 yield inp.payload.addr.eq(addr)
@@ -88,7 +88,8 @@ class HpsCfuTest(CfuTestBase):
                     addr += 1
             addr_base += num_filter_words_per_output
 
-    def configure(self, data, output_chan_start, output_chan_count):
+    def configure(self, data, output_chan_start, output_chan_count,
+                  window_base=Constants.INPUT_WINDOW_DEFAULT_BASE):
         # Configure the accelerator
         do_set = self.do_set
         C = Constants
@@ -111,7 +112,8 @@ class HpsCfuTest(CfuTestBase):
         yield do_set(C.REG_OUTPUT_OFFSET, data.output_offset)
         yield do_set(C.REG_OUTPUT_ACTIVATION_MIN, data.output_min)
         yield do_set(C.REG_OUTPUT_ACTIVATION_MAX, data.output_max)
-        yield do_set(C.REG_INPUT_BASE_ADDR, self.RAM_BASE_ADDR)
+        yield do_set(C.REG_INPUT_WINDOW_BASE, window_base)
+        yield do_set(C.REG_INPUT_BASE_ADDR, window_base + self.RAM_BASE_ADDR)
         yield do_set(C.REG_NUM_PIXELS_X, out_x_dim)
         yield do_set(C.REG_PIXEL_ADVANCE_X, input_depth // 16)
         yield do_set(C.REG_PIXEL_ADVANCE_Y, (input_depth // 16) * in_x_dim)
@@ -150,16 +152,15 @@ class HpsCfuTest(CfuTestBase):
                 yield
         self.add_process(ram)
 
-    def test_simple_05(self):
-        """Tests a 4x4 convolution producing 16 channels per start."""
-        dut = self.dut
+    def check_simple_05(self, window_base):
+        """Runs sample_conv_05, producing 16 channels per start."""
         data = fetch_data('sample_conv_05')
 
         self.add_ram_process(data)
 
         def process():
             # Configure, start accelerator
-            yield from self.configure(data, 0, 16)
+            yield from self.configure(data, 0, 16, window_base)
             yield self.do_set(Constants.REG_ACCELERATOR_START, 0)
 
             # Collect all of the output data for all pixels
@@ -178,6 +179,14 @@ class HpsCfuTest(CfuTestBase):
 
         self.run_ops(process(), False)
 
+    def test_simple_05(self):
+        """Tests a 4x4 convolution producing 16 channels per start."""
+        self.check_simple_05(Constants.INPUT_WINDOW_DEFAULT_BASE)
+
+    def test_relocated_window(self):
+        """Tests input addresses in a window not aligned to its size."""
+        self.check_simple_05(0x40008000)
+
     def test_simple_06(self):
         """Tests a 4x4 convolution over an input layer."""
         dut = self.dut
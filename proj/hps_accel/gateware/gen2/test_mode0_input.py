@@ -33,19 +33,20 @@ class EvenPixelAddressGeneratorTest(TestBase):
     def create_dut(self):
         return EvenPixelAddressGenerator()
 
-    def test_it(self):
+    def check(self, num_repeats):
         dut = self.dut
         base_addr = 0x1234
 
         def expected_addr(n):
-            # Each value should be generated 8 times
-            index = n // 8
+            # Each value should be generated num_repeats times
+            index = n // num_repeats
             # 80 values per row
             row, col = index // 80, index % 80
             return base_addr + row * 322 * 2 + col * 4
 
         def process():
             yield dut.base_addr.eq(base_addr)
+            yield dut.num_repeats.eq(num_repeats)
             yield
             yield dut.start.eq(1)
             yield
@@ -64,6 +65,16 @@ class EvenPixelAddressGeneratorTest(TestBase):
 
         self.run_sim(process, False)
 
+    def test_it(self):
+        # 16 output channels, 2 columns
+        self.check(8)
+
+    def test_4_columns(self):
+        self.check(4)
+
+    def test_8_columns(self):
+        self.check(2)
+
 
 class ValueAddressGeneratorTest(TestBase):
     """Tests ValueAddressGenerator class."""
@@ -203,10 +214,10 @@ class Mode0InputFetcherTest(TestBase):
         self.raw_input = self.data.raw_input_data
         super().setUp()
 
-    def expected_values(self, n):
+    def expected_values(self, n, num_repeats):
         # Get values for a given pixel number
-        # Each even/odd pair should be generated 8 times
-        index = n // 16 * 2 + (n & 1)
+        # Each even/odd pair should be generated num_repeats times
+        index = n // (2 * num_repeats) * 2 + (n & 1)
         # 160 values per row
         row, col = index // 160, index % 160
         addr = row * 322 * 2 + col * 2
@@ -215,12 +226,13 @@ class Mode0InputFetcherTest(TestBase):
             for i in range(addr, addr + 4 * 322, 322)
         ]
 
-    def test_it(self):
+    def check(self, num_repeats):
         dut = self.dut
         data = self.data
 
         def process():
             yield dut.base_addr.eq(self.BASE_ADDR)
+            yield dut.num_repeats.eq(num_repeats)
             yield
             # Reset, let it run for a bit, then toggle start high to begin
             yield dut.reset.eq(1)
@@ -236,7 +248,7 @@ class Mode0InputFetcherTest(TestBase):
             # For each of the two outputs, capture values between first and last
             # Number of pixels of output we want to capture
             # Test with 3 rows
-            num_pixels = 3 * data.output_dims[2] * 8
+            num_pixels = 3 * data.output_dims[2] * num_repeats
             actual = [[], []]
             pixel = 0
             cycle = 0
@@ -252,7 +264,7 @@ class Mode0InputFetcherTest(TestBase):
                         actual[i] = []
                     actual[i].append((yield dut.data_out[i]))
                     if cycle == last_seen + i:
-                        expected = self.expected_values(pixel)
+                        expected = self.expected_values(pixel, num_repeats)
                         self.assertEqual(
                             actual[i], expected, msg=f"differ at pixel {pixel}")
                         pixel += 1
@@ -260,3 +272,10 @@ class Mode0InputFetcherTest(TestBase):
                 yield
 
         self.run_sim(process, False)
+
+    def test_it(self):
+        # 16 output channels, 2 columns
+        self.check(8)
+
+    def test_8_columns(self):
+        self.check(2)
@@ -470,14 +470,18 @@ class ReadingProducerTest(TestBase):
 class AccumulatorReaderTest(TestBase):
     """Tests the AccumulatorReader class."""
 
+    A_SIZE = 4
+    B_SIZE = 2
+
     def create_dut(self):
-        return AccumulatorReader()
+        return AccumulatorReader(self.A_SIZE, self.B_SIZE)
 
     def set_accumulators(self, values, cycles):
         """Set inputs in a manner approximating systolic array output."""
-        # Order is cycle number when accumulator value will be produced
-        order = [0, 1, 2, 3, 1, 2, 3, 4]
-        size = 8
+        # Order is cycle number when accumulator value will be produced: the
+        # row number plus the column number
+        order = [i + j for j in range(self.B_SIZE) for i in range(self.A_SIZE)]
+        size = self.A_SIZE * self.B_SIZE
         groups = [values[i:i + size] for i in range(0, len(values), size)]
 
         # Send each group over a number of cycles
@@ -507,7 +511,7 @@ class AccumulatorReaderTest(TestBase):
             yield
 
     def test_full_read(self):
-        data = list(range(100, 100 + 10 * 8))
+        data = list(range(100, 100 + 10 * self.A_SIZE * self.B_SIZE))
 
         def set_values():
             yield from self.set_accumulators(data, 24)
@@ -518,8 +522,9 @@ class AccumulatorReaderTest(TestBase):
         self.run_sim(process, False)
 
     def test_half_read(self):
-        all_data = list(range(100, 100 + 10 * 8))
-        half_data = [d for i, d in enumerate(all_data) if i % 4 in [0, 1]]
+        all_data = list(range(100, 100 + 10 * self.A_SIZE * self.B_SIZE))
+        half_data = [d for i, d in enumerate(all_data)
+                     if i % self.A_SIZE < self.A_SIZE // 2]
 
         def set_values():
             # In half mode, set all values over just 4 cycles
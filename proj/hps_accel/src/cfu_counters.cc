@@ -0,0 +1,46 @@
+/*
+ * Copyright 2021 The CFU-Playground Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "cfu_counters.h"
+
+#include "hps_cfu.h"
+
+// Only gen2 gateware has performance counters
+#if GATEWARE_GEN == 2
+
+int cfu_counters_supported() { return 1; }
+
+void cfu_counters_reset() { cfu_set(REG_PERF_RESET, 0); }
+
+void cfu_counters_read(struct CfuCounters* counters) {
+  counters->busy = cfu_get(REG_PERF_BUSY);
+  counters->input_starved = cfu_get(REG_PERF_INPUT_STARVED);
+  counters->output_blocked = cfu_get(REG_PERF_OUTPUT_BLOCKED);
+  counters->idle = cfu_get(REG_PERF_IDLE);
+}
+
+#else
+
+int cfu_counters_supported() { return 0; }
+void cfu_counters_reset() {}
+void cfu_counters_read(struct CfuCounters* counters) {
+  counters->busy = 0;
+  counters->input_starved = 0;
+  counters->output_blocked = 0;
+  counters->idle = 0;
+}
+
+#endif  // GATEWARE_GEN
@@ -18,12 +18,15 @@
 
 #include <cstdio>
 
+#include "perf.h"
 #include "playground_util/dump.h"
 #include "tensorflow/lite/kernels/internal/reference/integer_ops/conv.h"
 #include "tflite.h"
 
-void test_conv2d(const Conv2DData* data) {
-  printf("Testing Conv2D %s\n", data->name);
+namespace {
+
+// Runs ConvPerChannel on the layer, returning the output
+int8_t* run_conv2d(const Conv2DData* data) {
   // Copy input arena
   int8_t* arena_input = reinterpret_cast<int8_t*>(tflite_tensor_arena);
   auto input_shape =
@@ -46,6 +49,16 @@ void test_conv2d(const Conv2DData* data) {
       *(reinterpret_cast<const tflite::RuntimeShape*>(data->bias_shape)),
       reinterpret_cast<const int32_t*>(data->bias_data), output_shape,
       arena_output);
+  return arena_output;
+}
+
+};  // anonymous namespace
+
+void test_conv2d(const Conv2DData* data) {
+  printf("Testing Conv2D %s\n", data->name);
+  int8_t* arena_output = run_conv2d(data);
+  const tflite::RuntimeShape& output_shape =
+      *(reinterpret_cast<const tflite::RuntimeShape*>(data->output_shape));
 
   // Check for differences with output
   int diff_count = 0;
@@ -73,3 +86,20 @@ void test_conv2d(const Conv2DData* data) {
     dump_hex(expected_words + first_diff, 16);
   }
 }
+
+void benchmark_conv2d(const Conv2DData* data) {
+  const tflite::RuntimeShape& filter_shape =
+      *(reinterpret_cast<const tflite::RuntimeShape*>(data->filter_shape));
+  const tflite::RuntimeShape& output_shape =
+      *(reinterpret_cast<const tflite::RuntimeShape*>(data->output_shape));
+  // Each output value takes one MACC per filter value for its channel
+  uint32_t maccs = output_shape.FlatSize() * filter_shape.Dims(1) *
+                   filter_shape.Dims(2) * filter_shape.Dims(3);
+
+  uint32_t start = perf_get_mcycle();
+  run_conv2d(data);
+  uint32_t cycles = perf_get_mcycle() - start;
+  uint32_t hundredths = static_cast<uint64_t>(maccs) * 100 / cycles;
+  printf("%s: %lu cycles, %lu MACCs, %lu.%02lu MACCs/cycle\n", data->name,
+         cycles, maccs, hundredths / 100, hundredths % 100);
+}
@@ -39,4 +39,8 @@ struct Conv2DData {
 // Tests Conv2D with the data in the given structure
 void test_conv2d(const Conv2DData* data);
 
+// Times Conv2D with the data in the given structure, printing cycles and
+// multiply-accumulates per cycle
+void benchmark_conv2d(const Conv2DData* data);
+
 #endif  // _CONV2D_CALL_H
\ No newline at end of file
@@ -0,0 +1,198 @@
+/*
+ * Copyright 2021 The CFU-Playground Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "conv_select.h"
+
+#include <cstdio>
+
+#include "accel_coverage.h"
+#include "kernel_select.h"
+#include "tensorflow/lite/kernels/internal/reference/integer_ops/conv.h"
+#include "tensorflow/lite/kernels/kernel_util.h"
+#include "tensorflow/lite/micro/kernels/conv.h"
+#include "tensorflow/lite/micro/kernels/kernel_util.h"
+
+namespace {
+
+using tflite::micro::GetEvalInput;
+using tflite::micro::GetEvalOutput;
+using tflite::micro::GetTensorData;
+using tflite::micro::GetTensorShape;
+
+// Rough cycles per multiply-accumulate, for the estimates
+constexpr uint32_t kReferenceCyclesPerMac = 8;
+constexpr uint32_t kAccelMacsPerCycle = 16;
+
+uint32_t Saturate(uint64_t value) {
+  return value > UINT32_MAX ? UINT32_MAX : value;
+}
+
+// Multiply-accumulates: one per output value and filter value per output
+// channel
+uint32_t Macs(const ConvSelectArgs& args) {
+  return Saturate(static_cast<uint64_t>(args.output_shape.FlatSize()) *
+                  args.filter_shape.FlatSize() / args.filter_shape.Dims(0));
+}
+
+// Calls fn with the int8 arguments of ConvPerChannel for the node. The
+// node's user data begins with its OpDataConv.
+template <typename Fn>
+TfLiteStatus WithConvArgs(TfLiteContext* context, TfLiteNode* node, Fn fn) {
+  const TfLiteEvalTensor* input =
+      GetEvalInput(context, node, tflite::kConvInputTensor);
+  const TfLiteEvalTensor* filter =
+      GetEvalInput(context, node, tflite::kConvWeightsTensor);
+  const TfLiteEvalTensor* bias =
+      (tflite::NumInputs(node) == 3)
+          ? GetEvalInput(context, node, tflite::kConvBiasTensor)
+          : nullptr;
+  TfLiteEvalTensor* output =
+      GetEvalOutput(context, node, tflite::kConvOutputTensor);
+  const auto& params =
+      *(reinterpret_cast<TfLiteConvParams*>(node->builtin_data));
+  const auto& data = *(static_cast<const tflite::OpDataConv*>(node->user_data));
+
+  fn(tflite::ConvParamsQuantized(params, data),
+     data.per_channel_output_multiplier, data.per_channel_output_shift,
+     GetTensorShape(input), GetTensorData<int8_t>(input),
+     GetTensorShape(filter), GetTensorData<int8_t>(filter),
+     GetTensorShape(bias), GetTensorData<int32_t>(bias),
+     GetTensorShape(output), GetTensorData<int8_t>(output));
+  return kTfLiteOk;
+}
+
+void RunReference(const tflite::ConvParams& params,
+                  const int32_t* output_multiplier, const int32_t* output_shift,
+                  const tflite::RuntimeShape& input_shape,
+                  const int8_t* input_data,
+                  const tflite::RuntimeShape& filter_shape,
+                  const int8_t* filter_data,
+                  const tflite::RuntimeShape& bias_shape,
+                  const int32_t* bias_data,
+                  const tflite::RuntimeShape& output_shape,
+                  int8_t* output_data) {
+  tflite::reference_integer_ops::UnacceleratedConvPerChannel(
+      params, output_multiplier, output_shift, input_shape, input_data,
+      filter_shape, filter_data, bias_shape, bias_data, output_shape,
+      output_data);
+}
+
+uint32_t ReferenceCost(const void* description) {
+  const auto& args = *static_cast<const ConvSelectArgs*>(description);
+  return Saturate(static_cast<uint64_t>(Macs(args)) * kReferenceCyclesPerMac);
+}
+
+#ifdef ACCEL_CONV
+// Runs the reference kernel as the fallback from accel_4x4, for the
+// coverage report. The reason was found at Prepare, so is found again.
+void RunFallback(const tflite::ConvParams& params,
+                 const int32_t* output_multiplier, const int32_t* output_shift,
+                 const tflite::RuntimeShape& input_shape,
+                 const int8_t* input_data,
+                 const tflite::RuntimeShape& filter_shape,
+                 const int8_t* filter_data,
+                 const tflite::RuntimeShape& bias_shape,
+                 const int32_t* bias_data,
+                 const tflite::RuntimeShape& output_shape,
+                 int8_t* output_data) {
+#ifdef SHOW_ACCEL_COVERAGE
+  if (tflite::reference_integer_ops::CanAccelerateConv4x4Shape(
+          params, input_shape, filter_shape, output_shape, bias_data)) {
+    accel_coverage_reject("kernel choice");
+  }
+#endif
+  AccelCoverageFallback fallback;
+  RunReference(params, output_multiplier, output_shift, input_shape,
+               input_data, filter_shape, filter_data, bias_shape, bias_data,
+               output_shape, output_data);
+}
+#endif  // ACCEL_CONV
+
+TfLiteStatus ReferenceRun(TfLiteContext* context, TfLiteNode* node) {
+#ifdef ACCEL_CONV
+  return WithConvArgs(context, node, RunFallback);
+#else
+  return WithConvArgs(context, node, RunReference);
+#endif
+}
+
+const KernelCandidate reference = {
+    "reference",
+    nullptr,
+    ReferenceCost,
+    ReferenceRun,
+};
+
+#ifdef ACCEL_CONV
+void RunAccel4x4(const tflite::ConvParams& params,
+                 const int32_t* output_multiplier, const int32_t* output_shift,
+                 const tflite::RuntimeShape& input_shape,
+                 const int8_t* input_data,
+                 const tflite::RuntimeShape& filter_shape,
+                 const int8_t* filter_data,
+                 const tflite::RuntimeShape& bias_shape,
+                 const int32_t* bias_data,
+                 const tflite::RuntimeShape& output_shape,
+                 int8_t* output_data) {
+  // Where the input is placed is known only now
+  if (!tflite::reference_integer_ops::CanAccelerateConv4x4Input(input_shape,
+                                                                input_data)) {
+    printf("X");
+    AccelCoverageFallback fallback;
+    RunReference(params, output_multiplier, output_shift, input_shape,
+                 input_data, filter_shape, filter_data, bias_shape, bias_data,
+                 output_shape, output_data);
+    return;
+  }
+  accel_coverage_accelerated();
+  tflite::reference_integer_ops::ConvPerChannel4x4(
+      params, output_multiplier, output_shift, input_shape, input_data,
+      filter_shape, filter_data, bias_shape, bias_data, output_shape,
+      output_data);
+}
+
+bool Accel4x4CanRun(const void* description) {
+  const auto& args = *static_cast<const ConvSelectArgs*>(description);
+  return tflite::reference_integer_ops::CanAccelerateConv4x4Shape(
+      args.params, args.input_shape, args.filter_shape, args.output_shape,
+      args.bias_data);
+}
+
+uint32_t Accel4x4Cost(const void* description) {
+  const auto& args = *static_cast<const ConvSelectArgs*>(description);
+  return Macs(args) / kAccelMacsPerCycle;
+}
+
+TfLiteStatus Accel4x4Run(TfLiteContext* context, TfLiteNode* node) {
+  return WithConvArgs(context, node, RunAccel4x4);
+}
+
+const KernelCandidate accel_4x4 = {
+    "accel_4x4",
+    Accel4x4CanRun,
+    Accel4x4Cost,
+    Accel4x4Run,
+};
+#endif  // ACCEL_CONV
+
+};  // anonymous namespace
+
+void conv_select_register() {
+#ifdef ACCEL_CONV
+  kernel_select_register("CONV_2D", &accel_4x4);
+#endif
+  kernel_select_register("CONV_2D", &reference);
+}
@@ -0,0 +1,37 @@
+/*
+ * Copyright 2021 The CFU-Playground Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _CONV_SELECT_H
+#define _CONV_SELECT_H
+
+#include "tensorflow/lite/kernels/internal/types.h"
+
+// Candidate implementations of CONV_2D, chosen between at Prepare by
+// kernel_select (see kernel_select.h)
+
+// The description of a CONV_2D node passed to kernel_select_choose()
+struct ConvSelectArgs {
+  tflite::ConvParams params;
+  tflite::RuntimeShape input_shape;
+  tflite::RuntimeShape filter_shape;
+  tflite::RuntimeShape output_shape;
+  const int32_t* bias_data;
+};
+
+// Registers the CONV_2D candidates. Called from tflite_register_kernels().
+void conv_select_register();
+
+#endif  // _CONV_SELECT_H
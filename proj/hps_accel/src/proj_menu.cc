@@ -29,6 +29,7 @@
 #include "conv2d_call.h"
 #include "fixedpoint/fixedpoint.h"
 #include "hps_cfu.h"
+#include "kernel_select.h"
 #include "menu.h"
 #include "playground_util/random.h"
 
@@ -77,6 +78,28 @@ void do_test_layer_04(void) { test_conv2d(&conv2d_layer_04_data); }
 void do_test_layer_05(void) { test_conv2d(&conv2d_layer_05_data); }
 void do_test_layer_06(void) { test_conv2d(&conv2d_layer_06_data); }
 
+// Runs each layer on the accelerator, to compare systolic array sizes
+void do_benchmark_layers(void) {
+#if GATEWARE_GEN == 2
+  printf("Systolic array %dx%d\n", SYS_ARRAY_HEIGHT, SYS_ARRAY_WIDTH);
+#endif
+  benchmark_conv2d(&conv2d_layer_00_data);
+  benchmark_conv2d(&conv2d_layer_01_data);
+  benchmark_conv2d(&conv2d_layer_20_data);
+  benchmark_conv2d(&conv2d_layer_23_data);
+  benchmark_conv2d(&conv2d_layer_04_data);
+  benchmark_conv2d(&conv2d_layer_05_data);
+  benchmark_conv2d(&conv2d_layer_06_data);
+}
+
+void do_print_kernel_choices(void) { kernel_select_print_report(); }
+
+// Takes effect for nodes not yet run since the model was loaded
+void do_toggle_autotune(void) {
+  kernel_select_set_autotune(!kernel_select_autotune());
+  printf("Kernel autotune %s\n", kernel_select_autotune() ? "on" : "off");
+}
+
 struct Menu MENU = {
     "Project Menu",
     "project",
@@ -95,6 +118,9 @@ struct Menu MENU = {
         MENU_ITEM('4', "test layer 04", do_test_layer_04),
         MENU_ITEM('5', "test layer 05", do_test_layer_05),
         MENU_ITEM('6', "test layer 06", do_test_layer_06),
+        MENU_ITEM('b', "Benchmark layers", do_benchmark_layers),
+        MENU_ITEM('k', "print Kernel choices", do_print_kernel_choices),
+        MENU_ITEM('t', "toggle kernel auTotune", do_toggle_autotune),
         MENU_END,
     },
 };
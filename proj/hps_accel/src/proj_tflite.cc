@@ -0,0 +1,28 @@
+/*
+ * Copyright 2021 The CFU-Playground Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "proj_tflite.h"
+
+#include "conv_select.h"
+
+void tflite_preload(const unsigned char* model_data, unsigned int model_length) {}
+void tflite_postload() {}
+void tflite_register_fusions() {}
+void tflite_register_kernels() { conv_select_register(); }
+bool tflite_tensor_placement(const tflite::Model* model, int tensor,
+                             TensorPlacement* placement) {
+  return false;
+}
@@ -18,6 +18,7 @@ limitations under the License.
 #include <cstdio>
 #include <limits>
 
+#include "accel_coverage.h"
 #include "playground_util/dump.h"
 #include "playground_util/murmurhash.h"
 #include "playground_util/print_params.h"
@@ -209,8 +210,9 @@ inline void ConvPerChannel(
 
   bool accelerated = false;
 #ifdef ACCEL_CONV
-  if (CanAccelerateConv4x4(params, input_shape, filter_shape, output_shape,
-                           bias_data)) {
+  if (CanAccelerateConv4x4(params, input_shape, input_data, filter_shape,
+                           output_shape, bias_data)) {
+    accel_coverage_accelerated();
     ConvPerChannel4x4(params, output_multiplier, output_shift, input_shape,
                       input_data, filter_shape, filter_data, bias_shape,
                       bias_data, output_shape, output_data);
@@ -220,6 +222,9 @@ inline void ConvPerChannel(
 
   if (!accelerated) {
     printf("X");
+#ifdef ACCEL_CONV
+    AccelCoverageFallback fallback;
+#endif
     UnacceleratedConvPerChannel(params, output_multiplier, output_shift,
                                 input_shape, input_data, filter_shape,
                                 filter_data, bias_shape, bias_data,
@@ -19,6 +19,7 @@
 
 #if GATEWARE_GEN == 1
 
+#include "accel_coverage.h"
 #include "blocks.h"
 #include "cfu.h"
 #include "gateware_constants.h"
@@ -31,20 +32,48 @@ namespace reference_integer_ops {
 
 bool CanAccelerateConv4x4(const ConvParams& params,
                           const RuntimeShape& input_shape,
+                          const int8_t* input_data,
                           const RuntimeShape& filter_shape,
                           const RuntimeShape& output_shape,
                           const int32_t* bias_data) {
+  return CanAccelerateConv4x4Input(input_shape, input_data) &&
+         CanAccelerateConv4x4Shape(params, input_shape, filter_shape,
+                                   output_shape, bias_data);
+}
+
+// Gen 1 reads the input through the CPU, wherever it is
+bool CanAccelerateConv4x4Input(const RuntimeShape& input_shape,
+                               const int8_t* input_data) {
+  return true;
+}
+
+bool CanAccelerateConv4x4Shape(const ConvParams& params,
+                               const RuntimeShape& input_shape,
+                               const RuntimeShape& filter_shape,
+                               const RuntimeShape& output_shape,
+                               const int32_t* bias_data) {
   const int input_depth = MatchingDim(input_shape, 3, filter_shape, 3);
   const int filter_height = filter_shape.Dims(1);
   const int filter_width = filter_shape.Dims(2);
   const int dilation_width_factor = params.dilation_width_factor;
   const int dilation_height_factor = params.dilation_height_factor;
   const int batches = MatchingDim(input_shape, 0, output_shape, 0);
- 
-  return params.padding_type == PaddingType::kValid &&
-         (input_depth == 1 || input_depth % 4 == 0) && filter_width == 4 &&
-         filter_height == 4 && dilation_width_factor == 1 &&
-         dilation_height_factor == 1 && batches == 1 && bias_data != NULL;
+
+  if (params.padding_type != PaddingType::kValid) {
+    return accel_coverage_reject("padding type");
+  }
+  if (input_depth != 1 && input_depth % 4 != 0) {
+    return accel_coverage_reject("input depth multiple");
+  }
+  if (filter_width != 4 || filter_height != 4) {
+    return accel_coverage_reject("filter size");
+  }
+  if (dilation_width_factor != 1 || dilation_height_factor != 1) {
+    return accel_coverage_reject("dilation");
+  }
+  if (batches != 1) return accel_coverage_reject("batches");
+  if (bias_data == NULL) return accel_coverage_reject("no bias");
+  return true;
 }
 
 void ConvPerChannel4x4(const ConvParams& params,
@@ -17,9 +17,13 @@
 
 #include "tensorflow/lite/kernels/internal/reference/integer_ops/conv_accel_gen_2.h"
 
+#include <generated/mem.h>
+#include <generated/soc.h>
+
 #include <algorithm>
 #include <cstdio>
 
+#include "accel_coverage.h"
 #include "gateware_constants.h"
 #include "hps_cfu.h"
 #include "tensorflow/lite/kernels/internal/common.h"
@@ -31,6 +35,26 @@ namespace reference_integer_ops {
 
 namespace {
 
+// The accelerator fetches input through its own ports on the arena LRAMs. It
+// is given CPU addresses and subtracts the window base, so the arena may be
+// placed anywhere. Anything outside the window cannot be seen.
+#ifdef CONFIG_SOC_SEPARATE_ARENA
+constexpr uint32_t kInputWindowBase = ARENA_BASE;
+constexpr uint32_t kInputWindowBytes =
+    ARENA_SIZE < INPUT_WINDOW_BYTES ? ARENA_SIZE : INPUT_WINDOW_BYTES;
+#else
+constexpr uint32_t kInputWindowBase = INPUT_WINDOW_DEFAULT_BASE;
+constexpr uint32_t kInputWindowBytes = INPUT_WINDOW_BYTES;
+#endif
+
+// Whether all of the input is visible to the accelerator
+bool IsInInputWindow(const int8_t* input_data, int input_bytes) {
+  const uint32_t offset =
+      reinterpret_cast<uint32_t>(input_data) - kInputWindowBase;
+  return offset < kInputWindowBytes &&
+         static_cast<uint32_t>(input_bytes) <= kInputWindowBytes - offset;
+}
+
 // Loads process parameters into the CFU
 void LoadPostProcessParameters(int channel_start, int num_channels,
                                const int32_t* bias_data,
@@ -44,7 +68,8 @@ void LoadPostProcessParameters(int channel_start, int num_channels,
   }
 }
 
-// Loads filter parameters, correctly split between the two stores
+// Loads filter parameters, correctly split between the stores, one for each
+// column of the systolic array
 void LoadFilterData(int channel_start, int num_channels,
                     const RuntimeShape& filter_shape,
                     const uint32_t* data_base) {
@@ -54,8 +79,9 @@ void LoadFilterData(int channel_start, int num_channels,
       data_base + channel_start * num_filter_words_per_output;
 
   size_t addr_base = 0;
-  for (int i = channel_start; i < channel_start + num_channels; i += 2) {
-    for (int store = 0; store < 2; store++) {
+  for (int i = channel_start; i < channel_start + num_channels;
+       i += NUM_FILTER_STORES) {
+    for (int store = 0; store < NUM_FILTER_STORES; store++) {
       uint32_t addr = addr_base;
       for (int j = 0; j < num_filter_words_per_output; j++) {
         uint32_t data = *filter_data++;
@@ -84,11 +110,11 @@ void ConvPerChannel4x4Mode0(
 
   // Filter words required to calculate each tranche
   const int num_filter_words = filter_shape.FlatSize() / 4;  // 64
-  const int filter_words_per_channel = num_filter_words / 2;
+  const int filter_words_per_store = num_filter_words / NUM_FILTER_STORES;
 
   // Configure
   cfu_set(REG_MODE, MODE_0);
-  cfu_set(REG_NUM_FILTER_WORDS, filter_words_per_channel);
+  cfu_set(REG_NUM_FILTER_WORDS, filter_words_per_store);
   cfu_set(REG_OUTPUT_CHANNEL_DEPTH, output_depth);
 
   // Reset to ensure important state is initialized
@@ -98,7 +124,7 @@ void ConvPerChannel4x4Mode0(
   LoadFilterData(0, output_depth, filter_shape,
                  reinterpret_cast<const uint32_t*>(filter_data));
 
-  uint32_t input_base_addr = reinterpret_cast<uint32_t>(input_data) & 0x3ffff;
+  uint32_t input_base_addr = reinterpret_cast<uint32_t>(input_data);
   uint32_t* output_words = reinterpret_cast<uint32_t*>(output_data);
 
   // Process small number of rowsat a time so as not to overflow input buffer
@@ -111,16 +137,18 @@ void ConvPerChannel4x4Mode0(
     // Start Accelerator
     cfu_set(REG_ACCELERATOR_START, 0);
 
-    // Collect data, two pixels at a time
+    // Collect data, half of the array height in pixels at a time
+    const int pixels_per_group = SYS_ARRAY_HEIGHT / 2;
     const int num_pixels = 160 * num_rows;
-    for (int pixel = 0; pixel < num_pixels; pixel += 2) {
+    for (int pixel = 0; pixel < num_pixels; pixel += pixels_per_group) {
       uint32_t* p = output_words;
       for (int c = 0; c < output_depth; c += 4) {
-        *p = cfu_get(REG_OUTPUT_WORD);
-        *(p + words_per_pixel) = cfu_get(REG_OUTPUT_WORD);
+        for (int i = 0; i < pixels_per_group; i++) {
+          *(p + i * words_per_pixel) = cfu_get(REG_OUTPUT_WORD);
+        }
         p++;
       }
-      output_words += 2 * words_per_pixel;
+      output_words += pixels_per_group * words_per_pixel;
     }
 
     // advance num_row * 2 (because input is stride 2)
@@ -138,23 +166,23 @@ inline void CollectValue(uint32_t*& p, int advance, bool write) {
   p += advance;
 }
 
-// Collects output from the accelerator into the output area for groups of four
-// pixels. Collects num_channels of data per pixel.
+// Collects output from the accelerator into the output area for groups of
+// SYS_ARRAY_HEIGHT pixels. Collects num_channels of data per pixel.
 void CollectOutput(const int start_channel, const int num_channels,
                    uint32_t* output, const int num_pixels, const int depth) {
   const int num_words_per_pixel = depth / 4;
 
   // Find first output location
   uint32_t* p_base = output + start_channel / 4;
-  for (int pixel = 0; pixel < num_pixels; pixel += 4) {
+  for (int pixel = 0; pixel < num_pixels; pixel += SYS_ARRAY_HEIGHT) {
     for (int c = 0; c < num_channels; c += 4) {
       uint32_t* p = p_base + c / 4;
       CollectValue(p, num_words_per_pixel, true);
-      CollectValue(p, num_words_per_pixel, pixel + 1 < num_pixels);
-      CollectValue(p, num_words_per_pixel, pixel + 2 < num_pixels);
-      CollectValue(p, num_words_per_pixel, pixel + 3 < num_pixels);
+      for (int i = 1; i < SYS_ARRAY_HEIGHT; i++) {
+        CollectValue(p, num_words_per_pixel, pixel + i < num_pixels);
+      }
     }
-    p_base += num_words_per_pixel * 4;
+    p_base += num_words_per_pixel * SYS_ARRAY_HEIGHT;
   }
 }
 
@@ -178,18 +206,18 @@ void ConvPerChannel4x4Mode1(
   // Filter words required to calculate each tranche
   const int filter_words_per_channel =
       filter_shape.Dims(1) * filter_shape.Dims(2) * filter_shape.Dims(3) / 4;
-  const int filter_words_per_four_channels = filter_words_per_channel * 4;
+  const int filter_words_per_channel_group =
+      filter_words_per_channel * OUTPUT_CHANNEL_GROUP;
 
-  const int max_channels_per_tranche = FILTER_WORDS_PER_STORE *
-                                       NUM_FILTER_STORES /
-                                       filter_words_per_four_channels * 4;
+  const int max_channels_per_tranche =
+      FILTER_WORDS_PER_STORE * NUM_FILTER_STORES /
+      filter_words_per_channel_group * OUTPUT_CHANNEL_GROUP;
   // Configure static values
   cfu_set(REG_MODE, MODE_1);
   cfu_set(REG_NUM_PIXELS_X, output_width);
   cfu_set(REG_PIXEL_ADVANCE_X, input_depth / 16);
   cfu_set(REG_PIXEL_ADVANCE_Y, (input_depth / 16) * input_width);
-  cfu_set(REG_INPUT_BASE_ADDR,
-          reinterpret_cast<uint32_t>(input_data) & 0x3ffff);
+  cfu_set(REG_INPUT_BASE_ADDR, reinterpret_cast<uint32_t>(input_data));
 
   for (int channel = 0; channel < output_depth;
        channel += max_channels_per_tranche) {
@@ -198,12 +226,14 @@ void ConvPerChannel4x4Mode1(
     const int tranche_filter_words =
         filter_words_per_channel * tranche_channels;
 
-    // Round up number of output values to multiple of 4 pixels
+    // Round up number of output values to multiple of SYS_ARRAY_HEIGHT
+    // pixels
     const int tranche_output_values =
-        (num_output_pixels + 3) / 4 * 4 * tranche_channels;
+        (num_output_pixels + SYS_ARRAY_HEIGHT - 1) / SYS_ARRAY_HEIGHT *
+        SYS_ARRAY_HEIGHT * tranche_channels;
 
     // Configure
-    cfu_set(REG_NUM_FILTER_WORDS, tranche_filter_words / 2);
+    cfu_set(REG_NUM_FILTER_WORDS, tranche_filter_words / NUM_FILTER_STORES);
     cfu_set(REG_NUM_OUTPUT_VALUES, tranche_output_values);
     cfu_set(REG_OUTPUT_CHANNEL_DEPTH, tranche_channels);
 
@@ -229,16 +259,38 @@ void ConvPerChannel4x4Mode1(
 
 bool CanAccelerateConv4x4(const ConvParams& params,
                           const RuntimeShape& input_shape,
+                          const int8_t* input_data,
                           const RuntimeShape& filter_shape,
                           const RuntimeShape& output_shape,
                           const int32_t* bias_data) {
+  return CanAccelerateConv4x4Input(input_shape, input_data) &&
+         CanAccelerateConv4x4Shape(params, input_shape, filter_shape,
+                                   output_shape, bias_data);
+}
+
+bool CanAccelerateConv4x4Input(const RuntimeShape& input_shape,
+                               const int8_t* input_data) {
+  // Input must be visible to the accelerator
+  if (!IsInInputWindow(input_data, input_shape.FlatSize())) {
+    return accel_coverage_reject("input window");
+  }
+  return true;
+}
+
+bool CanAccelerateConv4x4Shape(const ConvParams& params,
+                               const RuntimeShape& input_shape,
+                               const RuntimeShape& filter_shape,
+                               const RuntimeShape& output_shape,
+                               const int32_t* bias_data) {
   // No padding allowed
-  if (params.padding_type != PaddingType::kValid) return false;
+  if (params.padding_type != PaddingType::kValid) {
+    return accel_coverage_reject("padding type");
+  }
 
   // Must have bias_data and single batch
-  if (!bias_data) return false;
+  if (!bias_data) return accel_coverage_reject("no bias");
   const int batches = MatchingDim(input_shape, 0, output_shape, 0);
-  if (batches != 1) return false;
+  if (batches != 1) return accel_coverage_reject("batches");
 
   const int input_depth = input_shape.Dims(3);
   const int output_depth = output_shape.Dims(3);
@@ -246,36 +298,51 @@ bool CanAccelerateConv4x4(const ConvParams& params,
   const int stride_height = params.stride_height;
   if (input_depth == 1) {
     // For input layers, stride must be two
-    if (stride_height != 2 || stride_width != 2) return false;
+    if (stride_height != 2 || stride_width != 2) {
+      return accel_coverage_reject("input layer stride");
+    }
     // Input and output width are fixed
-    if (input_shape.Dims(2) != 322 || output_shape.Dims(2) != 160) return false;
+    if (input_shape.Dims(2) != 322 || output_shape.Dims(2) != 160) {
+      return accel_coverage_reject("input layer width");
+    }
     // Output depth is fixed
-    if (output_depth != 16) return false;
+    if (output_depth != 16) return accel_coverage_reject("input layer depth");
   } else {
     // For all other layers, stride must be 1
-    if (stride_height != 1 || stride_width != 1) return false;
-    // Input depth must be multiple of 16, and output depth a multiple of 4
-    if (input_depth % 16 != 0) return false;
-    if (output_depth % 4 != 0) return false;
+    if (stride_height != 1 || stride_width != 1) {
+      return accel_coverage_reject("stride");
+    }
+    // Input depth must be multiple of 16, and output depth a multiple of the
+    // channel group
+    if (input_depth % 16 != 0) {
+      return accel_coverage_reject("input depth multiple");
+    }
+    if (output_depth % OUTPUT_CHANNEL_GROUP != 0) {
+      return accel_coverage_reject("output depth multiple");
+    }
   }
 
   // Must be 4x4
   const int filter_height = filter_shape.Dims(1);
   const int filter_width = filter_shape.Dims(2);
-  if (filter_height != 4 || filter_width != 4) return false;
+  if (filter_height != 4 || filter_width != 4) {
+    return accel_coverage_reject("filter size");
+  }
 
   // Must fit in filter word storage
   const int filter_values_per_output =
       input_depth * filter_height * filter_width;
-  // Calculate 4 output values per tranche
-  const int filter_values = 4 * filter_values_per_output;
+  // Calculate at least one group of output channels per tranche
+  const int filter_values = OUTPUT_CHANNEL_GROUP * filter_values_per_output;
   // 4 values per word
   const int filter_words = filter_values / 4;
-  if (filter_words > NUM_FILTER_STORES * FILTER_WORDS_PER_STORE) return false;
+  if (filter_words > NUM_FILTER_STORES * FILTER_WORDS_PER_STORE) {
+    return accel_coverage_reject("fits in filter store");
+  }
 
   // Dilation must be 1
   if (params.dilation_height_factor != 1 || params.dilation_width_factor != 1)
-    return false;
+    return accel_coverage_reject("dilation");
 
   return true;
 }
@@ -294,6 +361,7 @@ void ConvPerChannel4x4(const ConvParams& params,
   // Configure parameters common to Mode 0 and 1
   const int input_depth = input_shape.Dims(3);
 
+  cfu_set(REG_INPUT_WINDOW_BASE, kInputWindowBase);
   cfu_set(REG_INPUT_OFFSET, params.input_offset);
   cfu_set(REG_OUTPUT_OFFSET, params.output_offset);
   cfu_set(REG_OUTPUT_ACTIVATION_MIN, params.quantized_activation_min);
@@ -24,10 +24,24 @@ namespace tflite {
 namespace reference_integer_ops {
 bool CanAccelerateConv4x4(const ConvParams& params,
                           const RuntimeShape& input_shape,
+                          const int8_t* input_data,
                           const RuntimeShape& filter_shape,
                           const RuntimeShape& output_shape,
                           const int32_t* bias_data);
 
+// The checks of CanAccelerateConv4x4() that depend only on the parameters
+// and shapes, which are known at Prepare
+bool CanAccelerateConv4x4Shape(const ConvParams& params,
+                               const RuntimeShape& input_shape,
+                               const RuntimeShape& filter_shape,
+                               const RuntimeShape& output_shape,
+                               const int32_t* bias_data);
+
+// The checks of CanAccelerateConv4x4() that depend on where the input is,
+// which is known only at Eval
+bool CanAccelerateConv4x4Input(const RuntimeShape& input_shape,
+                               const int8_t* input_data);
+
 // Accelerated version of ConvPerChannel() specialised for:
 // * 4x4 filter size
 // * no dilation
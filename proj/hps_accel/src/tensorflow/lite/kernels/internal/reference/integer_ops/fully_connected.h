@@ -17,6 +17,7 @@ limitations under the License.
 
 #include <cstdio>
 
+#include "accel_coverage.h"
 #include "tensorflow/lite/kernels/internal/common.h"
 #include "tensorflow/lite/kernels/internal/reference/integer_ops/fully_connected_accel.h"
 
@@ -51,11 +52,13 @@ inline void FullyConnected(
 #ifdef ACCEL_FULLY_CONNECTED
   if (CanAccelerateFullyConnected(params, filter_shape, bias_data,
                                   output_shape)) {
+    accel_coverage_accelerated();
     AccelerateFullyConnected(params, input_shape, input_data, filter_shape,
                              filter_data, bias_shape, bias_data, output_shape,
                              output_data);
     return;
   }
+  AccelCoverageFallback fallback;
 #endif
   const int32_t input_offset = params.input_offset;
   const int32_t filter_offset = params.weights_offset;
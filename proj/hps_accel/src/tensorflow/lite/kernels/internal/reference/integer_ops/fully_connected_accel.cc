@@ -19,6 +19,8 @@
 
 #include <cstdio>
 
+#include "accel_coverage.h"
+
 #include "tensorflow/lite/kernels/internal/common.h"
 
 namespace tflite {
@@ -29,11 +31,15 @@ bool CanAccelerateFullyConnected(const FullyConnectedParams& params,
                                  const RuntimeShape& filter_shape,
                                  const int32_t* bias_data,
                                  const RuntimeShape& output_shape) {
-  if (params.input_offset != 128) return false;
-  if (params.weights_offset != 0) return false;
-  if (bias_data == NULL) return false;
-  if (filter_shape.Dims(1) % 16 != 0) return false;
-  if (output_shape.Dims(0) != 1) return false;
+  if (params.input_offset != 128) return accel_coverage_reject("input offset");
+  if (params.weights_offset != 0) {
+    return accel_coverage_reject("weights offset");
+  }
+  if (bias_data == NULL) return accel_coverage_reject("no bias");
+  if (filter_shape.Dims(1) % 16 != 0) {
+    return accel_coverage_reject("depth multiple");
+  }
+  if (output_shape.Dims(0) != 1) return accel_coverage_reject("batches");
   return true;
 }
 
@@ -18,6 +18,7 @@ limitations under the License.
 #include <cstdio>
 #include <limits>
 
+#include "accel_coverage.h"
 #include "tensorflow/lite/kernels/internal/common.h"
 #include "tensorflow/lite/kernels/internal/reference/integer_ops/pooling_accel.h"
 
@@ -113,9 +114,11 @@ inline void MaxPool(const PoolParams& params, const RuntimeShape& input_shape,
 #error MAX_POOL op requires gateware gen 2
 #endif
   if (CanAccelerateMaxPool(params, input_shape, output_shape)) {
+    accel_coverage_accelerated();
     return AccelerateMaxPool(params, input_shape, input_data, output_shape,
                              output_data);
   }
+  AccelCoverageFallback fallback;
 #endif
 
   TFLITE_DCHECK_LE(params.quantized_activation_min,
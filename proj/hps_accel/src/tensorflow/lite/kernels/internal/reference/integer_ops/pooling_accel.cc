@@ -20,6 +20,7 @@
 #include <algorithm>
 #include <cstdio>
 
+#include "accel_coverage.h"
 #include "cfu.h"
 #include "tensorflow/lite/kernels/internal/common.h"
 
@@ -32,19 +33,31 @@ namespace reference_integer_ops {
 bool CanAccelerateMaxPool(const PoolParams& params,
                           const RuntimeShape& input_shape,
                           const RuntimeShape& output_shape) {
-  if (params.padding_values.height != 0) return false;
-  if (params.padding_values.width != 0) return false;
-  if (params.quantized_activation_min != -128) return false;
-  if (params.quantized_activation_max != 127) return false;
-  if (params.stride_height != 2 || params.stride_width != 2) return false;
-  if (params.filter_height != 2 || params.filter_width != 2) return false;
+  if (params.padding_values.height != 0) {
+    return accel_coverage_reject("padding");
+  }
+  if (params.padding_values.width != 0) return accel_coverage_reject("padding");
+  if (params.quantized_activation_min != -128) {
+    return accel_coverage_reject("activation");
+  }
+  if (params.quantized_activation_max != 127) {
+    return accel_coverage_reject("activation");
+  }
+  if (params.stride_height != 2 || params.stride_width != 2) {
+    return accel_coverage_reject("stride");
+  }
+  if (params.filter_height != 2 || params.filter_width != 2) {
+    return accel_coverage_reject("filter size");
+  }
 
   TFLITE_DCHECK_EQ(input_shape.DimensionsCount(), 4);
   TFLITE_DCHECK_EQ(output_shape.DimensionsCount(), 4);
   const int batches = MatchingDim(input_shape, 0, output_shape, 0);
   const int depth = MatchingDim(input_shape, 3, output_shape, 3);
-  if (batches != 1) return false;
-  if (depth == 0 || depth % 16 != 0) return false;
+  if (batches != 1) return accel_coverage_reject("batches");
+  if (depth == 0 || depth % 16 != 0) {
+    return accel_coverage_reject("depth multiple");
+  }
 
   return true;
 }
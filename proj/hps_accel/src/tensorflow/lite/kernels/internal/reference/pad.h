@@ -19,6 +19,7 @@ limitations under the License.
 #include <cstdio>
 #include <vector>
 
+#include "accel_coverage.h"
 #include "tensorflow/lite/kernels/internal/types.h"
 #include "tensorflow/lite/kernels/internal/reference/pad_accel.h"
 
@@ -180,10 +181,12 @@ inline void PadImageStyle(const tflite::PadParams& op_params,
 #ifdef ACCEL_PAD
   if (CanAcceleratePad(op_params, input_shape, input_data, pad_value_ptr,
                        output_shape)) {
+    accel_coverage_accelerated();
     AcceleratePad(op_params, input_shape, input_data, pad_value_ptr,
                   output_shape, output_data);
     return;
   }
+  AccelCoverageFallback fallback;
 #endif
   Pad(op_params, input_shape, input_data, pad_value_ptr, output_shape,
       output_data);
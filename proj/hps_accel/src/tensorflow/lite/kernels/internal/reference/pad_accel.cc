@@ -20,6 +20,8 @@
 #include <cstdio>
 #include <cstring>
 
+#include "accel_coverage.h"
+
 namespace tflite {
 namespace reference_ops {
 namespace {
@@ -99,17 +101,19 @@ bool CanAcceleratePad(const tflite::PadParams& op_params,
                       const RuntimeShape& output_shape) {
   // Exclude common test conditions
   if (op_params.resizing_category != tflite::ResizingCategory::kImageStyle)
-    return false;
+    return accel_coverage_reject("resizing category");
 
   if (op_params.left_padding_count != 4 || op_params.right_padding_count != 4)
-    return false;
+    return accel_coverage_reject("padding count");
 
   if (input_shape.DimensionsCount() != 4 || output_shape.DimensionsCount() != 4)
-    return false;
+    return accel_coverage_reject("dimensions");
 
   int input_batches = input_shape.Dims(0);
   int output_batches = output_shape.Dims(0);
-  if (input_batches != 1 || output_batches != 1) return false;
+  if (input_batches != 1 || output_batches != 1) {
+    return accel_coverage_reject("batches");
+  }
   int input_height = input_shape.Dims(1);
   int input_width = input_shape.Dims(2);
   int input_depth = input_shape.Dims(3);
@@ -117,25 +121,35 @@ bool CanAcceleratePad(const tflite::PadParams& op_params,
   int output_width = output_shape.Dims(2);
   int output_depth = output_shape.Dims(3);
 
-  if (input_depth != output_depth) return false;
+  if (input_depth != output_depth) return accel_coverage_reject("depth change");
 
   // Check for input layer
   if (input_depth == 1) {
-    if (input_height != 240 || input_width != 320) return false;
-    if (output_height != 242 || output_width != 322) return false;
-    return PaddingsAre(op_params, 0, 1, 1, 0, 0, 1, 1, 0);
+    if (input_height != 240 || input_width != 320) {
+      return accel_coverage_reject("input layer size");
+    }
+    if (output_height != 242 || output_width != 322) {
+      return accel_coverage_reject("input layer size");
+    }
+    if (!PaddingsAre(op_params, 0, 1, 1, 0, 0, 1, 1, 0)) {
+      return accel_coverage_reject("paddings");
+    }
+    return true;
 
     // Check for other layers
   } else if (input_depth > 1 && input_depth % 16 == 0) {
-    return PaddingsAre(op_params, 0, 0, 0, 0, 0, 0, 0, 0) ||
-           PaddingsAre(op_params, 0, 0, 1, 0, 0, 0, 2, 0) ||
-           PaddingsAre(op_params, 0, 1, 1, 0, 0, 0, 2, 0) ||
-           PaddingsAre(op_params, 0, 0, 1, 0, 0, 2, 2, 0) ||
-           PaddingsAre(op_params, 0, 1, 1, 0, 0, 2, 2, 0);
+    if (PaddingsAre(op_params, 0, 0, 0, 0, 0, 0, 0, 0) ||
+        PaddingsAre(op_params, 0, 0, 1, 0, 0, 0, 2, 0) ||
+        PaddingsAre(op_params, 0, 1, 1, 0, 0, 0, 2, 0) ||
+        PaddingsAre(op_params, 0, 0, 1, 0, 0, 2, 2, 0) ||
+        PaddingsAre(op_params, 0, 1, 1, 0, 0, 2, 2, 0)) {
+      return true;
+    }
+    return accel_coverage_reject("paddings");
   }
 
   // Didn't match any configuration
-  return false;
+  return accel_coverage_reject("depth multiple");
 }
 
 // Accelerate the operation
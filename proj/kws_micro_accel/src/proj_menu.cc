@@ -23,6 +23,8 @@
 #include "cfu.h"
 #include "kws_cfu.h"
 #include "menu.h"
+#include "playground_util/random.h"
+#include "tensorflow/lite/kernels/internal/reference/integer_ops/kws_fully_connected.h"
 
 namespace {
 
@@ -161,6 +163,109 @@ static void do_arithmetic_tests() {
   }
 }
 
+typedef struct {
+  const char* name;
+  int accum_depth;
+  int output_depth;
+  int32_t input_offset;
+  int32_t output_offset;
+  int32_t output_multiplier;
+  int output_shift;
+  int32_t activation_min;
+} KwsFullyConnectedTestCase;
+
+// Largest filter used by the FullyConnected tests
+constexpr int kMaxFcFilterSize = 128 * 128;
+constexpr int kMaxFcAccumDepth = 640;
+constexpr int kMaxFcOutputDepth = 128;
+
+// Tests KwsFullyConnected against the reference FullyConnected with random
+// data, in shapes and quantization taken from the KWS and anomaly detection
+// models.
+static void do_fully_connected_tests() {
+  static const KwsFullyConnectedTestCase cases[] = {
+      // KWS classifier: requantized on CPU because of output offset
+      {"kws classifier", 64, 12, 128, 14, 1561533440, -10, -128},
+      // Anomaly detection hidden layers: the CFU cannot shift by 10, so
+      // requantized on CPU
+      {"anomd hidden", 128, 128, 128, -128, 1236497152, -10, -128},
+      {"anomd bottleneck", 128, 8, 128, -128, 1953125000, -10, -128},
+      // Requantized in CFU, which handles shifts of -5 to -9
+      {"anomd expand", 8, 128, 128, -128, 1146730496, -9, -128},
+      {"cfu shift -5", 128, 16, 128, -128, 1236497152, -5, -128},
+      {"cfu shift -6", 128, 16, 128, -128, 1236497152, -6, -128},
+      {"cfu shift -7", 128, 16, 128, -128, 1236497152, -7, -128},
+      {"cfu shift -8", 128, 16, 128, -128, 1236497152, -8, -128},
+      // Left shift is not supported in CFU, so requantized on CPU
+      {"left shift", 128, 16, 128, -128, 1073741824, 1, -128},
+      // Restricted activation range is not supported in CFU
+      {"relu6 range", 128, 16, 128, -128, 1236497152, -10, -100},
+      // Anomaly detection first layer: input offset means reference is used
+      {"anomd input", 640, 16, -89, -128, 1299784576, -12, -128},
+  };
+  static int8_t input[kMaxFcAccumDepth] __attribute__((aligned(4)));
+  static int8_t filter[kMaxFcFilterSize] __attribute__((aligned(4)));
+  static int32_t bias[kMaxFcOutputDepth];
+  static int8_t expected[kMaxFcOutputDepth];
+  static int8_t actual[kMaxFcOutputDepth];
+
+  int64_t r = 0x5eed;
+  bool all_passed = true;
+  for (const auto& t : cases) {
+    for (int i = 0; i < t.accum_depth; i++) {
+      input[i] = static_cast<int8_t>(next_pseudo_random(&r));
+    }
+    for (int i = 0; i < t.accum_depth * t.output_depth; i++) {
+      filter[i] = static_cast<int8_t>(next_pseudo_random(&r));
+    }
+    for (int i = 0; i < t.output_depth; i++) {
+      bias[i] = next_pseudo_random(&r) % 8192;
+    }
+
+    tflite::FullyConnectedParams params;
+    params.input_offset = t.input_offset;
+    params.weights_offset = 0;
+    params.output_offset = t.output_offset;
+    params.output_multiplier = t.output_multiplier;
+    params.output_shift = t.output_shift;
+    params.quantized_activation_min = t.activation_min;
+    params.quantized_activation_max = 127;
+    const int32_t input_dims[] = {1, t.accum_depth};
+    const int32_t filter_dims[] = {t.output_depth, t.accum_depth};
+    const int32_t output_dims[] = {1, t.output_depth};
+    const tflite::RuntimeShape input_shape(2, input_dims);
+    const tflite::RuntimeShape filter_shape(2, filter_dims);
+    const tflite::RuntimeShape bias_shape(1, &t.output_depth);
+    const tflite::RuntimeShape output_shape(2, output_dims);
+
+    tflite::reference_integer_ops::FullyConnected(
+        params, input_shape, input, filter_shape, filter, bias_shape, bias,
+        output_shape, expected);
+    tflite::reference_integer_ops::KwsFullyConnected(
+        params, input_shape, input, filter_shape, filter, bias_shape, bias,
+        output_shape, actual);
+
+    int failures = 0;
+    for (int i = 0; i < t.output_depth; i++) {
+      if (actual[i] != expected[i]) {
+        if (failures++ < 4) {
+          printf("      %s[%d]: expected %d, got %d\n", t.name, i,
+                 expected[i], actual[i]);
+        }
+      }
+    }
+    printf("%s: %s, %d of %d outputs differ\n", failures ? "FAIL" : "OK  ",
+           t.name, failures, t.output_depth);
+    all_passed &= (failures == 0);
+  }
+
+  if (all_passed) {
+    puts("PASS: All FullyConnected golden tests passed.");
+  } else {
+    puts("FAIL: Not all FullyConnected golden tests passed.");
+  }
+}
+
 static void perform_setup() {
 #ifdef CSR_SPIFLASH_PHY_BASE
   puts("Setting SPI divisor.");
@@ -175,6 +280,8 @@ struct Menu MENU = {
         MENU_ITEM('s', "Peform Setup", perform_setup),
         MENU_ITEM('m', "Run [SIMD] MAC CFU Tests", do_mac_tests),
         MENU_ITEM('a', "Run Arithmetic CFU Tests", do_arithmetic_tests),
+        MENU_ITEM('f', "Run FullyConnected Golden Tests",
+                  do_fully_connected_tests),
         MENU_END,
     },
 };
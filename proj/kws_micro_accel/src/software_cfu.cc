@@ -18,6 +18,25 @@
 
 #include "fixedpoint/fixedpoint.h"
 
+// Shift applied by rcdbpot.sv, which decodes only the low three bits of the
+// negative exponent and so is correct for exponents -5 to -9
+static int rcdbpot_shift(uint32_t negative_exponent) {
+  switch (negative_exponent & 7) {
+    case 7:
+      return 9;
+    case 3:
+      return 5;
+    case 1:
+    case 5:
+      return 7;
+    case 2:
+    case 6:
+      return 6;
+    default:
+      return 8;
+  }
+}
+
 uint32_t software_cfu(int funct3, int funct7, uint32_t rs1, uint32_t rs2) {
   static int32_t acc = 0;
 
@@ -38,7 +57,7 @@ uint32_t software_cfu(int funct3, int funct7, uint32_t rs1, uint32_t rs2) {
       break;
     }
     case 0x4: {  // Rounding, clamping divide by power of two.
-      acc = gemmlowp::RoundingDivideByPOT(acc, -static_cast<int>(rs2));
+      acc = gemmlowp::RoundingDivideByPOT(acc, rcdbpot_shift(rs2));
       acc -= 128;
       acc = (acc > 127) ? 127 : (acc < -128) ? -128 : acc;
       break;
@@ -0,0 +1,109 @@
+/* Copyright 2021 The CFU-Playground Authors
+   Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_KERNELS_INTERNAL_REFERENCE_INTEGER_OPS_KWS_FULLY_CONNECTED_H_
+#define TENSORFLOW_LITE_KERNELS_INTERNAL_REFERENCE_INTEGER_OPS_KWS_FULLY_CONNECTED_H_
+
+#include "kws_cfu.h"
+#include "tensorflow/lite/kernels/internal/common.h"
+#include "tensorflow/lite/kernels/internal/reference/integer_ops/fully_connected.h"
+
+namespace tflite {
+namespace reference_integer_ops {
+
+// Optimized 8 bit quantized fully connected layer.
+//
+// The SIMD MAC adds an input offset of 128, so inputs must have a zero point
+// of -128. Outputs are requantized in the CFU when its fixed output offset of
+// -128, full int8 range and right shifts of 5 to 9 bits match the layer, and
+// on the CPU otherwise.
+#if defined(OPT_LINK_OPS_IN_SRAM) || defined(ALL_OPTIMIZATIONS)
+inline void KwsFullyConnected(const FullyConnectedParams&, const RuntimeShape&,
+                              const int8_t*, const RuntimeShape&,
+                              const int8_t*, const RuntimeShape&,
+                              const int32_t*, const RuntimeShape&, int8_t*)
+    __attribute__((always_inline));  // Must be inlined to be in SRAM.
+#endif
+inline void KwsFullyConnected(
+    const FullyConnectedParams& params, const RuntimeShape& input_shape,
+    const int8_t* input_data, const RuntimeShape& filter_shape,
+    const int8_t* filter_data, const RuntimeShape& bias_shape,
+    const int32_t* bias_data, const RuntimeShape& output_shape,
+    int8_t* output_data) {
+  const int32_t input_offset = params.input_offset;
+  const int32_t filter_offset = params.weights_offset;
+  const int32_t output_offset = params.output_offset;
+  const int32_t output_multiplier = params.output_multiplier;
+  const int output_shift = params.output_shift;
+  const int32_t output_activation_min = params.quantized_activation_min;
+  const int32_t output_activation_max = params.quantized_activation_max;
+  TFLITE_DCHECK_GE(filter_shape.DimensionsCount(), 2);
+  TFLITE_DCHECK_EQ(output_shape.DimensionsCount(), 2);
+
+  TFLITE_DCHECK_LE(output_activation_min, output_activation_max);
+  const int filter_dim_count = filter_shape.DimensionsCount();
+  const int batches = output_shape.Dims(0);
+  const int output_depth = output_shape.Dims(1);
+  TFLITE_DCHECK_LE(output_depth, filter_shape.Dims(filter_dim_count - 2));
+  const int accum_depth = filter_shape.Dims(filter_dim_count - 1);
+
+  // Rows are read a word at a time, so must be word aligned
+  const bool words_aligned =
+      (reinterpret_cast<uintptr_t>(input_data) & 3) == 0 &&
+      (reinterpret_cast<uintptr_t>(filter_data) & 3) == 0 &&
+      accum_depth % 4 == 0;
+  if (input_offset != 128 || filter_offset != 0 || !words_aligned) {
+    FullyConnected(params, input_shape, input_data, filter_shape, filter_data,
+                   bias_shape, bias_data, output_shape, output_data);
+    return;
+  }
+  // The CFU's rounding divide (rcdbpot.sv) decodes only shifts of -5 to -9
+  const bool cfu_requantize =
+      output_offset == -128 && output_activation_min == -128 &&
+      output_activation_max == 127 && output_shift >= -9 && output_shift <= -5;
+
+  const int accum_words = accum_depth / 4;
+  for (int b = 0; b < batches; ++b) {
+    const uint32_t* input_words =
+        reinterpret_cast<const uint32_t*>(input_data + b * accum_depth);
+    const uint32_t* filter_words =
+        reinterpret_cast<const uint32_t*>(filter_data);
+    for (int out_c = 0; out_c < output_depth; ++out_c) {
+      int32_t acc = RESET_ACC();
+      for (int w = 0; w < accum_words; ++w) {
+        acc = SIMD_MAC(input_words[w], *filter_words++);
+      }
+      if (bias_data) {
+        acc += bias_data[out_c];
+      }
+      if (cfu_requantize) {
+        acc = KwsMultiplyByQuantizedMultiplier(acc, output_multiplier,
+                                               output_shift);
+      } else {
+        acc =
+            MultiplyByQuantizedMultiplier(acc, output_multiplier, output_shift);
+        acc += output_offset;
+        acc = std::max(acc, output_activation_min);
+        acc = std::min(acc, output_activation_max);
+      }
+      output_data[out_c + output_depth * b] = static_cast<int8_t>(acc);
+    }
+  }
+}
+
+}  // namespace reference_integer_ops
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_KERNELS_INTERNAL_REFERENCE_INTEGER_OPS_KWS_FULLY_CONNECTED_H_
@@ -15,7 +15,7 @@
 
 from amaranth import Signal
 from amaranth.lib.fifo import SyncFIFOBuffered
-from amaranth_cfu import simple_cfu, DualPortMemory, is_pysim_run
+from amaranth_cfu import simple_cfu, DualPortMemory, is_pysim_run, PerfCounters
 
 from . import config
 from .macc import Accumulator, ByteToWordShifter, Madd4Pipeline
@@ -138,6 +138,21 @@ class Mnv2RegisterInstruction(RegisterFileInstruction):
         oq_has_space = fifo.w_level < (config.OUTPUT_QUEUE_DEPTH - 8)
         return fifo.w_data, fifo.w_en, oq_has_space
 
+    def _make_perf_counters(self, m):
+        m.submodules['perf'] = perf = PerfCounters()
+        _, perf_reset = self._make_setter(m, 40, 'perf_reset')
+        m.d.comb += perf.reset.eq(perf_reset)
+        counts = [perf.busy_count, perf.input_starved_count,
+                  perf.output_blocked_count, perf.idle_count]
+        for i, count in enumerate(counts):
+            m.submodules[f'perf_get_{i}'] = getter = NextWordGetter()
+            m.d.comb += [
+                getter.data.eq(count),
+                getter.ready.eq(1),
+            ]
+            self.register_xetter(41 + i, getter)
+        return perf
+
     def elab_xetters(self, m):
         # Simple registers
         input_depth_words, set_id = self._make_setter(
@@ -231,6 +246,14 @@ class Mnv2RegisterInstruction(RegisterFileInstruction):
             oq_enable.eq(seq.out_word_done),
         ]
 
+        # Performance counters
+        perf = self._make_perf_counters(m)
+        m.d.comb += [
+            perf.busy.eq(seq.gate),
+            perf.input_starved.eq(seq.running & ~ins.r_ready),
+            perf.output_blocked.eq(seq.running & ~oq_has_space),
+        ]
+
 def make_cfu():
     return simple_cfu({
             0: Mnv2RegisterInstruction(),
@@ -77,6 +77,8 @@ class GateCalculator(SimpleElaboratable):
         High while fifo has space to store an entire pipeline's worth of data.
     gate: Signal() out
         High when pipeline should accept data
+    running: Signal() out
+        High from start_run until all output channels have been started.
     """
 
     def __init__(self):
@@ -85,6 +87,7 @@ class GateCalculator(SimpleElaboratable):
         self.in_store_ready = Signal()
         self.fifo_has_space = Signal()
         self.gate = Signal()
+        self.running = Signal()
 
     def elab(self, m):
         running = Signal()
@@ -93,6 +96,7 @@ class GateCalculator(SimpleElaboratable):
         with m.If(self.all_output_finished):
             m.d.sync += running.eq(0)
 
+        m.d.comb += self.running.eq(running | self.start_run)
         m.d.comb += self.gate.eq((running | self.start_run)
                                  & self.in_store_ready
                                  & self.fifo_has_space)
@@ -120,6 +124,8 @@ class Sequencer(SimpleElaboratable):
         This value is input_depth / 4.
     gate: Signal() out
         High when pipeline should accept data
+    running: Signal() out
+        High while a run is in progress
     all_output_finished: Signal() out
         High when all of the output channels calculations have been started.
     madd_done: Signal() out
@@ -142,6 +148,7 @@ class Sequencer(SimpleElaboratable):
         self.input_depth_words = Signal(
             range(config.MAX_PER_PIXEL_INPUT_WORDS + 1))
         self.gate = Signal()
+        self.running = Signal()
         self.all_output_finished = Signal()
         self.madd_done = Signal()
         self.acc_done = Signal()
@@ -156,6 +163,7 @@ class Sequencer(SimpleElaboratable):
             gate_calc.fifo_has_space.eq(self.fifo_has_space),
             gate_calc.all_output_finished.eq(self.all_output_finished),
             self.gate.eq(gate_calc.gate),
+            self.running.eq(gate_calc.running),
         ]
         m.submodules['f_count'] = f_count = UpCounter(
             self.filter_value_words.shape().width)
@@ -162,3 +162,14 @@ class CfuTest(CfuTestBase):
             yield get_output(pack_vals(127, -55, 127, 67))
 
         return self.run_ops(make_op_stream(), False)
+
+    def test_perf_counters(self):
+        DATA = [
+            # Reset counters
+            ((0, 40, 0, 0), None),
+            # No runs, so no busy, starved or blocked cycles
+            ((0, 41, 0, 0), 0),
+            ((0, 42, 0, 0), 0),
+            ((0, 43, 0, 0), 0),
+        ]
+        return self.run_ops(DATA, False)
@@ -0,0 +1,70 @@
+/*
+ * Copyright 2021 The CFU-Playground Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "approx_requant.h"
+
+#ifndef APPROX_REQUANT_LAYERS
+#define APPROX_REQUANT_LAYERS 0
+#endif
+
+namespace {
+
+const int8_t* layers[APPROX_REQUANT_MAX_LAYERS];
+uint64_t layer_cycles[APPROX_REQUANT_MAX_LAYERS];
+int num_layers;
+uint64_t mask = APPROX_REQUANT_LAYERS;
+
+};  // anonymous namespace
+
+int approx_requant_layer(const int8_t* filter_data) {
+  for (int i = 0; i < num_layers; i++) {
+    if (layers[i] == filter_data) {
+      return i;
+    }
+  }
+  if (num_layers == APPROX_REQUANT_MAX_LAYERS) {
+    return -1;
+  }
+  layers[num_layers] = filter_data;
+  layer_cycles[num_layers] = 0;
+  return num_layers++;
+}
+
+int approx_requant_num_layers() { return num_layers; }
+
+void approx_requant_reset() { num_layers = 0; }
+
+void approx_requant_set_mask(uint64_t new_mask) { mask = new_mask; }
+
+uint64_t approx_requant_mask() { return mask; }
+
+int approx_requant_enabled(int layer) {
+  return layer >= 0 && ((mask >> layer) & 1);
+}
+
+void approx_requant_add_cycles(int layer, uint64_t cycles) {
+  if (layer >= 0) {
+    layer_cycles[layer] += cycles;
+  }
+}
+
+uint64_t approx_requant_cycles(int layer) { return layer_cycles[layer]; }
+
+void approx_requant_reset_cycles() {
+  for (int i = 0; i < num_layers; i++) {
+    layer_cycles[i] = 0;
+  }
+}
@@ -0,0 +1,62 @@
+/*
+ * Copyright 2021 The CFU-Playground Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _APPROX_REQUANT_H
+#define _APPROX_REQUANT_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Per-layer opt-in to approximate requantization.
+//
+// Convolution layers are numbered in the order they first run, and are
+// identified by their filter data. A layer with its bit set in the mask has
+// its output requantized on the CPU by cpp_math_mul_by_quantized_mul_approx().
+// Layers that run on the CFU are requantized exactly whatever the mask: in
+// gateware, the approximation would not shorten the post-processing
+// pipeline. Build with APPROX_REQUANT_LAYERS=<mask> to set the initial mask,
+// which is otherwise zero.
+
+#define APPROX_REQUANT_MAX_LAYERS 64
+
+// Returns the number of a layer, numbering it if it is new, or -1 if more
+// than APPROX_REQUANT_MAX_LAYERS layers have been seen.
+int approx_requant_layer(const int8_t* filter_data);
+
+// Returns the number of layers seen so far
+int approx_requant_num_layers();
+
+// Forgets the layers seen so far, and their cycle counts
+void approx_requant_reset();
+
+void approx_requant_set_mask(uint64_t mask);
+uint64_t approx_requant_mask();
+
+// Whether the given layer is approximated. False for -1.
+int approx_requant_enabled(int layer);
+
+// Cycle counts for each layer, accumulated over every run of the layer
+void approx_requant_add_cycles(int layer, uint64_t cycles);
+uint64_t approx_requant_cycles(int layer);
+void approx_requant_reset_cycles();
+
+#ifdef __cplusplus
+}
+#endif
+#endif  // _APPROX_REQUANT_H
@@ -0,0 +1,30 @@
+/*
+ * Copyright 2021 The CFU-Playground Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "cfu_counters.h"
+
+#include "mnv2_cfu.h"
+
+int cfu_counters_supported() { return 1; }
+
+void cfu_counters_reset() { CFU_PERF_RESET(); }
+
+void cfu_counters_read(struct CfuCounters* counters) {
+  counters->busy = CFU_PERF_GET_BUSY();
+  counters->input_starved = CFU_PERF_GET_INPUT_STARVED();
+  counters->output_blocked = CFU_PERF_GET_OUTPUT_BLOCKED();
+  counters->idle = CFU_PERF_GET_IDLE();
+}
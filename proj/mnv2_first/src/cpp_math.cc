@@ -48,6 +48,20 @@ int32_t cpp_math_mul_by_quantized_mul_gateware2(int32_t x,
   return cfu_op6_hw(0, srdhm, right_shift);
 }
 
+int32_t cpp_math_mul_by_quantized_mul_approx(int32_t x,
+                                             int32_t quantized_multiplier,
+                                             int shift) {
+  // x * quantized_multiplier / 2^(31 - shift), with the multiplier's low
+  // 16 bits dropped and rounding half up once, at the end
+  const int left_shift = shift > 0 ? shift : 0;
+  const int right_shift = 15 + (shift > 0 ? 0 : -shift);
+  const int32_t left_shifted =
+      static_cast<int32_t>(static_cast<uint32_t>(x) << left_shift);
+  const int64_t product =
+      static_cast<int64_t>(left_shifted) * (quantized_multiplier >> 16);
+  const int64_t round = static_cast<int64_t>(1) << (right_shift - 1);
+  return static_cast<int32_t>((product + round) >> right_shift);
+}
 
 int32_t cpp_math_srdhm_software(int32_t a, int32_t b) {
   return gemmlowp::SaturatingRoundingDoublingHighMul(a, b);
@@ -33,6 +33,13 @@ int32_t cpp_math_mul_by_quantized_mul_gateware1(int32_t x, int32_t quantized_mul
 int32_t cpp_math_mul_by_quantized_mul_gateware2(int32_t x, int32_t quantized_multiplier,
                              int shift);
 
+// Approximates tflite::MultiplyByQuantizedMultiplier with one multiply by
+// the top 16 bits of quantized_multiplier and a single rounding. The relative
+// error is below 2^-14, so int8 results are off by at most one.
+int32_t cpp_math_mul_by_quantized_mul_approx(int32_t x,
+                                             int32_t quantized_multiplier,
+                                             int shift);
+
 int32_t cpp_math_srdhm_software(int32_t a, int32_t b);
 
 // Rounding divide by power of two
@@ -21,6 +21,7 @@
 
 #include "perf.h"
 #include "tensorflow/lite/kernels/internal/reference/integer_ops/conv.h"
+#include "tensorflow/lite/kernels/internal/reference/integer_ops/mnv2_conv.h"
 
 // raw 1x1 inputs and output as dumped from reference implmentation
 static const uint8_t raw_1x1_conv_params[] = {
@@ -1330,3 +1331,133 @@ void golden_op_run_1x1conv(void) {
     puts("OK - output tensor matches");
   }
 }
+
+// Shape of the synthetic first layer test: a 3x3, stride 2 conv with SAME
+// padding, as in MobileNet v2, on a smaller image.
+#define RGB_IN_SIZE 16
+#define RGB_OUT_SIZE (RGB_IN_SIZE / 2)
+#define RGB_OUT_DEPTH 16
+#define RGB_INPUT_BYTES (RGB_IN_SIZE * RGB_IN_SIZE * 3)
+#define RGB_FILTER_BYTES (RGB_OUT_DEPTH * 3 * 3 * 3)
+#define RGB_OUTPUT_BYTES (RGB_OUT_SIZE * RGB_OUT_SIZE * RGB_OUT_DEPTH)
+
+static uint32_t rgb_rand_state;
+
+static int8_t rgb_rand() {
+  rgb_rand_state = rgb_rand_state * 1103515245 + 12345;
+  return (int8_t)(rgb_rand_state >> 16);
+}
+
+// Straightforward conv, for comparison with the accelerated kernel
+static void rgb_reference_conv(const tflite::ConvParams& params,
+                               const int32_t* output_multiplier,
+                               const int32_t* output_shift,
+                               const int8_t* input, const int8_t* filter,
+                               const int32_t* bias, int8_t* output) {
+  for (int out_y = 0; out_y < RGB_OUT_SIZE; out_y++) {
+    for (int out_x = 0; out_x < RGB_OUT_SIZE; out_x++) {
+      for (int c = 0; c < RGB_OUT_DEPTH; c++) {
+        int32_t acc = bias[c];
+        for (int fy = 0; fy < 3; fy++) {
+          const int in_y = out_y * 2 + fy - params.padding_values.height;
+          for (int fx = 0; fx < 3; fx++) {
+            const int in_x = out_x * 2 + fx - params.padding_values.width;
+            if (in_y < 0 || in_y >= RGB_IN_SIZE || in_x < 0 ||
+                in_x >= RGB_IN_SIZE) {
+              continue;
+            }
+            for (int i = 0; i < 3; i++) {
+              acc += filter[((c * 3 + fy) * 3 + fx) * 3 + i] *
+                     (input[(in_y * RGB_IN_SIZE + in_x) * 3 + i] +
+                      params.input_offset);
+            }
+          }
+        }
+        acc = tflite::MultiplyByQuantizedMultiplier(acc, output_multiplier[c],
+                                                    output_shift[c]);
+        acc += params.output_offset;
+        acc = std::max(acc, params.quantized_activation_min);
+        acc = std::min(acc, params.quantized_activation_max);
+        *(output++) = (int8_t)acc;
+      }
+    }
+  }
+}
+
+void golden_op_run_3x3rgb_conv(void) {
+  static int8_t input[RGB_INPUT_BYTES];
+  static int8_t filter[RGB_FILTER_BYTES];
+  static int8_t actual_output[RGB_OUTPUT_BYTES];
+  static int8_t expected_output[RGB_OUTPUT_BYTES];
+  int32_t bias[RGB_OUT_DEPTH];
+  int32_t output_multiplier[RGB_OUT_DEPTH];
+  int32_t output_shift[RGB_OUT_DEPTH];
+
+  rgb_rand_state = 1;
+  for (int i = 0; i < RGB_INPUT_BYTES; i++) input[i] = rgb_rand();
+  for (int i = 0; i < RGB_FILTER_BYTES; i++) filter[i] = rgb_rand();
+  for (int i = 0; i < RGB_OUT_DEPTH; i++) {
+    bias[i] = rgb_rand() * 64;
+    output_multiplier[i] = 0x40000000 + rgb_rand() * 0x00400000;
+    output_shift[i] = -10 + (rgb_rand() & 1);
+  }
+
+  // The input offset is that of an image converted from unsigned values
+  tflite::ConvParams params = {};
+  params.padding_values.width = 0;
+  params.padding_values.height = 0;
+  params.stride_width = 2;
+  params.stride_height = 2;
+  params.dilation_width_factor = 1;
+  params.dilation_height_factor = 1;
+  params.input_offset = 128;
+  params.output_offset = 0;
+  params.quantized_activation_min = -128;
+  params.quantized_activation_max = 127;
+
+  const int32_t input_dims[] = {1, RGB_IN_SIZE, RGB_IN_SIZE, 3};
+  const int32_t filter_dims[] = {RGB_OUT_DEPTH, 3, 3, 3};
+  const int32_t bias_dims[] = {RGB_OUT_DEPTH};
+  const int32_t output_dims[] = {1, RGB_OUT_SIZE, RGB_OUT_SIZE,
+                                 RGB_OUT_DEPTH};
+  const tflite::RuntimeShape input_shape(4, input_dims);
+  const tflite::RuntimeShape filter_shape(4, filter_dims);
+  const tflite::RuntimeShape bias_shape(1, bias_dims);
+  const tflite::RuntimeShape output_shape(4, output_dims);
+
+  int fails = 0;
+  // Check with padding on the bottom and right only, as for SAME padding,
+  // then on all sides.
+  for (int pad = 0; pad < 2; pad++) {
+    params.padding_values.width = pad;
+    params.padding_values.height = pad;
+    rgb_reference_conv(params, output_multiplier, output_shift, input, filter,
+                       bias, expected_output);
+
+    perf_reset_all_counters();
+    perf_enable_counter(0);
+    tflite::reference_integer_ops::Mnv2ConvPerChannel3x3Rgb(
+        params, output_multiplier, output_shift, input_shape, input,
+        filter_shape, filter, bias_shape, bias, output_shape, actual_output);
+    perf_disable_counter(0);
+    printf("pad=%d cycle count: ", pad);
+    perf_print_value(perf_get_counter(0));
+    puts("");
+
+    for (size_t i = 0; i < RGB_OUTPUT_BYTES; i++) {
+      if (actual_output[i] != expected_output[i]) {
+        if (!fails) {
+          printf("FAIL - first output tensor mismatch at %u\n", i);
+          printf("       actual   = 0x%02x\n", actual_output[i] & 0xff);
+          printf("       expected = 0x%02x\n", expected_output[i] & 0xff);
+        }
+        fails++;
+      }
+    }
+  }
+  if (fails) {
+    printf("FAIL - %d fails\n", fails);
+  } else {
+    puts("OK - output tensors match");
+  }
+}
@@ -21,6 +21,7 @@ extern "C" {
 #endif
 
 void golden_op_run_1x1conv(void);
+void golden_op_run_3x3rgb_conv(void);
 
 #ifdef __cplusplus
 }
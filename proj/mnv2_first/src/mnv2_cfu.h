@@ -48,6 +48,13 @@ extern "C" {
 #define CFU_MACC_RUN() CFU_GET(33)
 #define CFU_GET_OUTPUT() CFU_GET(34)
 
+// Performance counters: cycles spent in each state since last reset
+#define CFU_PERF_RESET() CFU_SET(40, 0)
+#define CFU_PERF_GET_BUSY() CFU_GET(41)
+#define CFU_PERF_GET_INPUT_STARVED() CFU_GET(42)
+#define CFU_PERF_GET_OUTPUT_BLOCKED() CFU_GET(43)
+#define CFU_PERF_GET_IDLE() CFU_GET(44)
+
 // Supports incremental development
 #define CFU_MARK_INPUT_READ_FINISHED() CFU_GET(112)
 
@@ -19,9 +19,11 @@
 #include <stdio.h>
 #include <string.h>
 
+#include "approx_requant.h"
 #include "b64_util.h"
 #include "golden_op_tests.h"
 #include "menu.h"
+#include "models/mnv2/mnv2.h"
 
 namespace {
 void print_sample(const char* s) {
@@ -39,12 +41,95 @@ void do_b64_samples() {
       "of knowledge, exceeds the short vehemence of any carnal pleasure.");
 }
 
+#ifdef INCLUDE_MODEL_MNV2
+#define MAX_GOLDEN 8
+
+struct ApproxRun {
+  int32_t scores[MAX_GOLDEN];
+  uint64_t cycles[APPROX_REQUANT_MAX_LAYERS];
+};
+
+// Runs every golden test input, with the given layers approximated
+void run_approx(uint64_t mask, struct ApproxRun* run) {
+  approx_requant_set_mask(mask);
+  approx_requant_reset_cycles();
+  for (int i = 0; i < mnv2_num_golden_tests() && i < MAX_GOLDEN; i++) {
+    run->scores[i] = mnv2_classify_golden_test(i);
+  }
+  for (int i = 0; i < approx_requant_num_layers(); i++) {
+    run->cycles[i] = approx_requant_cycles(i);
+  }
+}
+
+// Prints the accuracy delta and cycles saved by approximating in run
+void print_approx(const char* name, uint64_t exact_cycles,
+                  uint64_t approx_cycles, const struct ApproxRun* exact,
+                  const struct ApproxRun* run) {
+  int32_t max_delta = 0;
+  int flips = 0;
+  for (int i = 0; i < mnv2_num_golden_tests() && i < MAX_GOLDEN; i++) {
+    int32_t delta = run->scores[i] - exact->scores[i];
+    if (delta < 0) delta = -delta;
+    if (delta > max_delta) max_delta = delta;
+    if ((run->scores[i] >= 0) != (exact->scores[i] >= 0)) flips++;
+  }
+  printf("%s,%llu,%llu,%lld,%ld,%d\n", name, exact_cycles, approx_cycles,
+         static_cast<long long>(exact_cycles - approx_cycles), max_delta,
+         flips);
+}
+
+// Measures, for each conv layer in turn and then for all of them, the
+// change in golden test scores and the cycles saved by approximate
+// requantization. Runs every golden test input once per layer. Layers that
+// run on the CFU are not approximated, so show neither.
+void do_approx_requant_sweep() {
+  static struct ApproxRun exact, run;
+  const uint64_t saved_mask = approx_requant_mask();
+  mnv2_load_model();
+  approx_requant_reset();
+  run_approx(0, &exact);
+  const int num_layers = approx_requant_num_layers();
+  uint64_t exact_total = 0;
+  for (int i = 0; i < num_layers; i++) {
+    exact_total += exact.cycles[i];
+  }
+
+  puts("\"Layer\",\"Exact cycles\",\"Approx cycles\",\"Saved\","
+       "\"Max score delta\",\"Flips\"");
+  for (int layer = 0; layer < num_layers; layer++) {
+    run_approx(static_cast<uint64_t>(1) << layer, &run);
+    char name[8];
+    snprintf(name, sizeof(name), "%d", layer);
+    print_approx(name, exact.cycles[layer], run.cycles[layer], &exact, &run);
+  }
+  run_approx(num_layers == 64 ? ~static_cast<uint64_t>(0)
+                              : (static_cast<uint64_t>(1) << num_layers) - 1,
+             &run);
+  uint64_t approx_total = 0;
+  for (int i = 0; i < num_layers; i++) {
+    approx_total += run.cycles[i];
+  }
+  print_approx("all", exact_total, approx_total, &exact, &run);
+
+  for (int i = 0; i < mnv2_num_golden_tests() && i < MAX_GOLDEN; i++) {
+    printf("Golden test %d: expected %ld, exact %ld, all approximated %ld\n",
+           i, mnv2_golden_test_expected(i), exact.scores[i], run.scores[i]);
+  }
+  approx_requant_set_mask(saved_mask);
+}
+#endif  // INCLUDE_MODEL_MNV2
+
 struct Menu MENU = {
     "Project Menu",
     "mnv2_first",
     {
         MENU_ITEM('1', "1x1 conv2d golden tests", golden_op_run_1x1conv),
         MENU_ITEM('2', "base64 samples", do_b64_samples),
+        MENU_ITEM('3', "3x3 RGB conv2d test", golden_op_run_3x3rgb_conv),
+#ifdef INCLUDE_MODEL_MNV2
+        MENU_ITEM('a', "approximate requantization sweep",
+                  do_approx_requant_sweep),
+#endif
         MENU_END,
     },
 };
@@ -33,6 +33,18 @@ int32_t reg_output_offset;
 int32_t reg_activation_min;
 int32_t reg_activation_max;
 
+// Performance counters. Busy cycles are counted as the gateware would count
+// them. Since this model runs in step with the CPU, stalls are counted once
+// per occurrence and every other CFU instruction counts as one idle cycle.
+struct PerfCounters {
+  uint32_t busy;
+  uint32_t input_starved;
+  uint32_t output_blocked;
+  uint32_t idle;
+};
+
+struct PerfCounters perf_counters;
+
 #define MAX_OUTPUT_DEPTH 512
 struct ParamStore {
   int32_t params[MAX_OUTPUT_DEPTH];
@@ -188,6 +200,7 @@ int32_t input_store_set(struct InputStore* is, uint32_t val) {
 uint32_t input_store_read(struct InputStore* is) {
   if (!is->read_allowed[is->curr_read_buffer]) {
     // in gateware, this will be a stall
+    perf_counters.input_starved++;
     printf("could not read\n");
     return 0;
   }
@@ -233,6 +246,11 @@ uint32_t oq_get(struct OutputQueue* oq) {
 }
 
 void oq_put(struct OutputQueue* oq, uint32_t word) {
+  // Gateware stops when fewer than 8 words are available
+  int used = (oq->w - oq->r + EBRAM_DEPTH_WORDS) % EBRAM_DEPTH_WORDS;
+  if (used >= EBRAM_DEPTH_WORDS - 8) {
+    perf_counters.output_blocked++;
+  }
   oq->data[oq->w] = word;
   oq->w = (oq->w + 1) % EBRAM_DEPTH_WORDS;
   static int dbg_ctr = 0;
@@ -277,6 +295,8 @@ uint32_t calc_to_oq(struct OutputQueue* oq, struct InputStore* is,
                            struct FilterStore* fs) {
   // Assumes batch_size fits in the output queue - really should check
   // full/empty
+  // Gateware takes one cycle per filter word
+  perf_counters.busy += reg_output_batch_size * is->input_depth;
   for (int i = 0; i < reg_output_batch_size; i += 4) {
     oq_put(oq, macc4_run4(is, fs));
   }
@@ -286,6 +306,9 @@ uint32_t calc_to_oq(struct OutputQueue* oq, struct InputStore* is,
 
 // Set register instruction
 uint32_t set_reg(int funct7, uint32_t in0, uint32_t in1) {
+  if (funct7 != 33) {
+    perf_counters.idle++;
+  }
   switch (funct7) {
     case 10:
       input_store_restart(&input_store);
@@ -333,6 +356,18 @@ uint32_t set_reg(int funct7, uint32_t in0, uint32_t in1) {
     case 34:
       return oq_get(&output_queue);
 
+    case 40:
+      memset(&perf_counters, 0, sizeof(perf_counters));
+      return 0;
+    case 41:
+      return perf_counters.busy;
+    case 42:
+      return perf_counters.input_starved;
+    case 43:
+      return perf_counters.output_blocked;
+    case 44:
+      return perf_counters.idle;
+
     default:
       return 0;
   }
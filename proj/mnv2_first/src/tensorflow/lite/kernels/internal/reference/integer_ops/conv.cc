@@ -14,8 +14,11 @@ limitations under the License.
 ==============================================================================*/
 #include <stdio.h>
 
+#include "approx_requant.h"
+#include "cpp_math.h"
 #include "mnv2_cfu.h"
 #include "mnv2_conv.h"
+#include "perf.h"
 #include "tensorflow/lite/kernels/internal/common.h"
 #include "playground_util/print_params.h"
 
@@ -26,6 +29,30 @@ limitations under the License.
 namespace tflite {
 namespace reference_integer_ops {
 
+namespace {
+
+// For the lifetime of one convolution: whether the layer is approximated,
+// and counting the layer's cycles. Only the CPU loop below approximates.
+// Layers run on the CFU are always requantized exactly.
+class ApproxRequantLayer {
+ public:
+  explicit ApproxRequantLayer(const int8_t* filter_data)
+      : layer_(approx_requant_layer(filter_data)),
+        approximate_(approx_requant_enabled(layer_)),
+        start_(perf_get_mcycle64()) {}
+  ~ApproxRequantLayer() {
+    approx_requant_add_cycles(layer_, perf_get_mcycle64() - start_);
+  }
+  bool approximate() const { return approximate_; }
+
+ private:
+  const int layer_;
+  const bool approximate_;
+  const uint64_t start_;
+};
+
+};  // anonymous namespace
+
 // Fixed-point per-channel-quantization convolution reference kernel.
 void ConvPerChannel(const ConvParams& params, const int32_t* output_multiplier,
                     const int32_t* output_shift,
@@ -36,6 +63,7 @@ void ConvPerChannel(const ConvParams& params, const int32_t* output_multiplier,
 #ifdef SHOW_CONV_PARAMS
   print_conv_params(params, input_shape, filter_shape, output_shape);
 #endif
+  const ApproxRequantLayer approx_requant(filter_data);
   // Get parameters.
   const int32_t input_offset = params.input_offset;  // r = s(q - Z)
   const int stride_width = params.stride_width;
@@ -86,6 +114,17 @@ void ConvPerChannel(const ConvParams& params, const int32_t* output_multiplier,
       return;
     }
   }
+  // The first layer of MobileNet v2: a 3x3 conv over an RGB image
+  if (dilation_width_factor == 1 && dilation_height_factor == 1 &&
+      batches == 1 && input_depth == 3 && filter_height == 3 &&
+      filter_width == 3 && bias_data && (output_depth % 8) == 0 &&
+      output_depth <= MNV2_RGB_MAX_OUTPUT_DEPTH) {
+    Mnv2ConvPerChannel3x3Rgb(params, output_multiplier, output_shift,
+                             input_shape, input_data, filter_shape,
+                             filter_data, bias_shape, bias_data, output_shape,
+                             output_data);
+    return;
+  }
 #endif
 
 #ifdef DUMP_CONV
@@ -179,8 +218,14 @@ void ConvPerChannel(const ConvParams& params, const int32_t* output_multiplier,
           if (bias_data) {
             acc += bias_data[out_channel];
           }
-          acc = MultiplyByQuantizedMultiplier(
-              acc, output_multiplier[out_channel], output_shift[out_channel]);
+          if (approx_requant.approximate()) {
+            acc = cpp_math_mul_by_quantized_mul_approx(
+                acc, output_multiplier[out_channel], output_shift[out_channel]);
+          } else {
+            acc = MultiplyByQuantizedMultiplier(
+                acc, output_multiplier[out_channel],
+                output_shift[out_channel]);
+          }
           acc += output_offset;
           acc = std::max(acc, output_activation_min);
           acc = std::min(acc, output_activation_max);
@@ -214,5 +214,137 @@ void Mnv2ConvPerChannel1x1(
   }
 }
 
+// A 3x3 patch of RGB input is packed as nine words of four bytes, with the
+// fourth byte of each unused, plus one unused word, so that the input and
+// filter stores receive an even number of words per pixel.
+static constexpr int kRgbPatchWords = 10;
+static constexpr int kRgbPatchValues = kRgbPatchWords * 4;
+
+// Filter values packed in the same layout as the patches
+static uint32_t rgb_filter_words[MNV2_RGB_MAX_OUTPUT_DEPTH * kRgbPatchWords];
+
+inline static uint32_t PackRgb(const int8_t* rgb) {
+  return static_cast<uint8_t>(rgb[0]) |
+         static_cast<uint32_t>(static_cast<uint8_t>(rgb[1])) << 8 |
+         static_cast<uint32_t>(static_cast<uint8_t>(rgb[2])) << 16;
+}
+
+static void PackRgbFilter(const int8_t* filter_data, int output_depth) {
+  uint32_t* dst = rgb_filter_words;
+  for (int c = 0; c < output_depth; c++) {
+    for (int i = 0; i < 9; i++) {
+      *(dst++) = PackRgb(filter_data);
+      filter_data += 3;
+    }
+    *(dst++) = 0;
+  }
+}
+
+// Packs the patch at (in_y, in_x) and loads it into the CFU. Pixels outside
+// the image are filled with pad_word, whose values cancel the input offset.
+inline static void LoadRgbPatch(const int8_t* input_data, int input_height,
+                                int input_width, int in_y, int in_x,
+                                uint32_t pad_word) {
+  uint32_t patch[kRgbPatchWords];
+  uint32_t* dst = patch;
+  for (int y = in_y; y < in_y + 3; y++) {
+    const bool row_inside = y >= 0 && y < input_height;
+    const int8_t* row = input_data + y * input_width * 3;
+    for (int x = in_x; x < in_x + 3; x++) {
+      *(dst++) = (row_inside && x >= 0 && x < input_width)
+                     ? PackRgb(row + x * 3)
+                     : pad_word;
+    }
+  }
+  *dst = 0;
+  const uint32_t* patch_ptr = patch;
+  LoadInputValues(patch_ptr, kRgbPatchWords);
+}
+
+// Fixed-point per-channel-quantization 3x3 convolution of an RGB image.
+void Mnv2ConvPerChannel3x3Rgb(
+    const ConvParams& params, const int32_t* output_multiplier,
+    const int32_t* output_shift, const RuntimeShape& input_shape,
+    const int8_t* input_data, const RuntimeShape& filter_shape,
+    const int8_t* filter_data, const RuntimeShape& bias_shape,
+    const int32_t* bias_data, const RuntimeShape& output_shape,
+    int8_t* output_data) {
+  PERF_START(2);
+  // Get parameters.
+  const int32_t input_offset = params.input_offset;  // r = s(q - Z)
+  const int stride_width = params.stride_width;
+  const int stride_height = params.stride_height;
+  const int pad_width = params.padding_values.width;
+  const int pad_height = params.padding_values.height;
+
+  // Consistency check
+  TFLITE_DCHECK_LE(params.quantized_activation_min,
+                   params.quantized_activation_max);
+  TFLITE_DCHECK_EQ(MatchingDim(input_shape, 3, filter_shape, 3), 3);
+  TFLITE_DCHECK_EQ(filter_shape.Dims(1), 3);
+  TFLITE_DCHECK_EQ(filter_shape.Dims(2), 3);
+  const int output_depth = MatchingDim(filter_shape, 0, output_shape, 3);
+  TFLITE_DCHECK_LE(output_depth, MNV2_RGB_MAX_OUTPUT_DEPTH);
+  if (bias_data) {
+    TFLITE_DCHECK_EQ(bias_shape.FlatSize(), output_depth);
+  }
+  const int input_height = input_shape.Dims(1);
+  const int input_width = input_shape.Dims(2);
+  const int output_height = output_shape.Dims(1);
+  const int output_width = output_shape.Dims(2);
+
+  // Set parameters for op
+  CFU_SET_INPUT_DEPTH_WORDS(kRgbPatchWords);
+  CFU_SET_OUTPUT_DEPTH(output_depth);
+  CFU_SET_INPUT_OFFSET(input_offset);
+  CFU_SET_OUTPUT_OFFSET(params.output_offset);
+  CFU_SET_ACTIVATION_MIN(params.quantized_activation_min);
+  CFU_SET_ACTIVATION_MAX(params.quantized_activation_max);
+
+  // Padding takes the input zero point, so that it adds nothing to the sum
+  const uint32_t pad_word = (-input_offset & 0xff) * 0x00010101;
+
+  PackRgbFilter(filter_data, output_depth);
+  const uint32_t* filter_words = rgb_filter_words;
+  const int num_pixels = output_height * output_width;
+  const int channels_per_batch =
+      CalculateChannelsPerBatch(kRgbPatchValues, output_depth);
+  const int num_batches =
+      (channels_per_batch - 1 + output_depth) / channels_per_batch;
+  PERF_END(2);
+
+  for (int batch = 0; batch < num_batches; batch++) {
+    const int batch_base = batch * channels_per_batch;
+    const int batch_end =
+        std::min(output_depth, batch_base + channels_per_batch);
+    const int batch_size = batch_end - batch_base;
+
+    LoadOutputChannelWeights(output_multiplier, output_shift, bias_data,
+                             batch_size);
+    LoadFilterValues(filter_words, batch_size * kRgbPatchWords);
+
+    PERF_START(5);
+    uint32_t* output_ptr = (uint32_t*)(output_data + batch_base);
+
+    // As for 1x1, load one pixel ahead, so that the CFU always has the next
+    // pixel's input when it finishes the current one.
+    LoadRgbPatch(input_data, input_height, input_width, -pad_height,
+                 -pad_width, pad_word);
+    for (int p = 1; p <= num_pixels; p++) {
+      if (p < num_pixels) {
+        const int out_y = p / output_width;
+        const int out_x = p - out_y * output_width;
+        LoadRgbPatch(input_data, input_height, input_width,
+                     out_y * stride_height - pad_height,
+                     out_x * stride_width - pad_width, pad_word);
+      }
+      CFU_MACC_RUN();
+      UnloadOutputValues(output_ptr, batch_size / 4);
+      output_ptr += (output_depth - batch_size) / 4;
+    }
+    PERF_END(5);
+  }
+}
+
 }  // namespace reference_integer_ops
 }  // namespace tflite
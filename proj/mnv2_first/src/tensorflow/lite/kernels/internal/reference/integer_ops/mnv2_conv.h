@@ -33,7 +33,21 @@ void Mnv2ConvPerChannel1x1(
     const int8_t* filter_data, const RuntimeShape& bias_shape,
     const int32_t* bias_data, const RuntimeShape& output_shape,
     int8_t* output_data);
-    
+
+// Maximum output depth supported by Mnv2ConvPerChannel3x3Rgb
+#define MNV2_RGB_MAX_OUTPUT_DEPTH 64
+
+// Fixed-point per-channel-quantization 3x3 convolution of an RGB image, as
+// found in the first layer of MobileNet v2. Each 3x3x3 patch is packed, with
+// channels padded to four, so that it can be run as a 1x1 conv on the CFU.
+void Mnv2ConvPerChannel3x3Rgb(
+    const ConvParams& params, const int32_t* output_multiplier,
+    const int32_t* output_shift, const RuntimeShape& input_shape,
+    const int8_t* input_data, const RuntimeShape& filter_shape,
+    const int8_t* filter_data, const RuntimeShape& bias_shape,
+    const int32_t* bias_data, const RuntimeShape& output_shape,
+    int8_t* output_data);
+
 }  // namespace reference_integer_ops
 }  // namespace tflite
 
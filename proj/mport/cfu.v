@@ -35,24 +35,123 @@ module Cfu (
   input     [31:0]    port3_din,
 );
 
-  reg cmd_valid_delay;
-  always @(posedge clk) if (rsp_ready) cmd_valid_delay <= cmd_valid;
+  // op0: reads word address inputs_1 from the bank given by inputs_0. Used
+  //      to check how the arena is striped across banks.
+  // op1: int8 dot product of the two arena words at word offsets inputs_0
+  //      and inputs_1. Words in different banks are read in the same cycle;
+  //      words in the same bank take a cycle each.
+  wire [2:0] funct3 = cmd_payload_function_id[2:0];
 
-  // one clcok latency on the memory access
-  assign rsp_valid = cmd_valid_delay;
-  assign cmd_ready = rsp_ready;
+  // Arena word offsets are striped across the banks: bank in the low two
+  // bits, address within the bank above them
+  wire [1:0]  bank_a = cmd_payload_inputs_0[1:0];
+  wire [1:0]  bank_b = cmd_payload_inputs_1[1:0];
+  wire [13:0] row_a  = cmd_payload_inputs_0[15:2];
+  wire [13:0] row_b  = cmd_payload_inputs_1[15:2];
 
-  // spam address to all banks
-  assign port0_addr = cmd_payload_inputs_1;
-  assign port1_addr = cmd_payload_inputs_1;
-  assign port2_addr = cmd_payload_inputs_1;
-  assign port3_addr = cmd_payload_inputs_1;
+  localparam IDLE = 3'd0, READ_BANK = 3'd1, READ_A = 3'd2, READ_B = 3'd3,
+             RESPOND = 3'd4;
+  reg [2:0]  state;
+  reg [1:0]  sel_a;
+  reg [1:0]  sel_b;
+  reg [13:0] row_b_held;
+  reg        same_bank;
+  reg [31:0] word_a_held;
+  reg [31:0] result;
 
-  // pick result
-  reg [1:0] bank_sel;
-  always @(posedge clk) if (rsp_ready) bank_sel <= cmd_payload_inputs_0;
-  assign rsp_payload_outputs_0 = bank_sel[1] ? (bank_sel[0] ? port3_din : port2_din)
-                                             : (bank_sel[0] ? port1_din : port0_din);
+  assign cmd_ready = state == IDLE;
+  assign rsp_valid = state == RESPOND;
+  assign rsp_payload_outputs_0 = result;
 
+  // Port addresses
+  reg [13:0] addr0, addr1, addr2, addr3;
+  assign port0_addr = addr0;
+  assign port1_addr = addr1;
+  assign port2_addr = addr2;
+  assign port3_addr = addr3;
+
+  always @(*) begin
+    // spam address to all banks for op0
+    addr0 = cmd_payload_inputs_1[13:0];
+    addr1 = cmd_payload_inputs_1[13:0];
+    addr2 = cmd_payload_inputs_1[13:0];
+    addr3 = cmd_payload_inputs_1[13:0];
+    if (state == IDLE && funct3 == 3'd1) begin
+      // Bank a takes priority if both are in the same bank
+      case (bank_b)
+        2'd0: addr0 = row_b;
+        2'd1: addr1 = row_b;
+        2'd2: addr2 = row_b;
+        2'd3: addr3 = row_b;
+      endcase
+      case (bank_a)
+        2'd0: addr0 = row_a;
+        2'd1: addr1 = row_a;
+        2'd2: addr2 = row_a;
+        2'd3: addr3 = row_a;
+      endcase
+    end else if (state == READ_A) begin
+      case (sel_b)
+        2'd0: addr0 = row_b_held;
+        2'd1: addr1 = row_b_held;
+        2'd2: addr2 = row_b_held;
+        2'd3: addr3 = row_b_held;
+      endcase
+    end
+  end
+
+  // Data read from each selected bank on the previous cycle
+  function [31:0] bank_data;
+    input [1:0] sel;
+    begin
+      case (sel)
+        2'd0: bank_data = port0_din;
+        2'd1: bank_data = port1_din;
+        2'd2: bank_data = port2_din;
+        2'd3: bank_data = port3_din;
+      endcase
+    end
+  endfunction
+
+  wire [31:0] word_a = same_bank ? word_a_held : bank_data(sel_a);
+  wire [31:0] word_b = bank_data(sel_b);
+
+  wire signed [15:0] prod0 = $signed(word_a[7:0])   * $signed(word_b[7:0]);
+  wire signed [15:0] prod1 = $signed(word_a[15:8])  * $signed(word_b[15:8]);
+  wire signed [15:0] prod2 = $signed(word_a[23:16]) * $signed(word_b[23:16]);
+  wire signed [15:0] prod3 = $signed(word_a[31:24]) * $signed(word_b[31:24]);
+  wire signed [31:0] dot = prod0 + prod1 + prod2 + prod3;
+
+  always @(posedge clk) begin
+    if (reset) begin
+      state <= IDLE;
+    end else begin
+      case (state)
+        IDLE: if (cmd_valid) begin
+          sel_a <= funct3 == 3'd1 ? bank_a : cmd_payload_inputs_0[1:0];
+          sel_b <= bank_b;
+          row_b_held <= row_b;
+          same_bank <= bank_a == bank_b;
+          if (funct3 != 3'd1) state <= READ_BANK;
+          else if (bank_a == bank_b) state <= READ_A;
+          else state <= READ_B;
+        end
+        READ_BANK: begin
+          result <= bank_data(sel_a);
+          state <= RESPOND;
+        end
+        READ_A: begin
+          word_a_held <= bank_data(sel_a);
+          state <= READ_B;
+        end
+        READ_B: begin
+          result <= dot;
+          state <= RESPOND;
+        end
+        RESPOND: if (rsp_ready) state <= IDLE;
+        default: state <= IDLE;
+      endcase
+    end
+  end
 
 endmodule
@@ -20,6 +20,7 @@
 
 #include "cfu.h"
 #include "menu.h"
+#include "perf.h"
 
 // to get ARENA_LRAM_BASE
 #include "generated/mem.h"
@@ -51,6 +52,58 @@ void do_mem(void) {
 
 
 
+// Words read from each operand by the bandwidth benchmark
+constexpr int kBandwidthWords = 1024;
+
+// Prints bytes per cycle to two decimal places
+void print_bytes_per_cycle(const char* label, int bytes, unsigned cycles) {
+  const unsigned hundredths = bytes * 100u / cycles;
+  printf("  %-24s %6u cycles, %u.%02u bytes/cycle\n", label, cycles,
+         hundredths / 100, hundredths % 100);
+}
+
+// Measures bytes per cycle achieved when reading two operands from the arena,
+// as a kernel does when combining two tensors. Operand a starts at bank 0 and
+// operand b at each bank in turn. When both start in the same bank, every
+// pair of words conflicts and costs an extra cycle; otherwise both words are
+// read together. BANK_AWARE_PLACEMENT controls which case tensors fall into.
+void do_bandwidth(void) {
+  int32_t* arena = reinterpret_cast<int32_t*>(ARENA_LRAM_BASE);
+  const int a_start = 0;
+  for (int i = 0; i < 3 * kBandwidthWords; ++i) {
+    arena[i] = i * 0x01030507;
+  }
+
+  puts("\nArena read bandwidth, two operands");
+  const int bytes = 2 * kBandwidthWords * 4;
+  for (int b_bank = 0; b_bank < 4; ++b_bank) {
+    const int b_start = kBandwidthWords + b_bank;
+
+    // Through the memory ports
+    int32_t cfu_sum = 0;
+    unsigned start = perf_get_mcycle();
+    for (int i = 0; i < kBandwidthWords; ++i) {
+      cfu_sum += cfu_op1(0, a_start + i, b_start + i);
+    }
+    unsigned cfu_cycles = perf_get_mcycle() - start;
+
+    // By the CPU, over the bus
+    int32_t cpu_sum = 0;
+    const int8_t* a = reinterpret_cast<int8_t*>(arena + a_start);
+    const int8_t* b = reinterpret_cast<int8_t*>(arena + b_start);
+    start = perf_get_mcycle();
+    for (int i = 0; i < kBandwidthWords * 4; ++i) {
+      cpu_sum += a[i] * b[i];
+    }
+    unsigned cpu_cycles = perf_get_mcycle() - start;
+
+    printf("b in bank %d%s\n", b_bank,
+           cfu_sum == cpu_sum ? "" : " - MISMATCH");
+    print_bytes_per_cycle("CFU memory ports", bytes, cfu_cycles);
+    print_bytes_per_cycle("CPU", bytes, cpu_cycles);
+  }
+}
+
 // Test template instruction
 void do_grid_cfu_op0(void) {
   puts("\nExercise CFU Op0\n");
@@ -92,6 +145,7 @@ struct Menu MENU = {
     "project",
     {
         MENU_ITEM('m', "exercise direct cfu-mem accesses", do_mem),
+        MENU_ITEM('b', "arena bandwidth, by bank", do_bandwidth),
         MENU_ITEM('0', "exercise cfu op0", do_exercise_cfu_op0),
         MENU_ITEM('g', "grid cfu op0", do_grid_cfu_op0),
         MENU_ITEM('h', "say Hello", do_hello_world),
@@ -0,0 +1,46 @@
+// Copyright 2021 The CFU-Playground Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "proj_tflite.h"
+
+#include "bank_planner.h"
+#include "tensorflow/lite/schema/schema_utils.h"
+
+void tflite_preload(const unsigned char* model_data, unsigned int model_length) {}
+void tflite_postload() {}
+void tflite_register_fusions() {}
+void tflite_register_kernels() {}
+
+// Starts the second input of each Add and Mul two banks after the first, so
+// that a kernel reading both through the memory ports fetches a word of each
+// in the same cycle. See the bandwidth benchmark in proj_menu.cc. No such
+// kernel exists yet, which is why the Makefile leaves BANK_AWARE_PLACEMENT
+// off.
+bool tflite_tensor_placement(const tflite::Model* model, int tensor,
+                             TensorPlacement* placement) {
+  const tflite::SubGraph* subgraph = model->subgraphs()->Get(0);
+  for (size_t i = 0; i < subgraph->operators()->size(); ++i) {
+    const tflite::Operator* op = subgraph->operators()->Get(i);
+    const tflite::BuiltinOperator code = tflite::GetBuiltinCode(
+        model->operator_codes()->Get(op->opcode_index()));
+    if ((code == tflite::BuiltinOperator_ADD ||
+         code == tflite::BuiltinOperator_MUL) &&
+        op->inputs()->size() == 2 && op->inputs()->Get(1) == tensor &&
+        op->inputs()->Get(0) != tensor) {
+      *placement = BankPlacement(2);
+      return true;
+    }
+  }
+  return false;
+}
@@ -17,11 +17,31 @@
 #include <stdint.h>
 #include "software_cfu.h"
 
+#include "generated/mem.h"
+
+namespace {
+
+// The arena, as the CFU sees it through the memory ports
+int32_t arena_word(uint32_t bank, uint32_t row) {
+  return reinterpret_cast<int32_t*>(ARENA_LRAM_BASE)[row * 4 + (bank & 3)];
+}
+
+}  // anonymous namespace
+
 //
 // In this function, place C code to emulate your CFU. You can switch between
 // hardware and emulated CFU by setting the CFU_SOFTWARE_DEFINED DEFINE in
 // the Makefile.
 uint32_t software_cfu(int funct3, int funct7, uint32_t rs1, uint32_t rs2)
 {
-  return (funct3 & 1) ? rs2 : rs1;
+  if (funct3 != 1) {
+    return arena_word(rs1, rs2 & 0x3fff);
+  }
+  const int32_t a = arena_word(rs1 & 3, (rs1 >> 2) & 0x3fff);
+  const int32_t b = arena_word(rs2 & 3, (rs2 >> 2) & 0x3fff);
+  int32_t dot = 0;
+  for (int i = 0; i < 32; i += 8) {
+    dot += static_cast<int8_t>(a >> i) * static_cast<int8_t>(b >> i);
+  }
+  return dot;
 }
@@ -45,6 +45,11 @@
 #
 # To run in simulation:
 # $ make load PLATFORM=sim
+#
+# To save a simulation checkpoint just before the first Invoke(), then
+# continue from it without booting and loading the model again:
+# $ make checkpoint PLATFORM=sim
+# $ make resume PLATFORM=sim SIM_CHECKPOINT_INPUT_SEED=1
 
 export UART_SPEED ?= 1843200
 export PROJ       := $(lastword $(subst /, ,${CURDIR}))
@@ -186,6 +191,11 @@ endif
 
 BUILD_JOBS ?= 1
 
+# Simulation checkpoint, see soc/sim_checkpoint.py
+SIM_CHECKPOINT ?= $(BUILD_DIR)/sim.checkpoint
+SIM_CHECKPOINT_INPUT_SEED ?=
+SIM_CHECKPOINT_TRACE_OP ?=
+
 .PHONY:	renode
 renode: renode-scripts
 	@echo Running interactively under renode
@@ -195,9 +205,14 @@ renode: renode-scripts
 renode-headless: renode-scripts
 	pushd $(BUILD_DIR)/renode/ && $(RENODE_DIR)/renode --console --disable-xwt --hide-log -e "s @$(TARGET).resc ; uart_connect sysbus.uart" && popd
 
+# Records instruction count baselines, see scripts/renode_perf_gate.py
+ifneq '$(UPDATE_INSTRUCTION_COUNTS)' ''
+  RENODE_TEST_ARGS += --variable UPDATE_INSTRUCTION_COUNTS:1
+endif
+
 .PHONY:	renode-test
 renode-test: renode-scripts
-	$(RENODE_DIR)/renode-test $(BUILD_DIR)/renode/$(TARGET).robot
+	$(RENODE_DIR)/renode-test $(RENODE_TEST_ARGS) $(BUILD_DIR)/renode/$(TARGET).robot
 
 .PHONY: renode-scripts
 renode-scripts: $(SOFTWARE_ELF)
@@ -289,7 +304,7 @@ litex-software: $(CFU_VERILOG)
 	$(SOC_MK) litex-software
 
 TTY_TARGETS := load unit run
-.PHONY: $(TTY_TARGETS) prog bitstream run-renode unit-renode
+.PHONY: $(TTY_TARGETS) prog bitstream run-renode unit-renode checkpoint resume
 
 ifneq 'sim' '$(PLATFORM)'
 # $(PLATFORM) == 'common_soc' or 'hps'
@@ -354,6 +369,15 @@ unit: $(SOFTWARE_BIN)
 	@echo Running unit test in Verilator simulation
 	$(BUILD_DIR)/interact.expect s $(TEST_MENU_ITEMS) |& tee $(UNITTEST_LOG)
 
+checkpoint: $(CFU_VERILOG) $(SOFTWARE_BIN)
+	SIM_CHECKPOINT_SAVE=$(SIM_CHECKPOINT) $(SIM_MK) run
+
+resume:
+	SIM_CHECKPOINT_RESTORE=$(SIM_CHECKPOINT) \
+	SIM_CHECKPOINT_INPUT_SEED=$(SIM_CHECKPOINT_INPUT_SEED) \
+	SIM_CHECKPOINT_TRACE_OP=$(SIM_CHECKPOINT_TRACE_OP) \
+	$(SIM_MK) resume
+
 prog bitstream run:
 	@echo Target not supported when PLATFORM=sim
 
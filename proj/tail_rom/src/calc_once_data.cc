@@ -25,6 +25,20 @@
 
 namespace calculate_once {
 
+namespace {
+
+// Identifies the model and which buffers are cached for it, so that a cache
+// captured without TAIL_ROM_OP_DATA is not used with it, and vice versa.
+uint32_t CacheHash(const unsigned char* model_data, unsigned int model_length) {
+  uint32_t hash = murmurhash3_32(model_data, model_length);
+#ifdef TAIL_ROM_OP_DATA
+  hash ^= 0x0bda7a00;
+#endif
+  return hash;
+}
+
+}  // anonymous namespace
+
 // Reset this this object
 void Capturer::Start(const unsigned char* model_data,
                      unsigned int model_length) {
@@ -34,7 +48,7 @@ void Capturer::Start(const unsigned char* model_data,
   printf("#include \"calc_once_data.h\"\n\n");
   printf("namespace {\n");
   printf("uint32_t model_hash = 0x%08lx;\n",
-         murmurhash3_32(model_data, model_length));
+         CacheHash(model_data, model_length));
   printf(CAPTURE_END);
   sequence_counter_ = 0;
 }
@@ -101,7 +115,7 @@ bool Cache::InitForModel(const unsigned char* model_data,
   }
 
   // Check whether hash matches
-  uint32_t hash = murmurhash3_32(model_data, model_length);
+  uint32_t hash = CacheHash(model_data, model_length);
   if (hash != model_hash_) {
     return false;
   }
@@ -17,6 +17,7 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
 
 // Functions to support capturing, storing and returning data that can be
 // calculated once and placed into ROM.
@@ -97,6 +98,35 @@ void SetCache(Cache* cache);
 // cache is set.
 Cache* GetCache();
 
+// Fills an op's data from the next cached buffer. Returns false, leaving
+// op_data unchanged, if there is no cached buffer for it. The caller should
+// then calculate op_data and pass it to CaptureOpData().
+//
+// Op data is only cached when TAIL_ROM_OP_DATA is defined. Otherwise, only
+// per-channel conv and depthwise conv data are cached.
+template <typename T>
+bool FetchOpData(T* op_data) {
+  static_assert(sizeof(T) % sizeof(int32_t) == 0, "OpData not whole words");
+#ifdef TAIL_ROM_OP_DATA
+  const int32_t* cached =
+      GetCache()->FetchNextBuffer(sizeof(T) / sizeof(int32_t));
+  if (cached) {
+    memcpy(op_data, cached, sizeof(T));
+    return true;
+  }
+#endif
+  return false;
+}
+
+// Captures an op's data, if capturing
+template <typename T>
+void CaptureOpData(const T* op_data) {
+#ifdef TAIL_ROM_OP_DATA
+  capturer.Capture(reinterpret_cast<const int32_t*>(op_data),
+                   sizeof(T) / sizeof(int32_t));
+#endif
+}
+
 }  // namespace calculate_once
 
 #endif  // _CALC_ONCE_DATA_H
\ No newline at end of file
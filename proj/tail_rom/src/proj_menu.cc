@@ -15,12 +15,16 @@
  */
 
 #include <stdio.h>
+#include <string.h>
 
+#include "boot_timer.h"
 #include "calc_once_data.h"
 #include "menu.h"
 #include "proj_menu.h"
+#include "tflite.h"
 
 #ifdef TAIL_ROM_USE
+#include "models/pdti8/model_pdti8.h"
 #include "pdti8_cache.h"
 #endif
 
@@ -36,12 +40,44 @@ void do_set_pdti8() {
 #endif
 }
 
+// Returns the cycles taken by AllocateTensors(), which runs the Prepare of
+// every op, when the current model was loaded
+uint64_t prepare_cycles() {
+  tflite_prepare();
+  for (int i = 1; i < boot_timer_count(); i++) {
+    if (strcmp(boot_timer_name(i), "AllocateTensors") == 0) {
+      return boot_timer_cycles(i) - boot_timer_cycles(i - 1);
+    }
+  }
+  return 0;
+}
+
+// Loads pdti8 without and then with its cache
+void do_compare_pdti8() {
+#ifdef TAIL_ROM_USE
+  calculate_once::SetCache(NULL);
+  tflite_load_model(model_pdti8, model_pdti8_len);
+  const uint64_t uncached = prepare_cycles();
+
+  calculate_once::SetCache(GetCachePdti8());
+  tflite_load_model(model_pdti8, model_pdti8_len);
+  const uint64_t cached = prepare_cycles();
+
+  printf("Prepare cycles without cache: %llu\n", uncached);
+  printf("Prepare cycles with cache:    %llu\n", cached);
+#else
+  puts("Not configured to use tail rom.");
+#endif
+}
+
 struct Menu MENU = {
     "Project Menu",
     "project",
     {
         MENU_ITEM('0', "reset cache", do_reset_cache),
         MENU_ITEM('1', "Set cache for pdti8", do_set_pdti8),
+        MENU_ITEM('2', "Compare pdti8 Prepare time, with and without cache",
+                  do_compare_pdti8),
         MENU_END,
     },
 };
@@ -38,4 +38,14 @@ void tflite_preload(const unsigned char* model_data,
 }
 
 // Finish capture
-void tflite_postload() { calculate_once::capturer.Finish(); }
\ No newline at end of file
+void tflite_postload() { calculate_once::capturer.Finish(); }
+
+// No fusions: cached conv data is keyed on the unmodified model
+void tflite_register_fusions() {}
+void tflite_register_kernels() {}
+
+// Tensors are placed as usual
+bool tflite_tensor_placement(const tflite::Model* model, int tensor,
+                             TensorPlacement* placement) {
+  return false;
+}
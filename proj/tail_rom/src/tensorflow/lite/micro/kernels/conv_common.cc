@@ -108,12 +108,20 @@ TfLiteStatus CalculateOpDataConv(TfLiteContext* context, TfLiteNode* node,
   if (data_type != kTfLiteFloat32) {
     int output_channels = filter->dims->data[kConvQuantizedDimension];
 
-    TF_LITE_ENSURE_STATUS(tflite::PopulateConvolutionQuantizationParams(
-        context, input, filter, bias, output, params.activation,
-        &data->output_multiplier, &data->output_shift,
-        &data->output_activation_min, &data->output_activation_max,
-        data->per_channel_output_multiplier, data->per_channel_output_shift,
-        output_channels));
+    // CFU-Playground: cached per-channel data is not recalculated. Only the
+    // activation range is needed.
+    if (!data->per_channel_output_multiplier) {
+      TF_LITE_ENSURE_STATUS(CalculateActivationRangeQuantized(
+          context, params.activation, output, &data->output_activation_min,
+          &data->output_activation_max));
+    } else {
+      TF_LITE_ENSURE_STATUS(tflite::PopulateConvolutionQuantizationParams(
+          context, input, filter, bias, output, params.activation,
+          &data->output_multiplier, &data->output_shift,
+          &data->output_activation_min, &data->output_activation_max,
+          data->per_channel_output_multiplier, data->per_channel_output_shift,
+          output_channels));
+    }
   }
 
   data->input_zero_point = input->params.zero_point;
@@ -156,16 +164,15 @@ TfLiteStatus ConvPrepare(TfLiteContext* context, TfLiteNode* node) {
 
   // CFU-Playground: If there were stored buffers, then save them for later,
   // otherwise allocate storage
+  const bool cached = cached_output_multiplier && cached_output_shift;
   data->per_channel_output_multiplier =
-      cached_output_multiplier
-          ? NULL
-          : static_cast<int32_t*>(context->AllocatePersistentBuffer(
-                context, num_channels * sizeof(int32_t)));
+      cached ? NULL
+             : static_cast<int32_t*>(context->AllocatePersistentBuffer(
+                   context, num_channels * sizeof(int32_t)));
   data->per_channel_output_shift =
-      cached_output_shift
-          ? NULL
-          : static_cast<int32_t*>(context->AllocatePersistentBuffer(
-                context, num_channels * sizeof(int32_t)));
+      cached ? NULL
+             : static_cast<int32_t*>(context->AllocatePersistentBuffer(
+                   context, num_channels * sizeof(int32_t)));
 
   // All per-channel quantized tensors need valid zero point and scale arrays.
   if (input->type == kTfLiteInt8) {
@@ -191,10 +198,8 @@ TfLiteStatus ConvPrepare(TfLiteContext* context, TfLiteNode* node) {
       filter_height, output_width, output_height, input->type, data));
 
   // CFU-Playground: Set the stored buffers we had been saving
-  if (cached_output_multiplier) {
+  if (cached) {
     data->per_channel_output_multiplier = cached_output_multiplier;
-  }
-  if (cached_output_shift) {
     data->per_channel_output_shift = cached_output_shift;
   }
 
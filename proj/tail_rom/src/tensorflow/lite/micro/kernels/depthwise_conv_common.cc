@@ -109,12 +109,20 @@ TfLiteStatus CalculateOpDataDepthwiseConv(
   if (data_type != kTfLiteFloat32) {
     int output_channels = filter->dims->data[kDepthwiseConvQuantizedDimension];
 
-    TF_LITE_ENSURE_STATUS(tflite::PopulateConvolutionQuantizationParams(
-        context, input, filter, bias, output, params.activation,
-        &data->output_multiplier, &data->output_shift,
-        &data->output_activation_min, &data->output_activation_max,
-        data->per_channel_output_multiplier, data->per_channel_output_shift,
-        output_channels));
+    // CFU-Playground: cached per-channel data is not recalculated. Only the
+    // activation range is needed.
+    if (!data->per_channel_output_multiplier) {
+      TF_LITE_ENSURE_STATUS(CalculateActivationRangeQuantized(
+          context, params.activation, output, &data->output_activation_min,
+          &data->output_activation_max));
+    } else {
+      TF_LITE_ENSURE_STATUS(tflite::PopulateConvolutionQuantizationParams(
+          context, input, filter, bias, output, params.activation,
+          &data->output_multiplier, &data->output_shift,
+          &data->output_activation_min, &data->output_activation_max,
+          data->per_channel_output_multiplier, data->per_channel_output_shift,
+          output_channels));
+    }
   }
 
   data->input_zero_point = input->params.zero_point;
@@ -179,16 +187,15 @@ TfLiteStatus DepthwiseConvPrepare(TfLiteContext* context, TfLiteNode* node) {
 
   // CFU-Playground: If there were stored buffers, then save them for later,
   // otherwise allocate storage
+  const bool cached = cached_output_multiplier && cached_output_shift;
   data->per_channel_output_multiplier =
-      cached_output_multiplier
-          ? NULL
-          : static_cast<int32_t*>(context->AllocatePersistentBuffer(
-                context, num_channels * sizeof(int32_t)));
+      cached ? NULL
+             : static_cast<int32_t*>(context->AllocatePersistentBuffer(
+                   context, num_channels * sizeof(int32_t)));
   data->per_channel_output_shift =
-      cached_output_shift
-          ? NULL
-          : static_cast<int32_t*>(context->AllocatePersistentBuffer(
-                context, num_channels * sizeof(int32_t)));
+      cached ? NULL
+             : static_cast<int32_t*>(context->AllocatePersistentBuffer(
+                   context, num_channels * sizeof(int32_t)));
 
   // CFU-Playground: If there were stored buffers, no attempt will be made to
   // recalculate
@@ -197,10 +204,8 @@ TfLiteStatus DepthwiseConvPrepare(TfLiteContext* context, TfLiteNode* node) {
       filter_height, output_width, output_height, input->type, data));
 
   // CFU-Playground: Set the stored buffers we had been saving
-  if (cached_output_multiplier) {
+  if (cached) {
     data->per_channel_output_multiplier = cached_output_multiplier;
-  }
-  if (cached_output_shift) {
     data->per_channel_output_shift = cached_output_shift;
   }
 
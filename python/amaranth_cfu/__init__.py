@@ -16,4 +16,5 @@
 
 __package__ = 'amaranth_cfu'
 from .cfu import *
+from .perf_counters import *
 from .util import *
@@ -0,0 +1,83 @@
+#!/usr/bin/env python3
+# Copyright 2021 The CFU-Playground Authors
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     https://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+"""Performance counters for CFUs"""
+
+__package__ = 'amaranth_cfu'
+
+from amaranth import Signal
+from .util import SimpleElaboratable
+
+__all__ = ['PerfCounters']
+
+
+class PerfCounters(SimpleElaboratable):
+    """Counts cycles spent by a CFU in each of four states.
+
+    Every cycle is counted in exactly one counter. Output blocked takes
+    priority over busy, and busy takes priority over input starved. A cycle
+    that is none of these is counted as idle.
+
+    Attributes
+    ----------
+
+    reset: Signal(), in
+        Zeros all counters.
+
+    busy: Signal(), in
+        High while the CFU is doing useful work.
+
+    input_starved: Signal(), in
+        High while the CFU is waiting for the CPU to supply input,
+        parameters or a start command.
+
+    output_blocked: Signal(), in
+        High while the CFU has output that cannot be accepted.
+
+    busy_count: Signal(32), out
+    input_starved_count: Signal(32), out
+    output_blocked_count: Signal(32), out
+    idle_count: Signal(32), out
+        Number of cycles spent in each state since last reset.
+    """
+
+    def __init__(self):
+        self.reset = Signal()
+        self.busy = Signal()
+        self.input_starved = Signal()
+        self.output_blocked = Signal()
+        self.busy_count = Signal(32)
+        self.input_starved_count = Signal(32)
+        self.output_blocked_count = Signal(32)
+        self.idle_count = Signal(32)
+
+    def elab(self, m):
+        with m.If(self.reset):
+            m.d.sync += [
+                self.busy_count.eq(0),
+                self.input_starved_count.eq(0),
+                self.output_blocked_count.eq(0),
+                self.idle_count.eq(0),
+            ]
+        with m.Elif(self.output_blocked):
+            m.d.sync += self.output_blocked_count.eq(
+                self.output_blocked_count + 1)
+        with m.Elif(self.busy):
+            m.d.sync += self.busy_count.eq(self.busy_count + 1)
+        with m.Elif(self.input_starved):
+            m.d.sync += self.input_starved_count.eq(
+                self.input_starved_count + 1)
+        with m.Else():
+            m.d.sync += self.idle_count.eq(self.idle_count + 1)
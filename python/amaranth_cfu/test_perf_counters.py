@@ -0,0 +1,70 @@
+#!/usr/bin/env python3
+# Copyright 2021 The CFU-Playground Authors
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     https://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+"""Tests for perf_counters.py"""
+
+__package__ = 'amaranth_cfu'
+
+from amaranth.sim import Delay
+
+from .perf_counters import PerfCounters
+from .util import TestBase
+
+
+class PerfCountersTest(TestBase):
+    """Tests PerfCounters class."""
+
+    def create_dut(self):
+        return PerfCounters()
+
+    def test_it(self):
+        dut = self.dut
+
+        DATA = [
+            # (reset, busy, input_starved, output_blocked),
+            # (busy, starved, blocked, idle) counts before this cycle
+            ((1, 0, 0, 0), None),
+            ((0, 0, 0, 0), (0, 0, 0, 0)),
+            ((0, 0, 1, 0), (0, 0, 0, 1)),
+            ((0, 0, 1, 0), (0, 1, 0, 1)),
+            ((0, 1, 0, 0), (0, 2, 0, 1)),
+            ((0, 1, 0, 0), (1, 2, 0, 1)),
+            # Blocked has priority over busy
+            ((0, 1, 0, 1), (2, 2, 0, 1)),
+            # Busy has priority over starved
+            ((0, 1, 1, 0), (2, 2, 1, 1)),
+            ((0, 0, 0, 0), (3, 2, 1, 1)),
+            # Reset has priority over everything
+            ((1, 1, 1, 1), (3, 2, 1, 2)),
+            ((0, 1, 0, 0), (0, 0, 0, 0)),
+            ((0, 0, 0, 0), (1, 0, 0, 0)),
+        ]
+
+        def process():
+            for (reset, busy, starved, blocked), expected in DATA:
+                yield dut.reset.eq(reset)
+                yield dut.busy.eq(busy)
+                yield dut.input_starved.eq(starved)
+                yield dut.output_blocked.eq(blocked)
+                yield Delay(0.1)
+                if expected is not None:
+                    actual = ((yield dut.busy_count),
+                              (yield dut.input_starved_count),
+                              (yield dut.output_blocked_count),
+                              (yield dut.idle_count))
+                    self.assertEqual(actual, expected)
+                yield
+
+        self.run_sim(process, False)
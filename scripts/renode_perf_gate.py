@@ -0,0 +1,186 @@
+#!/usr/bin/env python3
+# Copyright 2021 The CFU-Playground Authors
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#      http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+"""Robot Framework library that checks instruction counts in Renode.
+
+Renode counts one cycle for each instruction executed, so the cycle counts
+that the firmware prints after each inference are instruction counts, and
+do not vary from run to run. This library reads them from the UART and
+compares them against a baseline checked in with the project:
+
+  * the "N cycles total" line, for the whole inference, and
+  * the "Event","Tag","Cycles" CSV, for each op. This is not printed when
+    the firmware is built with NPROFILE.
+
+A count fails the check when it grows by more than the tolerance given in
+the baseline file. A test missing from a target's baseline fails too. A
+target with no baselines at all is skipped, not passed, so that the report
+shows it is not yet gated. To record or update a baseline, run the tests
+with the Robot variable UPDATE_INSTRUCTION_COUNTS set, e.g. with make
+renode-test UPDATE_INSTRUCTION_COUNTS=1, and check in the changed file.
+
+Use it from a project's robot file like this:
+
+  Library                   ${CURDIR}/../../../../scripts/renode_perf_gate.py
+  ...
+  Check Instruction Counts  ${CURDIR}/../../ci/instruction_counts.json
+  ...                       TARGET  pdti8_zeros
+"""
+
+import collections
+import json
+import os
+import re
+
+from robot.api import SkipExecution, logger
+from robot.libraries.BuiltIn import BuiltIn
+
+# Only this is a keyword
+__all__ = ['check_instruction_counts']
+
+CYCLES_HEADER = r'^"Event","Tag","Cycles"$'
+OP_LINE = r'^(\d+),([^,]+),(\d+)$'
+EVENTS_LINE = r'^(\d+) cycles in events$'
+TOTAL_LINE = r'\(\s*(\d+)\) cycles total$'
+
+UPDATE_VARIABLE = '${UPDATE_INSTRUCTION_COUNTS}'
+
+DEFAULT_TOLERANCE_PERCENT = 1.0
+DEFAULT_TOLERANCE_MIN = 1000
+
+
+def _line_of(result):
+    """Gets the line matched from a Wait For Line On Uart result."""
+    if isinstance(result, str):
+        return result
+    if isinstance(result, dict):
+        return result.get('line', result.get('Line', ''))
+    return getattr(result, 'line', str(result))
+
+
+def _wait_for(pattern, timeout):
+    result = BuiltIn().run_keyword('Wait For Line On Uart', pattern, timeout,
+                                   'treatAsRegex=true')
+    return _line_of(result).strip()
+
+
+def read_counts(timeout):
+    """Reads the counts printed by one inference.
+
+    Returns a dict with the "inference" count, and the count of each op in
+    "ops", keyed by event number and tag.
+    """
+    ops = collections.OrderedDict()
+    line = _wait_for('{}|{}'.format(CYCLES_HEADER, TOTAL_LINE), timeout)
+    if re.match(CYCLES_HEADER, line):
+        while True:
+            line = _wait_for('{}|{}'.format(OP_LINE, EVENTS_LINE), timeout)
+            m = re.match(OP_LINE, line)
+            if not m:
+                break
+            ops['{} {}'.format(m.group(1), m.group(2))] = int(m.group(3))
+        line = _wait_for(TOTAL_LINE, timeout)
+    total = int(re.search(TOTAL_LINE, line).group(1))
+    return {'inference': total, 'ops': ops}
+
+
+def _allowed(baseline, settings):
+    percent = settings.get('tolerance_percent', DEFAULT_TOLERANCE_PERCENT)
+    minimum = settings.get('tolerance_min', DEFAULT_TOLERANCE_MIN)
+    return baseline + max(int(baseline * percent / 100), minimum)
+
+
+def compare_counts(counts, baseline, settings):
+    """Returns a list of failure messages for counts against a baseline."""
+    failures = []
+
+    def check(name, count, base):
+        limit = _allowed(base, settings)
+        if count > limit:
+            failures.append('{}: {} instructions, baseline {} (+{:.2f}%), '
+                            'limit {}'.format(name, count, base,
+                                              100.0 * (count - base) / base,
+                                              limit))
+        elif count < base:
+            logger.info('{}: {} instructions, down from {}'.format(
+                name, count, base))
+
+    check('inference', counts['inference'], baseline['inference'])
+    base_ops = baseline.get('ops', {})
+    if counts['ops'] and base_ops:
+        if list(counts['ops']) != list(base_ops):
+            failures.append('ops differ from baseline: {} now, {} before'
+                            .format(list(counts['ops']), list(base_ops)))
+        else:
+            for op, count in counts['ops'].items():
+                check(op, count, base_ops[op])
+    return failures
+
+
+def _load(path):
+    if not os.path.isfile(path):
+        return {'targets': {}}
+    with open(path, 'r') as f:
+        return json.load(f, object_pairs_hook=collections.OrderedDict)
+
+
+def _save(path, data):
+    with open(path, 'w') as f:
+        json.dump(data, f, indent=2)
+        f.write('\n')
+
+
+def _update_requested():
+    value = BuiltIn().get_variable_value(UPDATE_VARIABLE, '')
+    return str(value).lower() not in ('', '0', 'false', 'none')
+
+
+def check_instruction_counts(baseline_path, target, name, timeout='120'):
+    """Reads the counts for one inference and checks them.
+
+    The baseline file holds the counts for each target and test name, and
+    the tolerance applied to all of them: a count may grow by
+    tolerance_percent, or by tolerance_min instructions if that is more.
+    When UPDATE_INSTRUCTION_COUNTS is set, the counts are written to the
+    baseline file instead.
+    """
+    counts = read_counts(timeout)
+    logger.info('{} {}: {} instructions per inference, {} ops'.format(
+        target, name, counts['inference'], len(counts['ops'])),
+        also_console=True)
+    for op, count in counts['ops'].items():
+        logger.info('{}: {}'.format(op, count))
+
+    data = _load(baseline_path)
+    if _update_requested():
+        data.setdefault('targets', {}).setdefault(target, {})[name] = counts
+        _save(baseline_path, data)
+        logger.info('Updated {}'.format(baseline_path), also_console=True)
+        return
+
+    target_baselines = data.get('targets', {}).get(target)
+    if target_baselines is None:
+        raise SkipExecution(
+            'No baselines for {} in {}; record them with make renode-test '
+            'UPDATE_INSTRUCTION_COUNTS=1'.format(target, baseline_path))
+    baseline = target_baselines.get(name)
+    if baseline is None:
+        raise AssertionError(
+            'No baseline for {} {} in {}; record one with make renode-test '
+            'UPDATE_INSTRUCTION_COUNTS=1'.format(target, name, baseline_path))
+    failures = compare_counts(counts, baseline, data)
+    if failures:
+        raise AssertionError('Instruction counts grew beyond tolerance:\n' +
+                             '\n'.join(failures))
@@ -0,0 +1,188 @@
+#!/usr/bin/env python
+# Copyright 2021 The CFU-Playground Authors
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#      http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+"""Tests for tflite_pad_channels.py
+
+Run from this directory with:
+    python -m unittest test_tflite_pad_channels
+"""
+
+import os
+import random
+import struct
+import unittest
+
+import tflite_fb
+import tflite_pad_channels
+
+MODEL = os.path.join(os.path.dirname(__file__), '..', 'common', 'src',
+                     'models', 'hps_model',
+                     'hps_model_2022_01_05_89ops.tflite')
+
+
+def buffer_data(model, index):
+    return model.buffers[index].bytes(tflite_fb.BUFFER_DATA) or b''
+
+
+def data_bytes(model):
+    return sum(len(buffer_data(model, i)) for i in range(len(model.buffers)))
+
+
+def tensor_values(model, tensor, fmt):
+    index = tensor.table.scalar(tflite_fb.TENSOR_BUFFER, 'I')
+    data = buffer_data(model, index)
+    size = struct.calcsize(fmt)
+    return list(struct.unpack(f'<{len(data) // size}{fmt}', data))
+
+
+def quantization(tensor):
+    quant = tensor.table.table(tflite_fb.TENSOR_QUANTIZATION)
+    return (quant.scalar_vector(tflite_fb.QUANTIZATION_SCALE, 'f')[0],
+            quant.scalar_vector(tflite_fb.QUANTIZATION_ZERO_POINT, 'q')[0])
+
+
+def fully_connected(model, op, values):
+    """Runs an int8 FullyConnected op on the vector in values.
+
+    Requantizes in floating point, which is close enough to TFLM to compare
+    two models evaluated the same way.
+    """
+    tensors = model.tensors()
+    inputs = op.scalar_vector(tflite_fb.OPERATOR_INPUTS, 'i')
+    output = tensors[op.scalar_vector(tflite_fb.OPERATOR_OUTPUTS, 'i')[0]]
+    outputs, depth = tensors[inputs[1]].shape
+    weights = tensor_values(model, tensors[inputs[1]], 'b')
+    bias = tensor_values(model, tensors[inputs[2]], 'i')
+    input_scale, input_zero_point = quantization(tensors[inputs[0]])
+    weights_scale, _ = quantization(tensors[inputs[1]])
+    output_scale, output_zero_point = quantization(output)
+    relu = op.table(tflite_fb.OPERATOR_BUILTIN_OPTIONS).scalar(0, 'b') == 1
+    low = output_zero_point if relu else -128
+    result = []
+    for o in range(outputs):
+        row = weights[o * depth:(o + 1) * depth]
+        acc = bias[o] + sum(w * (v - input_zero_point)
+                            for w, v in zip(row, values))
+        q = round(acc * input_scale * weights_scale / output_scale) + \
+            output_zero_point
+        result.append(min(127, max(low, q)))
+    return result
+
+
+class PadChannelsTest(unittest.TestCase):
+
+    @classmethod
+    def setUpClass(cls):
+        with open(MODEL, 'rb') as f:
+            cls.model = tflite_fb.Model(f.read())
+        padder = tflite_pad_channels.Padder(cls.model)
+        for i, code in enumerate(padder.codes):
+            if code in (tflite_pad_channels.CONV_2D,
+                        tflite_pad_channels.FULLY_CONNECTED):
+                padder.pad_output(i, 16)
+        cls.shapes = padder.shapes
+        cls.padded = tflite_fb.Model(padder.write())
+
+    def test_shapes(self):
+        self.assertNotEqual([t.shape for t in self.model.tensors()],
+                            self.shapes)
+        self.assertEqual([t.shape for t in self.padded.tensors()],
+                         self.shapes)
+
+    def test_unpadded_constants_unchanged(self):
+        for old, new in zip(self.model.tensors(), self.padded.tensors()):
+            if old.is_constant and old.shape == new.shape:
+                self.assertEqual(
+                    buffer_data(self.model, old.table.scalar(
+                        tflite_fb.TENSOR_BUFFER, 'I')),
+                    buffer_data(self.padded, new.table.scalar(
+                        tflite_fb.TENSOR_BUFFER, 'I')),
+                    old.name)
+
+    def test_no_orphaned_buffers(self):
+        used = {t.table.scalar(tflite_fb.TENSOR_BUFFER, 'I')
+                for t in self.padded.tensors()}
+        used |= {b for _, b, _ in self.padded.metadata()}
+        for i in range(len(self.padded.buffers)):
+            if buffer_data(self.padded, i):
+                self.assertIn(i, used, f'buffer {i} has data but no user')
+
+    def test_no_orphaned_data(self):
+        # Apart from buffer data, the file grows only by new tables
+        old_rest = len(self.model.buf) - data_bytes(self.model)
+        new_rest = len(self.padded.buf) - data_bytes(self.padded)
+        self.assertLess(new_rest - old_rest, 4096)
+
+    def padded_fully_connected(self):
+        """Returns (op, old weights shape, new weights shape) of each
+        FullyConnected op whose weights were padded."""
+        old_tensors = self.model.tensors()
+        new_tensors = self.padded.tensors()
+        result = []
+        for i, op in enumerate(self.padded.operators()):
+            if self.padded.builtin_code(op) != \
+                    tflite_pad_channels.FULLY_CONNECTED:
+                continue
+            weights = op.scalar_vector(tflite_fb.OPERATOR_INPUTS, 'i')[1]
+            if old_tensors[weights].shape != new_tensors[weights].shape:
+                result.append((i, old_tensors[weights].shape,
+                               new_tensors[weights].shape))
+        return result
+
+    def test_padding_is_zero(self):
+        tensors = self.padded.tensors()
+        padded = self.padded_fully_connected()
+        self.assertTrue(padded)
+        for i, (rows, cols), (new_rows, new_cols) in padded:
+            op = self.padded.operators()[i]
+            inputs = op.scalar_vector(tflite_fb.OPERATOR_INPUTS, 'i')
+            weights = tensor_values(self.padded, tensors[inputs[1]], 'b')
+            for r in range(new_rows):
+                row = weights[r * new_cols:(r + 1) * new_cols]
+                if r >= rows:
+                    self.assertFalse(any(row), f'op {i} filter row {r}')
+                else:
+                    self.assertFalse(any(row[cols:]), f'op {i} row {r}')
+            bias = tensor_values(self.padded, tensors[inputs[2]], 'i')
+            self.assertEqual(len(bias), new_rows)
+            self.assertFalse(any(bias[rows:]), f'op {i} bias')
+
+    def test_same_results(self):
+        # Runs the chain of FullyConnected ops with padded weights, from the
+        # first padded output to the op that consumes the last, in both
+        # models. Only the padded outputs may differ, in their extra channels.
+        padded = [i for i, _, _ in self.padded_fully_connected()]
+        first, last = padded[0], padded[-1]
+        old_ops = self.model.operators()
+        new_ops = self.padded.operators()
+        depth = self.model.tensors()[old_ops[first].scalar_vector(
+            tflite_fb.OPERATOR_INPUTS, 'i')[0]].shape[-1]
+        rng = random.Random(0)
+        for _ in range(4):
+            old = new = [rng.randint(-128, 127) for _ in range(depth)]
+            for i in range(first, last + 1):
+                old = fully_connected(self.model, old_ops[i], old)
+                new = fully_connected(self.padded, new_ops[i], new)
+                self.assertEqual(old, new[:len(old)], f'op {i}')
+            self.assertEqual(old, new)
+
+    def test_offsets_valid(self):
+        for pos, (target, _) in tflite_fb.offset_locations(
+                self.padded.buf).items():
+            self.assertLess(target, len(self.padded.buf), pos)
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -0,0 +1,348 @@
+#!/usr/bin/env python
+# Copyright 2021 The CFU-Playground Authors
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#      http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+"""Derives a lower resolution variant of a row tiled HPS model.
+
+The HPS models split their input into bands of rows with StridedSlice ops,
+run each band through a chain of Pad, Conv2D and MaxPool ops, and join the
+bands with a Concatenation. Each band's Pads stand in for the SAME padding
+of the untiled network at the band's edges.
+
+This tool divides the input height and width by a factor, re-splits the
+rows of each Concatenation output between its bands and works out
+new StridedSlice bounds to match, so that each tiled section still computes
+the untiled network exactly. Every other tensor shape follows from the ops.
+
+The FullyConnected weights after the Reshape that flattens the last feature
+map are folded to the smaller map: each weight is added to the low
+resolution position covering its position, which matches the original model
+run on a nearest neighbour upscale of the smaller feature map. The sums are
+requantized with a new weights scale, and the bias with it.
+
+The result is not retrained, so its scores only approximate the original
+model's on the same scene. It suits a first pass that escalates uncertain
+frames to the full model, as the adaptive resolution benchmark in
+common/src/models/hps_model/hps_model.cc does.
+
+Usage:
+    tflite_downscale.py model.tflite -o lowres.tflite [--factor 2]
+
+Any offline memory plan is dropped. The checked in
+common/src/models/hps_model/hps_lowres_model.tflite was made with:
+    tflite_downscale.py hps_model_2022_01_05_74ops.tflite -o lowres.tflite
+    tflite_memory_planner.py lowres.tflite -o hps_lowres_model.tflite
+"""
+
+import argparse
+import struct
+import sys
+
+import tflite_fb
+import tflite_memory_planner
+import tflite_pad_channels
+from tflite_pad_channels import (CONV_2D, FULLY_CONNECTED, MAX_POOL_2D, PAD,
+                                 OPTIONS_PADDING, OPTIONS_STRIDE_H,
+                                 OPTIONS_STRIDE_W, POOL_FILTER_H,
+                                 POOL_FILTER_W, PADDING_VALID)
+
+# Builtin operator codes from schema.fbs, beyond those in tflite_pad_channels
+CONCATENATION = 2
+LOGISTIC = 14
+RESHAPE = 22
+STRIDED_SLICE = 45
+
+# StridedSliceOptions and ConcatenationOptions fields
+SLICE_BEGIN_MASK = 0
+SLICE_END_MASK = 1
+CONCAT_AXIS = 0
+
+HEIGHT = 1
+WIDTH = 2
+
+
+def ceil_div(n, d):
+    return -(-n // d)
+
+
+class Downscaler(tflite_pad_channels.Padder):
+    """Works out the shapes and constants of the downscaled model.
+
+    Reuses Padder's bookkeeping, so that write() produces the new model.
+    """
+
+    def __init__(self, model, factor):
+        super().__init__(model)
+        self.factor = factor
+        self.producer = {}
+        for i, outputs in enumerate(self.outputs):
+            for t in outputs:
+                self.producer[t] = i
+
+    def ints(self, t):
+        # Read without marking the constant as changed
+        c = self.constants.get(t) or \
+            tflite_pad_channels.Constant(self.model, self.tensors[t])
+        return list(struct.unpack(f'<{len(c.data) // 4}i', c.data))
+
+    def set_ints(self, t, values):
+        self.constant(t).data = struct.pack(f'<{len(values)}i', *values)
+
+    def downscale(self):
+        """Computes the new model. Returns a string on failure."""
+        sg = self.model.subgraphs[0]
+        inputs = sg.scalar_vector(tflite_fb.SUBGRAPH_INPUTS, 'i')
+        if len(inputs) != 1 or len(self.shapes[inputs[0]]) != 4:
+            return 'expected one 4D input'
+        shape = self.shapes[inputs[0]]
+        for dim in (HEIGHT, WIDTH):
+            if shape[dim] % self.factor:
+                return f'input dimension {shape[dim]} is not a multiple'
+            shape[dim] //= self.factor
+        # Bands of each Concatenation along the height, found up front so
+        # that their slices can be set before the ops are followed
+        for i, code in enumerate(self.codes):
+            if code == CONCATENATION and \
+                    self.options(i).scalar(CONCAT_AXIS, 'i') == HEIGHT:
+                reason = self.retile(i)
+                if reason:
+                    return f'op {i}: {reason}'
+        for i in range(len(self.ops)):
+            reason = self.infer(i)
+            if reason:
+                return f'op {i}: {reason}'
+        return None
+
+    def band(self, t):
+        """Returns the ops from a StridedSlice to tensor t, last first."""
+        chain = []
+        while True:
+            if t not in self.producer:
+                return None
+            i = self.producer[t]
+            chain.append(i)
+            if self.codes[i] == STRIDED_SLICE:
+                return chain
+            if self.codes[i] not in (PAD, CONV_2D, MAX_POOL_2D):
+                return None
+            t = self.inputs[i][0]
+
+    def window(self, i):
+        """Returns (filter, stride) along the height for op i."""
+        opts = self.options(i)
+        if opts.scalar(OPTIONS_PADDING, 'b') != PADDING_VALID:
+            return None
+        if self.codes[i] == CONV_2D:
+            size = self.shapes[self.inputs[i][1]][1]
+        else:
+            size = opts.scalar(POOL_FILTER_H, 'i')
+        return size, opts.scalar(OPTIONS_STRIDE_H, 'i')
+
+    def retile(self, concat):
+        bands = [self.band(t) for t in self.inputs[concat]]
+        if any(b is None for b in bands):
+            return 'inputs are not bands of Pad, Conv2D and MaxPool ops'
+        if any([self.codes[i] for i in b] !=
+               [self.codes[i] for i in bands[0]] for b in bands):
+            return 'bands have different ops'
+        # The output has the original rows divided by the factor, shared
+        # out between the bands in their original proportions
+        old_total = self.shapes[self.outputs[concat][0]][HEIGHT]
+        total = old_total // self.factor
+        old_end = 0
+        start = 0
+        for n, chain in enumerate(bands):
+            old_end += self.shapes[self.inputs[concat][n]][HEIGHT]
+            band_rows = old_end * total // old_total - start
+            # Walk back to the slice, tracking the rows the band reads and
+            # where its first row lies in the untiled input. Only the first
+            # band pads above, by as much as the untiled network does.
+            rows = band_rows
+            first = start
+            for k, i in enumerate(chain[:-1]):
+                if self.codes[i] == PAD:
+                    before, after = self.ints(self.inputs[i][1])[2:4]
+                    rows -= before + after
+                    first -= self.ints(self.inputs[bands[0][k]][1])[2]
+                    continue
+                window = self.window(i)
+                if window is None:
+                    return f'op {i} does not have VALID padding'
+                size, stride = window
+                rows = (rows - 1) * stride + size
+                first *= stride
+            if n == 0:
+                # Its own Pads supply the rows above the input
+                first = 0
+            begin_t, end_t = self.inputs[chain[-1]][1:3]
+            begin = self.ints(begin_t)
+            end = self.ints(end_t)
+            begin[HEIGHT] = first
+            end[HEIGHT] = first + rows
+            self.set_ints(begin_t, begin)
+            self.set_ints(end_t, end)
+            start += band_rows
+        return None
+
+    def infer(self, i):
+        """Sets the shape of op i's output from its inputs."""
+        code = self.codes[i]
+        inputs = self.inputs[i]
+        shape = list(self.shapes[inputs[0]])
+        out = self.outputs[i][0]
+        if code == PAD:
+            paddings = self.ints(inputs[1])
+            shape = [n + paddings[2 * d] + paddings[2 * d + 1]
+                     for d, n in enumerate(shape)]
+        elif code == STRIDED_SLICE:
+            opts = self.options(i)
+            begin_mask = opts.scalar(SLICE_BEGIN_MASK, 'i')
+            end_mask = opts.scalar(SLICE_END_MASK, 'i')
+            begin = self.ints(inputs[1])
+            end = self.ints(inputs[2])
+            if any(s != 1 for s in self.ints(inputs[3])):
+                return 'strides other than 1'
+            for d, n in enumerate(shape):
+                b = 0 if begin_mask & (1 << d) else begin[d]
+                e = n if end_mask & (1 << d) else end[d]
+                if not 0 <= b < e <= n:
+                    return f'slice {b}:{e} out of range 0:{n}'
+                shape[d] = e - b
+        elif code in (CONV_2D, MAX_POOL_2D):
+            opts = self.options(i)
+            if code == CONV_2D:
+                filter_h, filter_w = self.shapes[inputs[1]][1:3]
+                if opts.scalar(tflite_pad_channels.CONV_DILATION_W, 'i', 1) \
+                        != 1 or opts.scalar(
+                            tflite_pad_channels.CONV_DILATION_H, 'i', 1) != 1:
+                    return 'dilation'
+            else:
+                filter_h = opts.scalar(POOL_FILTER_H, 'i')
+                filter_w = opts.scalar(POOL_FILTER_W, 'i')
+            strides = (opts.scalar(OPTIONS_STRIDE_H, 'i'),
+                       opts.scalar(OPTIONS_STRIDE_W, 'i'))
+            for d, size, stride in zip((HEIGHT, WIDTH), (filter_h, filter_w),
+                                       strides):
+                if opts.scalar(OPTIONS_PADDING, 'b') == PADDING_VALID:
+                    shape[d] = (shape[d] - size) // stride + 1
+                else:
+                    shape[d] = ceil_div(shape[d], stride)
+                if shape[d] < 1:
+                    return 'input too small'
+            if code == CONV_2D:
+                shape[3] = self.shapes[inputs[1]][0]
+        elif code == CONCATENATION:
+            axis = self.options(i).scalar(CONCAT_AXIS, 'i')
+            shape[axis] = sum(self.shapes[t][axis] for t in inputs)
+        elif code == RESHAPE:
+            new_shape = self.ints(inputs[1])
+            old_shape = self.shapes[out]
+            if new_shape[0] != -1 or len(new_shape) != 2 or \
+                    len(shape) != 4:
+                return 'only flattening Reshapes are supported'
+            flat = shape[1] * shape[2] * shape[3]
+            if flat != old_shape[1]:
+                self.set_ints(inputs[1], [-1, flat])
+            shape = [shape[0], flat]
+        elif code == FULLY_CONNECTED:
+            if shape[-1] != self.shapes[inputs[1]][1]:
+                reason = self.fold(i)
+                if reason:
+                    return reason
+            shape = shape[:-1] + [self.shapes[inputs[1]][0]]
+        elif code != LOGISTIC:
+            return f'builtin {code} not supported'
+        self.shapes[out] = shape
+        return None
+
+    def fold(self, i):
+        """Folds the weights of FullyConnected op i to its smaller input."""
+        reshape = self.producer.get(self.inputs[i][0])
+        if reshape is None or self.codes[reshape] != RESHAPE:
+            return 'input depth changed other than by a Reshape'
+        old_map = self.model.tensors()[self.inputs[reshape][0]].shape
+        new_map = self.shapes[self.inputs[reshape][0]]
+        weights_t = self.inputs[i][1]
+        weights = self.constant(weights_t)
+        if weights.element_size != 1 or len(weights.scale) != 1 or \
+                weights.zero_point[0] != 0:
+            return 'weights are not symmetric per tensor int8'
+        outputs, old_depth = self.shapes[weights_t]
+        _, old_h, old_w, channels = old_map
+        _, new_h, new_w, _ = new_map
+        new_depth = new_h * new_w * channels
+        old = struct.unpack(f'<{outputs * old_depth}b', weights.data)
+        sums = [0] * (outputs * new_depth)
+        for o in range(outputs):
+            for y in range(old_h):
+                for x in range(old_w):
+                    src = o * old_depth + (y * old_w + x) * channels
+                    dst = o * new_depth + \
+                        (y * new_h // old_h * new_w + x * new_w // old_w) * \
+                        channels
+                    for c in range(channels):
+                        sums[dst + c] += old[src + c]
+        # Keep the scale unless the sums no longer fit in int8
+        ratio = max(1.0, max(abs(s) for s in sums) / 127)
+        weights.data = struct.pack(f'<{len(sums)}b',
+                                   *(round(s / ratio) for s in sums))
+        weights.scale = [weights.scale[0] * ratio]
+        self.shapes[weights_t] = [outputs, new_depth]
+        if len(self.inputs[i]) > 2 and self.inputs[i][2] >= 0:
+            bias = self.constant(self.inputs[i][2])
+            values = struct.unpack(f'<{len(bias.data) // 4}i', bias.data)
+            bias.data = struct.pack(f'<{len(values)}i',
+                                    *(round(b / ratio) for b in values))
+            bias.scale = [s * ratio for s in bias.scale]
+        return None
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description='Derive a lower resolution variant of a tiled model.')
+    parser.add_argument('model', help='.tflite file')
+    parser.add_argument('-o', '--output', required=True,
+                        help='write downscaled model here')
+    parser.add_argument('-f', '--factor', type=int, default=2,
+                        help='divide input height and width by this')
+    args = parser.parse_args()
+
+    with open(args.model, 'rb') as f:
+        model = tflite_fb.Model(f.read())
+    if len(model.subgraphs) != 1:
+        sys.exit(f'{args.model}: only single subgraph models are supported')
+    if model.has_external_buffers():
+        sys.exit(f'{args.model}: models with external buffers not supported')
+
+    downscaler = Downscaler(model, args.factor)
+    reason = downscaler.downscale()
+    if reason:
+        sys.exit(f'{args.model}: {reason}')
+    out = downscaler.write()
+    downscaled = tflite_fb.Model(out)
+    assert [t.shape for t in downscaled.tensors()] == downscaler.shapes
+    print(f'input:  {model.tensors()[0].shape} -> '
+          f'{downscaled.tensors()[0].shape}')
+    print(f'arena:  {tflite_pad_channels.greedy_arena(model)} -> '
+          f'{tflite_pad_channels.greedy_arena(downscaled)} bytes, as planned '
+          f'by GreedyMemoryPlanner')
+    print(f'file:   {len(model.buf)} -> {len(out)} bytes')
+    if tflite_memory_planner.read_offline_plan(model):
+        print('offline memory plan dropped: re-run tflite_memory_planner.py')
+    with open(args.output, 'wb') as f:
+        f.write(out)
+
+
+if __name__ == '__main__':
+    main()
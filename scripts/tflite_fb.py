@@ -0,0 +1,534 @@
+# Copyright 2021 The CFU-Playground Authors
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#      http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+"""Minimal reader and editor for .tflite flatbuffers.
+
+Needs no packages beyond the standard library, so that host tools can run
+wherever the firmware builds.
+
+Reading follows the tflite schema (third_party/tflite-micro/tensorflow/lite/
+schema/schema.fbs) by field index. Editing works by placing new tables in
+front of the existing data: flatbuffer offsets only point forward, so new
+objects at the start of the file may refer to any old object, and old
+objects keep their relative offsets when shifted by a multiple of 16 bytes.
+Old objects left unreferenced, such as replaced buffer data, are then cut
+out with compact().
+"""
+
+import bisect
+import struct
+
+# Field indices from schema.fbs
+MODEL_VERSION = 0
+MODEL_OPERATOR_CODES = 1
+MODEL_SUBGRAPHS = 2
+MODEL_BUFFERS = 4
+MODEL_METADATA = 6
+
+SUBGRAPH_TENSORS = 0
+SUBGRAPH_INPUTS = 1
+SUBGRAPH_OUTPUTS = 2
+SUBGRAPH_OPERATORS = 3
+
+TENSOR_SHAPE = 0
+TENSOR_TYPE = 1
+TENSOR_BUFFER = 2
+TENSOR_NAME = 3
+TENSOR_QUANTIZATION = 4
+TENSOR_IS_VARIABLE = 5
+TENSOR_SHAPE_SIGNATURE = 7
+TENSOR_HAS_RANK = 8
+
+QUANTIZATION_SCALE = 2
+QUANTIZATION_ZERO_POINT = 3
+QUANTIZATION_DETAILS_TYPE = 4
+QUANTIZATION_QUANTIZED_DIMENSION = 6
+
+OPERATOR_OPCODE_INDEX = 0
+OPERATOR_INPUTS = 1
+OPERATOR_OUTPUTS = 2
+OPERATOR_BUILTIN_OPTIONS_TYPE = 3
+OPERATOR_BUILTIN_OPTIONS = 4
+
+OPCODE_DEPRECATED_BUILTIN_CODE = 0
+OPCODE_CUSTOM_CODE = 1
+OPCODE_BUILTIN_CODE = 3
+
+BUFFER_DATA = 0
+BUFFER_OFFSET = 1
+
+METADATA_NAME = 0
+METADATA_BUFFER = 1
+
+# Bytes per element, by TensorType
+TENSOR_TYPE_SIZES = {
+    0: 4,   # FLOAT32
+    1: 2,   # FLOAT16
+    2: 4,   # INT32
+    3: 1,   # UINT8
+    4: 8,   # INT64
+    6: 1,   # BOOL
+    7: 2,   # INT16
+    8: 8,   # COMPLEX64
+    9: 1,   # INT8
+    10: 8,  # FLOAT64
+    11: 16,  # COMPLEX128
+    12: 8,  # UINT64
+    15: 4,  # UINT32
+    16: 2,  # UINT16
+}
+
+
+def _u16(buf, pos):
+    return struct.unpack_from('<H', buf, pos)[0]
+
+
+def _u32(buf, pos):
+    return struct.unpack_from('<I', buf, pos)[0]
+
+
+def _i32(buf, pos):
+    return struct.unpack_from('<i', buf, pos)[0]
+
+
+class Table:
+    """A flatbuffer table at a position in a buffer."""
+
+    def __init__(self, buf, pos):
+        self.buf = buf
+        self.pos = pos
+        self.vtable = pos - _i32(buf, pos)
+        self.vtable_len = _u16(buf, self.vtable)
+
+    def num_fields(self):
+        return (self.vtable_len - 4) // 2
+
+    def field_pos(self, index):
+        """Returns absolute position of field, or None if not present."""
+        entry = 4 + 2 * index
+        if entry >= self.vtable_len:
+            return None
+        offset = _u16(self.buf, self.vtable + entry)
+        return self.pos + offset if offset else None
+
+    def scalar(self, index, fmt, default=0):
+        pos = self.field_pos(index)
+        if pos is None:
+            return default
+        return struct.unpack_from('<' + fmt, self.buf, pos)[0]
+
+    def target(self, index):
+        """Returns absolute position referred to by an offset field."""
+        pos = self.field_pos(index)
+        if pos is None:
+            return None
+        return pos + _u32(self.buf, pos)
+
+    def table(self, index):
+        pos = self.target(index)
+        return None if pos is None else Table(self.buf, pos)
+
+    def vector(self, index):
+        """Returns (start, length) of a vector field, or (None, 0)."""
+        pos = self.target(index)
+        if pos is None:
+            return None, 0
+        return pos + 4, _u32(self.buf, pos)
+
+    def scalar_vector(self, index, fmt):
+        start, length = self.vector(index)
+        if start is None:
+            return []
+        return list(struct.unpack_from(f'<{length}{fmt}', self.buf, start))
+
+    def table_positions(self, index):
+        """Returns absolute positions of the tables in a vector of tables."""
+        start, length = self.vector(index)
+        if start is None:
+            return []
+        return [start + 4 * i + _u32(self.buf, start + 4 * i)
+                for i in range(length)]
+
+    def tables(self, index):
+        return [Table(self.buf, p) for p in self.table_positions(index)]
+
+    def string(self, index):
+        start, length = self.vector(index)
+        if start is None:
+            return None
+        return bytes(self.buf[start:start + length]).decode('utf-8')
+
+    def bytes(self, index):
+        start, length = self.vector(index)
+        if start is None:
+            return None
+        return bytes(self.buf[start:start + length])
+
+
+class TensorInfo:
+    def __init__(self, index, table, buffers):
+        self.index = index
+        self.shape = table.scalar_vector(TENSOR_SHAPE, 'i')
+        self.type = table.scalar(TENSOR_TYPE, 'b')
+        self.name = table.string(TENSOR_NAME)
+        self.is_variable = bool(table.scalar(TENSOR_IS_VARIABLE, 'B'))
+        buffer_index = table.scalar(TENSOR_BUFFER, 'I')
+        data = buffers[buffer_index].bytes(BUFFER_DATA) \
+            if buffer_index < len(buffers) else None
+        self.is_constant = bool(data)
+        self.table = table
+
+    def num_bytes(self):
+        count = 1
+        for d in self.shape:
+            count *= d
+        return count * TENSOR_TYPE_SIZES.get(self.type, 1)
+
+
+class Model:
+    """Read only view of a .tflite model."""
+
+    def __init__(self, data):
+        self.buf = data
+        self.root = Table(data, _u32(data, 0))
+        self.buffers = self.root.tables(MODEL_BUFFERS)
+        self.subgraphs = self.root.tables(MODEL_SUBGRAPHS)
+        self.opcodes = self.root.tables(MODEL_OPERATOR_CODES)
+
+    def tensors(self, subgraph=0):
+        sg = self.subgraphs[subgraph]
+        return [TensorInfo(i, t, self.buffers)
+                for i, t in enumerate(sg.tables(SUBGRAPH_TENSORS))]
+
+    def operators(self, subgraph=0):
+        return self.subgraphs[subgraph].tables(SUBGRAPH_OPERATORS)
+
+    def builtin_code(self, op):
+        opcode = self.opcodes[op.scalar(OPERATOR_OPCODE_INDEX, 'I')]
+        deprecated = opcode.scalar(OPCODE_DEPRECATED_BUILTIN_CODE, 'b')
+        return max(deprecated, opcode.scalar(OPCODE_BUILTIN_CODE, 'i'))
+
+    def metadata(self):
+        """Returns list of (name, buffer_index, table) tuples."""
+        return [(m.string(METADATA_NAME), m.scalar(METADATA_BUFFER, 'I'), m)
+                for m in self.root.tables(MODEL_METADATA)]
+
+    def has_external_buffers(self):
+        return any(b.scalar(BUFFER_OFFSET, 'Q') > 1 for b in self.buffers)
+
+
+class NewRef:
+    """Reference to an object created by a PrefixBuilder."""
+
+    def __init__(self, obj):
+        self.obj = obj
+
+
+class OldRef:
+    """Reference to an object at an absolute position in the old buffer."""
+
+    def __init__(self, pos):
+        self.pos = pos
+
+
+class _Object:
+    def __init__(self, data, align, refs, table_start=0):
+        # refs: list of (offset within data, NewRef or OldRef)
+        self.data = bytearray(data)
+        self.align = align
+        self.refs = refs
+        # Offset of the table itself within data (after any vtable)
+        self.table_start = table_start
+        self.pos = None
+
+
+class PrefixBuilder:
+    """Builds new objects to be placed ahead of an existing flatbuffer.
+
+    Objects must be created children first. They are laid out in reverse
+    order of creation so that every offset points forward.
+    """
+
+    def __init__(self, old_buf):
+        self.old_buf = old_buf
+        self.objects = []
+
+    def _add(self, obj):
+        self.objects.append(obj)
+        return NewRef(obj)
+
+    def bytes_vector(self, data, align=16):
+        return self._add(_Object(struct.pack('<I', len(data)) + data,
+                                 align, []))
+
+    def string(self, text):
+        data = text.encode('utf-8')
+        return self._add(_Object(
+            struct.pack('<I', len(data)) + data + b'\0', 4, []))
+
+    def int_vector(self, values, fmt='i'):
+        return self._add(_Object(
+            struct.pack(f'<I{len(values)}{fmt}', len(values), *values), 4, []))
+
+    def ref_vector(self, refs):
+        data = struct.pack('<I', len(refs)) + bytes(4 * len(refs))
+        return self._add(_Object(
+            data, 4, [(4 + 4 * i, r) for i, r in enumerate(refs)]))
+
+    def table(self, fields):
+        """Creates a table.
+
+        fields is a dict of field index to either a (struct format, value)
+        pair for scalars, or a NewRef/OldRef for offsets. Every field takes a
+        4 byte slot.
+        """
+        num_fields = max(fields) + 1 if fields else 0
+        vtable_len = 4 + 2 * num_fields
+        vtable_padded = (vtable_len + 3) & ~3
+        table_len = 4 + 4 * len(fields)
+        vtable = bytearray(vtable_padded)
+        table = bytearray(table_len)
+        refs = []
+        struct.pack_into('<HH', vtable, 0, vtable_len, table_len)
+        slot = 4
+        for index in sorted(fields):
+            value = fields[index]
+            struct.pack_into('<H', vtable, 4 + 2 * index, slot)
+            if isinstance(value, (NewRef, OldRef)):
+                refs.append((vtable_padded + slot, value))
+            else:
+                fmt, scalar = value
+                struct.pack_into('<' + fmt, table, slot, scalar)
+            slot += 4
+        # soffset from table to vtable
+        struct.pack_into('<i', table, 0, vtable_padded)
+        return self._add(_Object(vtable + table, 4, refs, vtable_padded))
+
+    def finish(self, root, file_identifier=b'TFL3'):
+        """Returns new buffer with prefix objects and old data after them."""
+        pos = 8
+        for obj in reversed(self.objects):
+            pos = (pos + obj.align - 1) & ~(obj.align - 1)
+            obj.pos = pos
+            pos += len(obj.data)
+        prefix_len = (pos - 8 + 15) & ~15
+
+        def target(ref):
+            if isinstance(ref, OldRef):
+                return ref.pos + prefix_len
+            return ref.obj.pos + ref.obj.table_start
+
+        out = bytearray(8 + prefix_len)
+        struct.pack_into('<I', out, 0, target(root))
+        out[4:8] = file_identifier
+        for obj in self.objects:
+            out[obj.pos:obj.pos + len(obj.data)] = obj.data
+            for offset, ref in obj.refs:
+                at = obj.pos + offset
+                struct.pack_into('<I', out, at, target(ref) - at)
+        return bytes(out) + bytes(self.old_buf[8:])
+
+
+# Struct formats of the scalar fields of tables that may be copied. All
+# other fields are offsets.
+MODEL_SCALARS = {MODEL_VERSION: 'I'}
+SUBGRAPH_SCALARS = {}
+TENSOR_SCALARS = {
+    TENSOR_TYPE: 'b',
+    TENSOR_BUFFER: 'I',
+    TENSOR_IS_VARIABLE: 'B',
+    TENSOR_HAS_RANK: 'B',
+}
+QUANTIZATION_SCALARS = {
+    QUANTIZATION_DETAILS_TYPE: 'B',
+    QUANTIZATION_QUANTIZED_DIMENSION: 'i',
+}
+
+
+def copy_fields(table, scalars, replace):
+    """Returns fields for a new table with the same contents as table.
+
+    scalars gives the struct format of each scalar field. Fields in replace
+    are used in place of those in table.
+    """
+    fields = {}
+    for index in range(table.num_fields()):
+        if table.field_pos(index) is None:
+            continue
+        if index in scalars:
+            fmt = scalars[index]
+            fields[index] = (fmt, table.scalar(index, fmt))
+        else:
+            fields[index] = OldRef(table.target(index))
+    fields.update(replace)
+    return fields
+
+
+def copy_model_fields(model, replace):
+    """Returns fields for a new root Model table."""
+    return copy_fields(model.root, MODEL_SCALARS, replace)
+
+
+# Offset fields of each table type, for finding every offset in a model.
+# A field is a string or scalar vector ('leaf'), a table ('table', type), a
+# vector of tables ('tables', type) or a union ('union', type field index,
+# {union type: table type}). Tables not listed have only scalar fields, as
+# do union members missing from a union's dict. Taken from schema.fbs.
+_LEAF = ('leaf',)
+OFFSET_FIELDS = {
+    'Model': {
+        MODEL_OPERATOR_CODES: ('tables', 'OperatorCode'),
+        MODEL_SUBGRAPHS: ('tables', 'SubGraph'),
+        3: _LEAF,  # description
+        MODEL_BUFFERS: ('tables', 'Buffer'),
+        5: _LEAF,  # metadata_buffer
+        MODEL_METADATA: ('tables', 'Metadata'),
+        7: ('tables', 'SignatureDef'),
+    },
+    'OperatorCode': {OPCODE_CUSTOM_CODE: _LEAF},
+    'SubGraph': {
+        SUBGRAPH_TENSORS: ('tables', 'Tensor'),
+        SUBGRAPH_INPUTS: _LEAF,
+        SUBGRAPH_OUTPUTS: _LEAF,
+        SUBGRAPH_OPERATORS: ('tables', 'Operator'),
+        4: _LEAF,  # name
+    },
+    'Tensor': {
+        TENSOR_SHAPE: _LEAF,
+        TENSOR_NAME: _LEAF,
+        TENSOR_QUANTIZATION: ('table', 'QuantizationParameters'),
+        6: ('table', 'SparsityParameters'),
+        TENSOR_SHAPE_SIGNATURE: _LEAF,
+    },
+    'QuantizationParameters': {
+        0: _LEAF,  # min
+        1: _LEAF,  # max
+        QUANTIZATION_SCALE: _LEAF,
+        QUANTIZATION_ZERO_POINT: _LEAF,
+        5: ('union', QUANTIZATION_DETAILS_TYPE, {1: 'CustomQuantization'}),
+    },
+    'CustomQuantization': {0: _LEAF},
+    'SparsityParameters': {
+        0: _LEAF,  # traversal_order
+        1: _LEAF,  # block_map
+        2: ('tables', 'DimensionMetadata'),
+    },
+    'DimensionMetadata': {
+        3: ('union', 2, {1: 'IndexVector', 2: 'IndexVector',
+                         3: 'IndexVector'}),
+        5: ('union', 4, {1: 'IndexVector', 2: 'IndexVector',
+                         3: 'IndexVector'}),
+    },
+    'IndexVector': {0: _LEAF},
+    'Operator': {
+        OPERATOR_INPUTS: _LEAF,
+        OPERATOR_OUTPUTS: _LEAF,
+        OPERATOR_BUILTIN_OPTIONS: ('union', OPERATOR_BUILTIN_OPTIONS_TYPE, {
+            3: 'ConcatEmbeddingsOptions',
+            17: 'ReshapeOptions',
+            30: 'SqueezeOptions',
+            111: 'VarHandleOptions',
+            115: 'BucketizeOptions',
+        }),
+        5: _LEAF,  # custom_options
+        7: _LEAF,  # mutating_variable_inputs
+        8: _LEAF,  # intermediates
+    },
+    'ConcatEmbeddingsOptions': {1: _LEAF, 2: _LEAF},
+    'ReshapeOptions': {0: _LEAF},
+    'SqueezeOptions': {0: _LEAF},
+    'VarHandleOptions': {0: _LEAF, 1: _LEAF},
+    'BucketizeOptions': {0: _LEAF},
+    'Buffer': {BUFFER_DATA: _LEAF},
+    'Metadata': {METADATA_NAME: _LEAF},
+    'TensorMap': {0: _LEAF},
+    'SignatureDef': {
+        0: ('tables', 'TensorMap'),
+        1: ('tables', 'TensorMap'),
+        2: _LEAF,  # signature_key
+    },
+}
+
+
+def offset_locations(buf):
+    """Finds every offset in a model.
+
+    Returns a dict of position to (target, signed). These are the root
+    offset, the signed offset from each table to its vtable, and the
+    offsets from each table to its children.
+    """
+    locations = {0: (_u32(buf, 0), False)}
+    visited = set()
+
+    def visit_table(pos, kind):
+        if pos in visited:
+            return
+        visited.add(pos)
+        table = Table(buf, pos)
+        locations[pos] = (table.vtable, True)
+        for index, field in OFFSET_FIELDS.get(kind, {}).items():
+            target = table.target(index)
+            if target is None:
+                continue
+            locations[table.field_pos(index)] = (target, False)
+            if field[0] == 'table':
+                visit_table(target, field[1])
+            elif field[0] == 'tables':
+                for i in range(_u32(buf, target)):
+                    at = target + 4 + 4 * i
+                    locations[at] = (at + _u32(buf, at), False)
+                    visit_table(locations[at][0], field[1])
+            elif field[0] == 'union':
+                union_type = table.scalar(field[1], 'B')
+                if union_type:
+                    visit_table(target, field[2].get(union_type))
+
+    visit_table(locations[0][0], 'Model')
+    return locations
+
+
+def compact(buf, ranges):
+    """Returns a model with the given byte ranges removed.
+
+    ranges is a list of (start, end) of objects no longer referenced, such
+    as the data of replaced buffers. Each range is shortened to a multiple of
+    16 bytes, so that everything after it keeps its alignment, and the
+    offsets that span it are adjusted.
+    """
+    removed = sorted((start, start + (end - start) // 16 * 16)
+                     for start, end in ranges if end - start >= 16)
+    starts = [start for start, _ in removed]
+    before = [0]
+    for start, end in removed:
+        before.append(before[-1] + end - start)
+
+    def moved(pos):
+        i = bisect.bisect_right(starts, pos)
+        if i and pos < removed[i - 1][1]:
+            raise ValueError(f'position {pos} is in a removed range')
+        return pos - before[i]
+
+    out = bytearray()
+    last = 0
+    for start, end in removed:
+        out += buf[last:start]
+        last = end
+    out += buf[last:]
+    for pos, (target, signed) in offset_locations(buf).items():
+        new_pos, new_target = moved(pos), moved(target)
+        if signed:
+            struct.pack_into('<i', out, new_pos, new_pos - new_target)
+        else:
+            struct.pack_into('<I', out, new_pos, new_target - new_pos)
+    return bytes(out)
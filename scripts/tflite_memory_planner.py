@@ -0,0 +1,360 @@
+#!/usr/bin/env python
+# Copyright 2021 The CFU-Playground Authors
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#      http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+"""Offline tensor arena planner for TFLM models.
+
+Plans the placement of every non-constant tensor in a model, searching for a
+smaller arena than TFLM's GreedyMemoryPlanner, or any offline plan already in
+the model, would use. The result is embedded as "OfflineMemoryAllocation"
+metadata, which TFLM uses in place of its own plan. See third_party/tflite-micro/tensorflow/lite/micro/docs/
+memory_management.md.
+
+Usage:
+    tflite_memory_planner.py model.tflite [model2.tflite ...]
+        Reports arena bytes for the current and offline plans.
+    tflite_memory_planner.py model.tflite -o planned.tflite
+        Also writes a copy of the model with the plan embedded.
+    tflite_memory_planner.py --in-place model.tflite -o planned.tflite
+        Also places the output of int8 Add, Mul and Quantize over an input
+        that is not used afterwards. The elementwise kernels in
+        common/src/tensorflow/lite/micro/kernels support this, as do the
+        reference kernels.
+
+Scratch buffers requested by kernels in Prepare() are not known here. TFLM
+still plans them online, fitting them into gaps around the offline plan, so
+the reported sizes exclude them, as well as persistent allocations.
+"""
+
+import argparse
+import random
+import struct
+import sys
+
+import tflite_fb
+
+# Matches MicroArenaBufferAlignment()
+ALIGNMENT = 16
+OFFLINE_METADATA_NAME = 'OfflineMemoryAllocation'
+ONLINE_PLANNED = -1
+
+# Ops whose int8 output may overwrite a same sized input
+IN_PLACE_OPS = {
+    0: 'ADD',
+    18: 'MUL',
+    114: 'QUANTIZE',
+}
+TENSOR_TYPE_INT8 = 9
+
+
+def align_up(n, alignment=ALIGNMENT):
+    return (n + alignment - 1) & ~(alignment - 1)
+
+
+class Buffer:
+    def __init__(self, tensor, size, first, last):
+        self.tensor = tensor
+        self.size = size
+        self.first = first
+        self.last = last
+
+    def overlaps(self, other):
+        return self.first <= other.last and other.first <= self.last
+
+
+def tensor_lifetimes(model, subgraph=0):
+    """Returns a Buffer for each tensor that TFLM places in the arena.
+
+    Follows AllocationInfoBuilder::AddTensors in micro_allocator.cc.
+    """
+    tensors = model.tensors(subgraph)
+    sg = model.subgraphs[subgraph]
+    ops = model.operators(subgraph)
+    first = [-1] * len(tensors)
+    last = [-1] * len(tensors)
+    for t in sg.scalar_vector(tflite_fb.SUBGRAPH_INPUTS, 'i'):
+        first[t] = 0
+    for t in sg.scalar_vector(tflite_fb.SUBGRAPH_OUTPUTS, 'i'):
+        last[t] = len(ops) - 1
+    for i in reversed(range(len(ops))):
+        op = ops[i]
+        for t in op.scalar_vector(tflite_fb.OPERATOR_INPUTS, 'i'):
+            if t >= 0 and (last[t] == -1 or last[t] < i):
+                last[t] = i
+        for t in op.scalar_vector(tflite_fb.OPERATOR_OUTPUTS, 'i'):
+            if first[t] == -1 or first[t] > i:
+                first[t] = i
+            if last[t] == -1 or last[t] < i:
+                last[t] = i
+    return [Buffer(t.index, align_up(t.num_bytes()), first[t.index],
+                   last[t.index])
+            for t in tensors if not t.is_constant and not t.is_variable]
+
+
+def merge_in_place(model, buffers, subgraph=0):
+    """Shares buffers between inputs and outputs of elementwise ops.
+
+    An output shares its input's buffer when the input is the same size, is
+    not a model input or output and is not used after the op. Returns
+    (merged buffers, aliases) where aliases maps each shared output tensor to
+    the tensor whose buffer it uses.
+    """
+    tensors = model.tensors(subgraph)
+    sg = model.subgraphs[subgraph]
+    model_io = set(sg.scalar_vector(tflite_fb.SUBGRAPH_INPUTS, 'i')) | \
+        set(sg.scalar_vector(tflite_fb.SUBGRAPH_OUTPUTS, 'i'))
+    by_tensor = {b.tensor: b for b in buffers}
+    aliases = {}
+    for i, op in enumerate(model.operators(subgraph)):
+        if model.builtin_code(op) not in IN_PLACE_OPS:
+            continue
+        outputs = op.scalar_vector(tflite_fb.OPERATOR_OUTPUTS, 'i')
+        out = by_tensor.get(outputs[0]) if len(outputs) == 1 else None
+        if not out or tensors[out.tensor].type != TENSOR_TYPE_INT8:
+            continue
+        for t in op.scalar_vector(tflite_fb.OPERATOR_INPUTS, 'i'):
+            b = by_tensor.get(t)
+            if b and b.last == i and b.size == out.size and \
+                    t not in model_io and \
+                    tensors[t].type == TENSOR_TYPE_INT8:
+                b.last = out.last
+                aliases[out.tensor] = t
+                by_tensor[out.tensor] = b
+                break
+    # The outputs' own buffers are no longer needed
+    return [b for b in buffers if b.tensor not in aliases], aliases
+
+
+def first_fit(buffers, order, fixed=None):
+    """Places buffers in the given order, each at the lowest offset that fits.
+
+    With buffers in descending size order (ties kept in tensor order) this
+    gives the same plan as GreedyMemoryPlanner. fixed maps buffer index to an
+    offset from an existing offline plan; those are placed first.
+    Returns (arena size, list of offsets indexed like buffers).
+    """
+    fixed = fixed or {}
+    offsets = [None] * len(buffers)
+    placed = []  # (offset, index), kept sorted by offset
+    for i in list(fixed) + [i for i in order if i not in fixed]:
+        b = buffers[i]
+        candidate = 0
+        if i in fixed:
+            candidate = fixed[i]
+        else:
+            for offset, j in placed:
+                if not b.overlaps(buffers[j]):
+                    continue
+                if offset - candidate >= b.size:
+                    break
+                candidate = max(candidate, offset + buffers[j].size)
+        offsets[i] = candidate
+        pos = len(placed)
+        while pos > 0 and placed[pos - 1][0] > candidate:
+            pos -= 1
+        placed.insert(pos, (candidate, i))
+    size = max((o + b.size for o, b in zip(offsets, buffers)), default=0)
+    return size, offsets
+
+
+def greedy_order(buffers):
+    return sorted(range(len(buffers)), key=lambda i: -buffers[i].size)
+
+
+def lower_bound(buffers):
+    """No plan can use less than the most bytes live at any one time."""
+    if not buffers:
+        return 0
+    steps = max(b.last for b in buffers) + 1
+    return max(sum(b.size for b in buffers if b.first <= t <= b.last)
+               for t in range(steps))
+
+
+def plan(buffers, iterations, hint=None, seed=0):
+    """Searches orderings for first_fit, returning the best plan found.
+
+    Starts from a few deterministic orderings, then perturbs the best one,
+    stopping early if the lower bound is reached. hint maps buffer index to
+    offset in a known plan: placing buffers in order of those offsets gives a
+    plan no larger than it.
+    """
+    bound = lower_bound(buffers)
+    n = len(buffers)
+    orders = [
+        greedy_order(buffers),
+        sorted(range(n), key=lambda i: (-buffers[i].size * (
+            buffers[i].last - buffers[i].first + 1), i)),
+        sorted(range(n), key=lambda i: (
+            buffers[i].first - buffers[i].last, -buffers[i].size, i)),
+        sorted(range(n), key=lambda i: (buffers[i].first, -buffers[i].size)),
+    ]
+    if hint:
+        orders.append(sorted(range(n), key=lambda i: (hint.get(i, -1), i)))
+    best_size, best_offsets, best_order = None, None, None
+    for order in orders:
+        size, offsets = first_fit(buffers, order)
+        if best_size is None or size < best_size:
+            best_size, best_offsets, best_order = size, offsets, order
+
+    rng = random.Random(seed)
+    for _ in range(iterations):
+        if best_size <= bound or n < 2:
+            break
+        order = list(best_order)
+        for _ in range(rng.randint(1, 3)):
+            a, b = rng.randrange(n), rng.randrange(n)
+            order.insert(b, order.pop(a))
+        size, offsets = first_fit(buffers, order)
+        if size <= best_size:
+            best_size, best_offsets, best_order = size, offsets, order
+    return best_size, best_offsets, bound
+
+
+def check_plan(buffers, offsets):
+    for i, a in enumerate(buffers):
+        for j in range(i):
+            b = buffers[j]
+            if a.overlaps(b) and offsets[i] < offsets[j] + b.size and \
+                    offsets[j] < offsets[i] + a.size:
+                raise ValueError(
+                    f'tensors {a.tensor} and {b.tensor} overlap in plan')
+
+
+def offline_metadata(num_tensors, buffers, offsets, aliases=None):
+    """Returns the metadata buffer contents, as read by TFLM."""
+    tensor_offsets = [ONLINE_PLANNED] * num_tensors
+    for b, offset in zip(buffers, offsets):
+        tensor_offsets[b.tensor] = offset
+    for alias, t in (aliases or {}).items():
+        while t in aliases:
+            t = aliases[t]
+        tensor_offsets[alias] = tensor_offsets[t]
+    # version, subgraph, number of tensors, offsets
+    return struct.pack(f'<3I{num_tensors}i', 0, 0, num_tensors,
+                       *tensor_offsets)
+
+
+def embed_metadata(model, data):
+    """Returns a copy of the model with data as offline plan metadata.
+
+    Any existing offline plan is dropped from the metadata list; its buffer
+    is left in place.
+    """
+    builder = tflite_fb.PrefixBuilder(model.buf)
+    data_ref = builder.bytes_vector(data, ALIGNMENT)
+    new_buffer = builder.table({tflite_fb.BUFFER_DATA: data_ref})
+    buffer_refs = [tflite_fb.OldRef(b.pos) for b in model.buffers]
+    buffers_ref = builder.ref_vector(buffer_refs + [new_buffer])
+    name_ref = builder.string(OFFLINE_METADATA_NAME)
+    metadata_table = builder.table({
+        tflite_fb.METADATA_NAME: name_ref,
+        tflite_fb.METADATA_BUFFER: ('I', len(model.buffers)),
+    })
+    metadata_refs = [tflite_fb.OldRef(m.pos)
+                     for name, _, m in model.metadata()
+                     if name != OFFLINE_METADATA_NAME]
+    metadata_ref = builder.ref_vector(metadata_refs + [metadata_table])
+    root = builder.table(tflite_fb.copy_model_fields(model, {
+        tflite_fb.MODEL_BUFFERS: buffers_ref,
+        tflite_fb.MODEL_METADATA: metadata_ref,
+    }))
+    return builder.finish(root)
+
+
+def existing_plan(model, buffers):
+    """Returns offsets from an offline plan already in the model, if any.
+
+    The result maps buffer index to offset, for buffers the plan places.
+    """
+    existing = read_offline_plan(model)
+    if not existing:
+        return {}
+    return {i: existing[b.tensor] for i, b in enumerate(buffers)
+            if existing[b.tensor] != ONLINE_PLANNED}
+
+
+def read_offline_plan(model):
+    for name, index, _ in model.metadata():
+        if name == OFFLINE_METADATA_NAME:
+            data = model.buffers[index].bytes(tflite_fb.BUFFER_DATA)
+            count = struct.unpack_from('<I', data, 8)[0]
+            return list(struct.unpack_from(f'<{count}i', data, 12))
+    return None
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description='Plan TFLM tensor arena offline and report bytes saved.')
+    parser.add_argument('models', nargs='+', help='.tflite files')
+    parser.add_argument('-o', '--output',
+                        help='write planned model here (one input only)')
+    parser.add_argument('-i', '--iterations', type=int, default=2000,
+                        help='search iterations per model')
+    parser.add_argument('--in-place', action='store_true',
+                        help='let elementwise ops overwrite their input')
+    args = parser.parse_args()
+    if args.output and len(args.models) != 1:
+        parser.error('--output needs exactly one input model')
+
+    # greedy: TFLM planning online; current: using any plan already in the
+    # model; bound: the most bytes live at once
+    print(f'{"model":<48} {"greedy":>8} {"current":>8} {"offline":>8} '
+          f'{"bound":>8} {"saved":>8}')
+    for path in args.models:
+        with open(path, 'rb') as f:
+            model = tflite_fb.Model(f.read())
+        if len(model.subgraphs) != 1:
+            sys.exit(f'{path}: only single subgraph models are supported')
+        if model.has_external_buffers():
+            sys.exit(f'{path}: models with external buffers not supported')
+        buffers = tensor_lifetimes(model)
+        order = greedy_order(buffers)
+        greedy_size, _ = first_fit(buffers, order)
+        hint = existing_plan(model, buffers)
+        current_size, _ = first_fit(buffers, order, hint)
+        aliases = {}
+        if args.in_place:
+            buffers, aliases = merge_in_place(model, buffers)
+            hint = existing_plan(model, buffers)
+        size, offsets, bound = plan(buffers, args.iterations, hint)
+        check_plan(buffers, offsets)
+        if aliases:
+            print(f'{path}: {len(aliases)} outputs placed over their input')
+        name = path if len(path) <= 48 else '...' + path[-45:]
+        print(f'{name:<48} {greedy_size:>8} {current_size:>8} {size:>8} '
+              f'{bound:>8} {current_size - size:>8}')
+
+        # An in-place plan is worth writing out even at the same size
+        if args.output and (size > current_size or
+                            (size == current_size and not aliases)):
+            print(f'{path}: current plan is no larger, not writing output')
+        elif args.output:
+            num_tensors = len(model.tensors())
+            out = embed_metadata(
+                model,
+                offline_metadata(num_tensors, buffers, offsets, aliases))
+            # Read back to check the plan survived
+            planned = tflite_fb.Model(out)
+            readback = read_offline_plan(planned)
+            for b, offset in zip(buffers, offsets):
+                assert readback[b.tensor] == offset
+            for alias in aliases:
+                assert readback[alias] != ONLINE_PLANNED
+            assert len(planned.tensors()) == num_tensors
+            with open(args.output, 'wb') as f:
+                f.write(out)
+
+
+if __name__ == '__main__':
+    main()
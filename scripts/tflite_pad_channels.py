@@ -0,0 +1,544 @@
+#!/usr/bin/env python
+# Copyright 2021 The CFU-Playground Authors
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#      http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+"""Pads channels of int8 .tflite models to accelerator friendly multiples.
+
+Many ops miss the hps_accel kernels only because of their channel counts:
+Conv2D needs input depth a multiple of 16 and output depth a multiple of 4
+(or of the systolic array width, if wider),
+MaxPool and Pad need depth a multiple of 16 and FullyConnected needs an
+input depth a multiple of 16.
+
+The output channels of a Conv2D or FullyConnected op are padded by giving
+it extra filters of zero weights and zero bias. The padded tensor is then
+followed through ops that keep channels separate (DepthwiseConv2D with a
+depth multiplier of one, MaxPool, AveragePool and Pad), which are padded in
+turn, to the Conv2D and FullyConnected ops that consume it. Those get zero
+weights for the extra input channels, so whatever values the extra channels
+hold, every original output is unchanged.
+
+Usage:
+    tflite_pad_channels.py model.tflite
+        Reports which ops would become accelerable, and the memory cost.
+    tflite_pad_channels.py model.tflite -o padded.tflite
+        Also writes the padded model.
+    tflite_pad_channels.py model.tflite --ops 3,7 -o padded.tflite
+        Pads the outputs of the given ops only. By default, every op whose
+        padding makes more ops accelerable is padded.
+
+The acceleration checks follow the CanAccelerate*() functions in
+proj/hps_accel/src, for the conditions that can be read from the model.
+
+Padded weights replace the original weights in their buffers, and the
+original data is cut out of the file, so the file grows only by the extra
+weights. Any offline memory plan is dropped, since tensor sizes change:
+re-run tflite_memory_planner.py on the output.
+"""
+
+import argparse
+import copy
+import sys
+
+import tflite_fb
+import tflite_memory_planner
+
+# Builtin operator codes from schema.fbs
+AVERAGE_POOL_2D = 1
+CONV_2D = 3
+DEPTHWISE_CONV_2D = 4
+FULLY_CONNECTED = 9
+MAX_POOL_2D = 17
+PAD = 34
+PADV2 = 60
+
+OP_NAMES = {
+    AVERAGE_POOL_2D: 'AVERAGE_POOL_2D',
+    CONV_2D: 'CONV_2D',
+    DEPTHWISE_CONV_2D: 'DEPTHWISE_CONV_2D',
+    FULLY_CONNECTED: 'FULLY_CONNECTED',
+    MAX_POOL_2D: 'MAX_POOL_2D',
+    PAD: 'PAD',
+    PADV2: 'PADV2',
+}
+
+# Ops that keep channels separate, and so may pass padding through
+CHANNELWISE_OPS = (DEPTHWISE_CONV_2D, MAX_POOL_2D, AVERAGE_POOL_2D, PAD, PADV2)
+
+# Conv2DOptions and Pool2DOptions fields
+OPTIONS_PADDING = 0
+OPTIONS_STRIDE_W = 1
+OPTIONS_STRIDE_H = 2
+CONV_DILATION_W = 4
+CONV_DILATION_H = 5
+POOL_FILTER_W = 3
+POOL_FILTER_H = 4
+POOL_ACTIVATION = 5
+PADDING_VALID = 1
+
+TENSOR_TYPE_INT8 = 9
+
+# From proj/hps_accel/gateware/gen2/constants.py. NUM_FILTER_STORES is the
+# systolic array width, set with --sys-array-width.
+DEFAULT_SYS_ARRAY_WIDTH = 2
+FILTER_WORDS_PER_STORE = 512
+
+
+def round_up(n, multiple):
+    return (n + multiple - 1) // multiple * multiple
+
+
+def product(values):
+    result = 1
+    for v in values:
+        result *= v
+    return result
+
+
+class Constant:
+    """Contents of a constant tensor, with per-channel quantization."""
+
+    def __init__(self, model, tensor):
+        buffer_index = tensor.table.scalar(tflite_fb.TENSOR_BUFFER, 'I')
+        self.data = model.buffers[buffer_index].bytes(tflite_fb.BUFFER_DATA)
+        self.element_size = tflite_fb.TENSOR_TYPE_SIZES[tensor.type]
+        quant = tensor.table.table(tflite_fb.TENSOR_QUANTIZATION)
+        self.scale = quant.scalar_vector(
+            tflite_fb.QUANTIZATION_SCALE, 'f') if quant else []
+        self.zero_point = quant.scalar_vector(
+            tflite_fb.QUANTIZATION_ZERO_POINT, 'q') if quant else []
+        self.quantized_dimension = quant.scalar(
+            tflite_fb.QUANTIZATION_QUANTIZED_DIMENSION, 'i') if quant else 0
+
+    def pad(self, shape, dim, size):
+        """Pads dimension dim of shape with zeros, and returns new shape."""
+        outer = product(shape[:dim])
+        inner = product(shape[dim + 1:]) * self.element_size
+        old = shape[dim] * inner
+        extra = bytes((size - shape[dim]) * inner)
+        self.data = b''.join(self.data[i * old:(i + 1) * old] + extra
+                             for i in range(outer))
+        if len(self.scale) > 1 and self.quantized_dimension == dim:
+            # Any valid scale will do, since the values are all zero
+            self.scale += [self.scale[-1]] * (size - shape[dim])
+            self.zero_point += [0] * (size - shape[dim])
+        return shape[:dim] + [size] + shape[dim + 1:]
+
+
+class Padder:
+    """Works out the effect of padding, and writes the padded model."""
+
+    def __init__(self, model, sys_array_width=DEFAULT_SYS_ARRAY_WIDTH):
+        self.model = model
+        self.num_filter_stores = sys_array_width
+        self.output_channel_group = max(4, sys_array_width)
+        self.tensors = model.tensors()
+        self.ops = model.operators()
+        self.codes = [model.builtin_code(op) for op in self.ops]
+        self.inputs = [op.scalar_vector(tflite_fb.OPERATOR_INPUTS, 'i')
+                       for op in self.ops]
+        self.outputs = [op.scalar_vector(tflite_fb.OPERATOR_OUTPUTS, 'i')
+                        for op in self.ops]
+        sg = model.subgraphs[0]
+        self.model_io = set(sg.scalar_vector(tflite_fb.SUBGRAPH_INPUTS, 'i')) \
+            | set(sg.scalar_vector(tflite_fb.SUBGRAPH_OUTPUTS, 'i'))
+        self.consumers = {}
+        for i, inputs in enumerate(self.inputs):
+            for t in inputs:
+                self.consumers.setdefault(t, []).append(i)
+        # Current shape of every tensor, and contents of changed constants
+        self.shapes = [list(t.shape) for t in self.tensors]
+        self.constants = {}
+
+    def save(self):
+        return copy.deepcopy((self.shapes, self.constants))
+
+    def restore(self, state):
+        self.shapes, self.constants = state
+
+    def constant(self, t):
+        if t not in self.constants:
+            self.constants[t] = Constant(self.model, self.tensors[t])
+        return self.constants[t]
+
+    def zero_point(self, t):
+        quant = self.tensors[t].table.table(tflite_fb.TENSOR_QUANTIZATION)
+        zero_points = quant.scalar_vector(
+            tflite_fb.QUANTIZATION_ZERO_POINT, 'q') if quant else []
+        return zero_points[0] if zero_points else 0
+
+    def options(self, i):
+        return self.ops[i].table(tflite_fb.OPERATOR_BUILTIN_OPTIONS)
+
+    def is_constant(self, t):
+        return t >= 0 and self.tensors[t].is_constant
+
+    def accel_blocker(self, i):
+        """Returns why op i cannot be accelerated, or None if it can.
+
+        Returns '' for ops with no accelerated kernel.
+        """
+        code = self.codes[i]
+        inputs = self.inputs[i]
+        if code == CONV_2D:
+            return self.conv_blocker(i)
+        if code == MAX_POOL_2D:
+            opts = self.options(i)
+            if opts.scalar(OPTIONS_PADDING, 'b') != PADDING_VALID and \
+                    (self.shapes[inputs[0]][1] % 2 or
+                     self.shapes[inputs[0]][2] % 2):
+                return 'padding'
+            if opts.scalar(OPTIONS_STRIDE_W, 'i') != 2 or \
+                    opts.scalar(OPTIONS_STRIDE_H, 'i') != 2 or \
+                    opts.scalar(POOL_FILTER_W, 'i') != 2 or \
+                    opts.scalar(POOL_FILTER_H, 'i') != 2:
+                return 'not 2x2 stride 2'
+            if opts.scalar(POOL_ACTIVATION, 'b') != 0:
+                return 'activation'
+            if self.shapes[inputs[0]][3] % 16:
+                return 'depth % 16'
+            return None
+        if code == FULLY_CONNECTED:
+            if self.zero_point(inputs[0]) != -128:
+                return 'input offset'
+            if self.zero_point(inputs[1]) != 0:
+                return 'weights offset'
+            if len(inputs) < 3 or inputs[2] < 0:
+                return 'no bias'
+            if self.shapes[inputs[1]][1] % 16:
+                return 'input depth % 16'
+            if self.shapes[self.outputs[i][0]][0] != 1:
+                return 'batches'
+            return None
+        if code == PAD:
+            # The amounts of padding are not checked
+            depth = self.shapes[inputs[0]][-1]
+            if len(self.shapes[inputs[0]]) != 4:
+                return 'not 4D'
+            if depth != 1 and depth % 16:
+                return 'depth % 16'
+            return None
+        return ''
+
+    def conv_blocker(self, i):
+        inputs = self.inputs[i]
+        opts = self.options(i)
+        input_shape = self.shapes[inputs[0]]
+        filter_shape = self.shapes[inputs[1]]
+        output_shape = self.shapes[self.outputs[i][0]]
+        if opts.scalar(OPTIONS_PADDING, 'b') != PADDING_VALID:
+            return 'padding'
+        if len(inputs) < 3 or inputs[2] < 0:
+            return 'no bias'
+        if input_shape[0] != 1:
+            return 'batches'
+        input_depth = input_shape[3]
+        output_depth = output_shape[3]
+        strides = (opts.scalar(OPTIONS_STRIDE_W, 'i'),
+                   opts.scalar(OPTIONS_STRIDE_H, 'i'))
+        if input_depth == 1:
+            if strides != (2, 2):
+                return 'stride'
+            if input_shape[2] != 322 or output_shape[2] != 160 or \
+                    output_depth != 16:
+                return 'input layer shape'
+        else:
+            if strides != (1, 1):
+                return 'stride'
+            if input_depth % 16:
+                return 'input depth % 16'
+            if output_depth % self.output_channel_group:
+                return f'output depth % {self.output_channel_group}'
+        if filter_shape[1:3] != [4, 4]:
+            return 'not 4x4'
+        filter_words = self.output_channel_group * input_depth * 16 // 4
+        if filter_words > self.num_filter_stores * FILTER_WORDS_PER_STORE:
+            return 'filter too large'
+        if opts.scalar(CONV_DILATION_W, 'i', 1) != 1 or \
+                opts.scalar(CONV_DILATION_H, 'i', 1) != 1:
+            return 'dilation'
+        return None
+
+    def weights_blocker(self, i):
+        """Returns why the weights and bias of op i cannot be padded."""
+        for t in self.inputs[i][1:3]:
+            if t < 0:
+                continue
+            if not self.is_constant(t):
+                return f'op {i} has non-constant weights'
+            if len(self.consumers[t]) > 1:
+                return f'op {i} shares tensor {t} with other ops'
+        return None
+
+    def pad_output(self, i, multiple):
+        """Pads the output channels of op i.
+
+        Returns the indices of the ops changed, or a string saying why the
+        output cannot be padded.
+        """
+        if self.codes[i] not in (CONV_2D, FULLY_CONNECTED):
+            return 'only CONV_2D and FULLY_CONNECTED outputs are padded'
+        out = self.outputs[i][0]
+        channels = self.shapes[out][-1]
+        size = round_up(channels, multiple)
+        if size == channels:
+            return 'already a multiple'
+        if self.tensors[out].type != TENSOR_TYPE_INT8:
+            return 'not int8'
+        reason = self.weights_blocker(i)
+        if reason:
+            return reason
+        # Check the whole change first, so that nothing is done on failure
+        changed = [i]
+        padded = [out]
+        pending = [out]
+        while pending:
+            t = pending.pop()
+            if t in self.model_io:
+                return f'tensor {t} is a model input or output'
+            for c in self.consumers.get(t, []):
+                code = self.codes[c]
+                inputs = self.inputs[c]
+                if code not in (CONV_2D, FULLY_CONNECTED) + CHANNELWISE_OPS:
+                    return f'op {c} (builtin {code}) consumes tensor {t}'
+                if inputs[0] != t or any(u == t for u in inputs[1:]):
+                    return f'op {c} uses tensor {t} other than as its input'
+                if code in (CONV_2D, FULLY_CONNECTED, DEPTHWISE_CONV_2D):
+                    reason = self.weights_blocker(c)
+                    if reason:
+                        return reason
+                if code == FULLY_CONNECTED and \
+                        product(self.shapes[t][:-1]) != \
+                        self.shapes[self.outputs[c][0]][0]:
+                    return f'op {c} flattens spatial dimensions'
+                if code == DEPTHWISE_CONV_2D and \
+                        self.shapes[inputs[1]][3] != channels:
+                    return f'op {c} has a depth multiplier'
+                if code in CHANNELWISE_OPS:
+                    padded.append(self.outputs[c][0])
+                    pending.append(self.outputs[c][0])
+                changed.append(c)
+
+        # Add filters to the producer
+        weights, bias = self.inputs[i][1], self.inputs[i][2:3]
+        self.pad_constant(weights, 0, size)
+        if bias and bias[0] >= 0:
+            self.pad_constant(bias[0], 0, size)
+        for t in padded:
+            self.shapes[t][-1] = size
+        # Add zero weights to the consumers
+        for c in changed[1:]:
+            code = self.codes[c]
+            if code in (CONV_2D, FULLY_CONNECTED, DEPTHWISE_CONV_2D):
+                weights = self.inputs[c][1]
+                self.pad_constant(weights, len(self.shapes[weights]) - 1,
+                                  size)
+            if code == DEPTHWISE_CONV_2D and len(self.inputs[c]) > 2 and \
+                    self.inputs[c][2] >= 0:
+                self.pad_constant(self.inputs[c][2], 0, size)
+        return changed
+
+    def pad_constant(self, t, dim, size):
+        self.shapes[t] = self.constant(t).pad(self.shapes[t], dim, size)
+
+    def write(self):
+        """Returns the padded model.
+
+        Each padded constant gets a new buffer, which takes the place of its
+        old buffer unless another tensor shares that. Buffers left with no
+        tensor or metadata referring to them are emptied, and the data they
+        held is cut out of the file.
+        """
+        model = self.model
+        builder = tflite_fb.PrefixBuilder(model.buf)
+        buffer_users = {}
+        for info in self.tensors:
+            b = info.table.scalar(tflite_fb.TENSOR_BUFFER, 'I')
+            buffer_users[b] = buffer_users.get(b, 0) + 1
+        metadata = model.metadata()
+        kept = [(name, b, m) for name, b, m in metadata
+                if name != tflite_memory_planner.OFFLINE_METADATA_NAME]
+        for _, b, _ in kept:
+            buffer_users[b] = buffer_users.get(b, 0) + 1
+        buffer_refs = [tflite_fb.OldRef(b.pos) for b in model.buffers]
+        tensor_refs = []
+        for t, info in enumerate(self.tensors):
+            if self.shapes[t] == info.shape and t not in self.constants:
+                tensor_refs.append(tflite_fb.OldRef(info.table.pos))
+                continue
+            replace = {tflite_fb.TENSOR_SHAPE: builder.int_vector(
+                self.shapes[t])}
+            signature = info.table.scalar_vector(
+                tflite_fb.TENSOR_SHAPE_SIGNATURE, 'i')
+            if signature:
+                replace[tflite_fb.TENSOR_SHAPE_SIGNATURE] = builder.int_vector(
+                    [s if s < 0 else n
+                     for s, n in zip(signature, self.shapes[t])])
+            if t in self.constants:
+                constant = self.constants[t]
+                data = builder.bytes_vector(constant.data)
+                buffer = builder.table({tflite_fb.BUFFER_DATA: data})
+                old = info.table.scalar(tflite_fb.TENSOR_BUFFER, 'I')
+                if buffer_users[old] == 1:
+                    buffer_refs[old] = buffer
+                else:
+                    buffer_users[old] -= 1
+                    buffer_refs.append(buffer)
+                    replace[tflite_fb.TENSOR_BUFFER] = (
+                        'I', len(buffer_refs) - 1)
+                quant = info.table.table(tflite_fb.TENSOR_QUANTIZATION)
+                if quant and constant.scale:
+                    replace[tflite_fb.TENSOR_QUANTIZATION] = builder.table(
+                        tflite_fb.copy_fields(
+                            quant, tflite_fb.QUANTIZATION_SCALARS, {
+                                tflite_fb.QUANTIZATION_SCALE:
+                                    builder.int_vector(constant.scale, 'f'),
+                                tflite_fb.QUANTIZATION_ZERO_POINT:
+                                    builder.int_vector(constant.zero_point,
+                                                       'q'),
+                            }))
+            tensor_refs.append(builder.table(tflite_fb.copy_fields(
+                info.table, tflite_fb.TENSOR_SCALARS, replace)))
+
+        sg = model.subgraphs[0]
+        subgraph = builder.table(tflite_fb.copy_fields(
+            sg, tflite_fb.SUBGRAPH_SCALARS,
+            {tflite_fb.SUBGRAPH_TENSORS: builder.ref_vector(tensor_refs)}))
+        subgraphs = builder.ref_vector(
+            [subgraph] +
+            [tflite_fb.OldRef(s.pos) for s in model.subgraphs[1:]])
+        # Old buffers that lose their data: replaced, or no longer used
+        dropped = []
+        for b, old in enumerate(model.buffers):
+            if old.bytes(tflite_fb.BUFFER_DATA) is None:
+                continue
+            if not buffer_users.get(b):
+                buffer_refs[b] = builder.table({})
+            if isinstance(buffer_refs[b], tflite_fb.NewRef):
+                dropped.append(old)
+        buffers = builder.ref_vector(buffer_refs)
+        replace = {
+            tflite_fb.MODEL_SUBGRAPHS: subgraphs,
+            tflite_fb.MODEL_BUFFERS: buffers,
+        }
+        if metadata:
+            replace[tflite_fb.MODEL_METADATA] = builder.ref_vector(
+                [tflite_fb.OldRef(m.pos) for _, _, m in kept])
+        root = builder.table(tflite_fb.copy_model_fields(model, replace))
+        out = builder.finish(root)
+
+        # Cut out the dropped data, found where finish() moved it to
+        shift = len(out) - len(model.buf)
+        ranges = []
+        for old in dropped:
+            start, length = old.vector(tflite_fb.BUFFER_DATA)
+            ranges.append((start - 4 + shift, start + length + shift))
+        return tflite_fb.compact(out, ranges)
+
+
+def accelerable(padder):
+    return [padder.accel_blocker(i) for i in range(len(padder.ops))]
+
+
+def greedy_arena(model):
+    buffers = tflite_memory_planner.tensor_lifetimes(model)
+    size, _ = tflite_memory_planner.first_fit(
+        buffers, tflite_memory_planner.greedy_order(buffers))
+    return size
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description='Pad channels of an int8 model for hps_accel.')
+    parser.add_argument('model', help='.tflite file')
+    parser.add_argument('-o', '--output', help='write padded model here')
+    parser.add_argument('--ops',
+                        help='comma separated indices of ops to pad')
+    parser.add_argument('-m', '--multiple', type=int, default=16,
+                        help='pad channels to a multiple of this')
+    parser.add_argument('--sys-array-width', type=int,
+                        default=DEFAULT_SYS_ARRAY_WIDTH, choices=(2, 4, 8),
+                        help='SYS_ARRAY_WIDTH the gateware is built with')
+    args = parser.parse_args()
+
+    with open(args.model, 'rb') as f:
+        model = tflite_fb.Model(f.read())
+    if len(model.subgraphs) != 1:
+        sys.exit(f'{args.model}: only single subgraph models are supported')
+    if model.has_external_buffers():
+        sys.exit(f'{args.model}: models with external buffers not supported')
+
+    padder = Padder(model, args.sys_array_width)
+    before = accelerable(padder)
+    if args.ops:
+        chosen = [int(i) for i in args.ops.split(',')]
+        if any(i < 0 or i >= len(padder.ops) for i in chosen):
+            parser.error(f'ops must be from 0 to {len(padder.ops) - 1}')
+    else:
+        chosen = [i for i, code in enumerate(padder.codes)
+                  if code in (CONV_2D, FULLY_CONNECTED)]
+    for i in chosen:
+        current = accelerable(padder)
+        saved = padder.save()
+        result = padder.pad_output(i, args.multiple)
+        if isinstance(result, str):
+            if args.ops:
+                print(f'op {i}: not padded: {result}')
+            continue
+        # Without --ops, keep only padding that gains something
+        if not args.ops and all(padder.accel_blocker(c) is not None or
+                                current[c] is None for c in result):
+            padder.restore(saved)
+            continue
+        print(f'op {i}: padded {OP_NAMES[padder.codes[i]]} output to '
+              f'{padder.shapes[padder.outputs[i][0]][-1]} channels, '
+              f'changing ops {", ".join(str(c) for c in result)}')
+    after = accelerable(padder)
+
+    print(f'\n{"op":>4} {"name":<18} {"before":<20} {"after":<20}')
+    for i, (b, a) in enumerate(zip(before, after)):
+        if b != a:
+            print(f'{i:>4} {OP_NAMES.get(padder.codes[i], ""):<18} '
+                  f'{b or "accelerable":<20} {a or "accelerable":<20}')
+    count_before = sum(b is None for b in before)
+    count_after = sum(a is None for a in after)
+    print(f'\naccelerable ops: {count_before} -> {count_after}')
+
+    if not padder.constants:
+        print('nothing padded')
+        return
+    out = padder.write()
+    padded = tflite_fb.Model(out)
+    assert [t.shape for t in padded.tensors()] == padder.shapes
+    weight_bytes = sum(
+        t.num_bytes() - model.tensors()[t.index].num_bytes()
+        for t in padded.tensors() if t.is_constant)
+    activation_bytes = sum(
+        t.num_bytes() - model.tensors()[t.index].num_bytes()
+        for t in padded.tensors() if not t.is_constant)
+    print(f'weights:     {weight_bytes:+} bytes')
+    print(f'activations: {activation_bytes:+} bytes, over all tensors')
+    print(f'arena:       {greedy_arena(model)} -> {greedy_arena(padded)} '
+          f'bytes, as planned by GreedyMemoryPlanner')
+    print(f'file:        {len(model.buf)} -> {len(out)} bytes')
+    if tflite_memory_planner.read_offline_plan(model):
+        print('offline memory plan dropped: re-run tflite_memory_planner.py')
+
+    if args.output:
+        with open(args.output, 'wb') as f:
+            f.write(out)
+
+
+if __name__ == '__main__':
+    main()
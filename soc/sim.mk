@@ -44,16 +44,26 @@ LITEX_ARGS= --output-dir $(OUT_DIR) \
 	--bin $(SOFTWARE_BIN) \
 	--sim-trace
 
+# Checkpoint support is only built in when saving one (see sim_checkpoint.py)
+ifneq '$(SIM_CHECKPOINT_SAVE)' ''
+  LITEX_ARGS += --sim-checkpoint
+endif
+
 PYRUN:=     $(CFU_ROOT)/scripts/pyrun
 SIM_RUN:=   MAKEFLAGS=-j8 $(PYRUN) ./sim.py $(LITEX_ARGS) $(EXTRA_LITEX_ARGS)
 BIOS_BIN := $(OUT_DIR)/software/bios/bios.bin
 
-.PHONY: run litex-software clean
+.PHONY: run resume litex-software clean
 
 litex-software: $(BIOS_BIN)
 
 run: $(BITSTREAM)
 	$(SIM_RUN) --run
+
+# Runs the simulation built by 'run' again, without rebuilding it. Set
+# SIM_CHECKPOINT_RESTORE to continue from a checkpoint (see sim_checkpoint.py).
+resume:
+	cd $(OUT_DIR)/gateware && obj_dir/Vsim
 	
 clean:
 	@echo Removing $(OUT_DIR)
@@ -32,6 +32,7 @@ from litex.soc.integration.soc import SoCRegion
 from litex.tools.litex_sim import SimSoC
 
 from patch_cpu_variant import patch_cpu_variant, copy_cpu_variant_if_needed
+from sim_checkpoint import add_sim_checkpoint, patch_sim_core
 
 import argparse
 import os
@@ -64,6 +65,8 @@ def main():
     parser.add_argument("--cfu-mport", action="store_true", help="Add ports between arena and CFU " \
                         "(implies --separate-arena)")
     parser.add_argument("--bin", help="RISCV binary to run. Required if --run is set.")
+    parser.add_argument("--sim-checkpoint", action="store_true", help="Build with checkpoint " \
+                        "and restore support (see sim_checkpoint.py)")
     parser.set_defaults(
             csr_csv='csr.csv',
             uart_name='serial',
@@ -132,6 +135,10 @@ def main():
 
     builder = Builder(soc, **builder_argdict(args))
 
+    # Checkpoint and restore, see sim_checkpoint.py
+    if args.sim_checkpoint and patch_sim_core(builder.output_dir):
+        add_sim_checkpoint(soc)
+
     # configure_sim_builder(builder, args.sim_rom_bin)
     builder.build(
         build=args.run,
@@ -0,0 +1,151 @@
+#!/usr/bin/env python3
+# Copyright 2021 The CFU-Playground Authors
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#      http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+
+# Disable pylint's E1101, which breaks completely on migen
+#pylint:disable=E1101
+
+"""Checkpoint and restore for the Verilator simulation.
+
+Booting the simulated SoC and loading a model takes minutes of simulated
+time. With checkpoints, that is done once. They are only built into
+simulations made with sim.py --sim-checkpoint, which "make checkpoint" in a
+project directory passes:
+
+  * Running with SIM_CHECKPOINT_SAVE=<file> in the environment saves the
+    whole simulation state to file when the firmware first calls
+    sim_checkpoint(), which tflite_classify() does just before Invoke().
+  * Running with SIM_CHECKPOINT_RESTORE=<file> starts from that state.
+    SIM_CHECKPOINT_INPUT_SEED=<n> then has the firmware randomize the input
+    before Invoke(), and SIM_CHECKPOINT_TRACE_OP=<n> has it trace op n.
+
+The firmware and simulator hand over through the SimCheckpoint CSRs, whose
+pads are read and driven by code added to LiteX's simulation core (see
+sim_checkpoint_hook.h). The state is saved and restored with Verilator's
+--savable support. Restoring needs the same simulation binary, or one built
+from the same sources. If the LiteX simulation core does not have the code
+the patch expects, the simulation is built without checkpoint support.
+"""
+
+from migen import *
+
+from litex.build.generic_platform import Pins, Subsignal
+from litex.build.sim import verilator
+from litex.soc.interconnect.csr import AutoCSR, CSRStatus, CSRStorage
+
+import os
+import shutil
+import warnings
+
+
+_io = [
+    ("sim_checkpoint", 0,
+        Subsignal("request",    Pins(1)),
+        Subsignal("ack",        Pins(1)),
+        Subsignal("restored",   Pins(1)),
+        Subsignal("input_seed", Pins(32)),
+        Subsignal("trace_op",   Pins(32)),
+    ),
+]
+
+
+class SimCheckpoint(Module, AutoCSR):
+    """CSRs through which the firmware asks the simulator for a checkpoint.
+
+    The firmware sets request, then waits for ack. The simulator saves
+    before it acks, so the checkpoint resumes with the firmware waiting.
+    After a restore, restored is set, along with the values chosen for
+    input_seed and trace_op, until the firmware clears request.
+    """
+
+    def __init__(self, pads):
+        self._request = CSRStorage(description="Request a checkpoint")
+        self._ack = CSRStatus(description="Request handled")
+        self._restored = CSRStatus(
+            description="Continuing from a restored checkpoint")
+        self._input_seed = CSRStatus(32,
+            description="Seed for a random input, or zero to keep the input")
+        self._trace_op = CSRStatus(32,
+            description="Op to trace, or all ones to keep the selection")
+
+        self.comb += [
+            pads.request.eq(self._request.storage),
+            self._ack.status.eq(pads.ack),
+            self._restored.status.eq(pads.restored),
+            self._input_seed.status.eq(pads.input_seed),
+            self._trace_op.status.eq(pads.trace_op),
+        ]
+
+
+def add_sim_checkpoint(soc):
+    """Adds the checkpoint CSRs to a SimSoC."""
+    soc.platform.add_extension(_io)
+    soc.submodules.sim_checkpoint = SimCheckpoint(
+        soc.platform.request("sim_checkpoint"))
+    soc.add_csr("sim_checkpoint")
+
+
+class _PatchError(Exception):
+    pass
+
+
+def _patch(text, old, new, filename):
+    if text.count(old) != 1:
+        raise _PatchError(f"expected one \"{old}\" in LiteX's {filename}")
+    return text.replace(old, new, 1)
+
+
+def _read(path):
+    with open(path) as f:
+        return f.read()
+
+
+def patch_sim_core(output_dir):
+    """Points the LiteX Verilator build at a copy of its simulation core,
+    verilated with --savable and calling the checkpoint hook after each
+    eval().
+
+    Returns False, leaving LiteX's core in use, if the core cannot be
+    patched.
+    """
+    src_dir = verilator.core_directory
+    try:
+        makefile = _patch(_read(os.path.join(src_dir, "Makefile")),
+                          "--top-module sim", "--top-module sim --savable",
+                          "sim Makefile")
+        veril = _read(os.path.join(src_dir, "veril.cpp"))
+        veril = _patch(veril, '#include "Vsim.h"',
+                       '#include "Vsim.h"\n#include "sim_checkpoint_hook.h"',
+                       "veril.cpp")
+        veril = _patch(veril, "sim->eval();",
+                       "sim->eval();\n  sim_checkpoint_after_eval(sim);",
+                       "veril.cpp")
+    except (_PatchError, OSError) as e:
+        warnings.warn(f"Building without checkpoint support: {e}")
+        return False
+
+    core_dir = os.path.join(output_dir, "sim_core")
+    if os.path.exists(core_dir):
+        shutil.rmtree(core_dir)
+    shutil.copytree(src_dir, core_dir)
+    with open(os.path.join(core_dir, "Makefile"), "w") as f:
+        f.write(makefile)
+    with open(os.path.join(core_dir, "veril.cpp"), "w") as f:
+        f.write(veril)
+    shutil.copy(
+        os.path.join(os.path.dirname(__file__), "sim_checkpoint_hook.h"),
+        core_dir)
+    verilator.core_directory = core_dir
+    return True
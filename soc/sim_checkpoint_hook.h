@@ -0,0 +1,104 @@
+// Copyright 2021 The CFU-Playground Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Checkpoint and restore, included into LiteX's veril.cpp by
+// sim_checkpoint.py. sim_checkpoint_after_eval() is called after every
+// eval(), which is when Verilator allows the model to be saved or restored.
+// It drives the sim_checkpoint pads of the SimCheckpoint CSRs.
+
+#ifndef _SIM_CHECKPOINT_HOOK_H
+#define _SIM_CHECKPOINT_HOOK_H
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "verilated_save.h"
+
+namespace sim_checkpoint {
+
+// Returns the environment variable's value, or nullptr if unset or empty
+static const char* env(const char* name) {
+  const char* value = getenv(name);
+  return value && *value ? value : nullptr;
+}
+
+static uint32_t env_u32(const char* name, uint32_t dflt) {
+  const char* value = env(name);
+  return value ? static_cast<uint32_t>(strtol(value, nullptr, 0)) : dflt;
+}
+
+static void save(Vsim* sim, const char* path) {
+  VerilatedSave os;
+  os.open(path);
+  if (!os.isOpen()) {
+    fprintf(stderr, "Could not write checkpoint %s\n", path);
+    exit(1);
+  }
+  os << *sim;
+  os.close();
+  printf("<CHECKPOINT SAVED TO %s>", path);
+  fflush(stdout);
+}
+
+static void restore(Vsim* sim, const char* path) {
+  VerilatedRestore os;
+  os.open(path);
+  if (!os.isOpen()) {
+    fprintf(stderr, "Could not read checkpoint %s\n", path);
+    exit(1);
+  }
+  os >> *sim;
+  os.close();
+  printf("<CHECKPOINT RESTORED FROM %s>", path);
+  fflush(stdout);
+}
+
+static bool started = false;
+static bool saved = false;
+
+}  // namespace sim_checkpoint
+
+static void sim_checkpoint_after_eval(Vsim* sim) {
+  using namespace sim_checkpoint;
+  if (!started) {
+    // Restore over the state after the first eval(). The saved state has
+    // the firmware waiting for its request to be acknowledged.
+    started = true;
+    const char* path = env("SIM_CHECKPOINT_RESTORE");
+    if (path) {
+      restore(sim, path);
+      sim->sim_checkpoint_restored = 1;
+      sim->sim_checkpoint_input_seed = env_u32("SIM_CHECKPOINT_INPUT_SEED", 0);
+      sim->sim_checkpoint_trace_op =
+          env_u32("SIM_CHECKPOINT_TRACE_OP", 0xffffffff);
+      sim->sim_checkpoint_ack = 1;
+    }
+    return;
+  }
+  if (sim->sim_checkpoint_request && !sim->sim_checkpoint_ack) {
+    const char* path = env("SIM_CHECKPOINT_SAVE");
+    if (path && !saved) {
+      save(sim, path);
+      saved = true;
+    }
+    sim->sim_checkpoint_ack = 1;
+  } else if (!sim->sim_checkpoint_request && sim->sim_checkpoint_ack) {
+    sim->sim_checkpoint_ack = 0;
+    sim->sim_checkpoint_restored = 0;
+    sim->sim_checkpoint_input_seed = 0;
+    sim->sim_checkpoint_trace_op = 0xffffffff;
+  }
+}
+
+#endif  // _SIM_CHECKPOINT_HOOK_H